@@ -14,6 +14,12 @@
 #include "app_profile.h"
 #include "app_sensor.h"
 #include "app_config.h"
+#include "app_diag.h"
+#include "app_energy.h"
+#include "app_sched.h"
+#include "app_event.h"
+#define APP_LOG_MODULE APP_LOG_MODULE_APP
+#include "app_log.h"
 #include "stack/include/network-formation.h"  // For manual network join
 #include "stack/include/security.h"
 #include "stack/include/binding-table.h"
@@ -41,20 +47,19 @@ __attribute__((weak)) void sl_spidrv_init_instances(void);
 #include "sl_simple_led_instances.h"
 #endif
 
-// LED blink event for network joining indication
-static sl_zigbee_event_t led_blink_event;
-static bool led_blink_active = false;
+// LED blink task for network joining indication (app_sched, no slack)
+static void led_blink_handler(app_sched_task_t *task);
+static app_sched_task_t led_blink_task = APP_SCHED_TASK_INIT(led_blink_handler, 0);
 
 // LED off timer - turn off LED after network join confirmation
-static sl_zigbee_event_t led_off_event;
+static void led_off_handler(app_sched_task_t *task);
+static app_sched_task_t led_off_task = APP_SCHED_TASK_INIT(led_off_handler, 500);
 
 static uint8_t join_attempt_count = 0;
 #define JOIN_SCAN_DURATION 3  // Active scan duration (Zigbee scan exponent)
 
-// Button action flags (set by ISR, cleared by main loop)
-// Using volatile because these are accessed from both ISR and main context
-static volatile bool button_short_press_pending = false;
-static volatile bool button_long_press_pending = false;
+// Button actions reach the main loop as APP_EVENT_BUTTON_SHORT/LONG events
+// (app_event ring, posted by the button ISR).
 
 // Button press duration tracking
 static volatile uint32_t button_press_start_tick = 0;
@@ -169,7 +174,8 @@ static volatile bool button_pressed = false;
 #ifndef APP_DEBUG_USE_NETWORK_STEERING
 #define APP_DEBUG_USE_NETWORK_STEERING 1
 #endif
-#define APP_DEBUG_PRINTF(...) printf(__VA_ARGS__)
+// Debug trace; compiled out below APP_LOG_LEVEL_DEBUG, tokenized with APP_LOG_TOKENIZED
+#define APP_DEBUG_PRINTF(...) APP_LOG_PRINTF(APP_LOG_LEVEL_DEBUG, __VA_ARGS__)
 
 #if defined(SL_CATALOG_ZIGBEE_NETWORK_STEERING_PRESENT) && (APP_DEBUG_USE_NETWORK_STEERING != 0)
 #define APP_RUNTIME_NETWORK_STEERING 1
@@ -229,28 +235,80 @@ static bool join_network_found = false;
 static bool app_intentional_leave_pending = false;
 static EmberZigbeeNetwork join_candidate;
 static bool af_init_seen = false;
-static bool af_init_reported = false;
-static bool basic_identity_pending = false;
-static bool af_init_force_pending = false;
-static uint32_t af_init_force_tick = 0;
-static uint32_t basic_identity_tick = 0;
+#if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
+static uint32_t app_manual_poll_boost_end_tick = 0;
+#endif
+
+// Guard windows: deadline-only app_sched tasks, active while armed and not
+// yet due. The button guards are also read from the button callback.
+static app_sched_task_t app_button_guard = APP_SCHED_TASK_INIT(NULL, APP_SCHED_LAZY);
+static app_sched_task_t app_leave_guard = APP_SCHED_TASK_INIT(NULL, APP_SCHED_LAZY);
+static app_sched_task_t app_join_retry_guard = APP_SCHED_TASK_INIT(NULL, APP_SCHED_LAZY);
+
+// AF-init fallback delay after app_debug_force_af_init() (ms).
+#ifndef APP_AF_INIT_WATCHDOG_MS
+#define APP_AF_INIT_WATCHDOG_MS 2000
+#endif
+
+// Retry period for the Basic identity log until the attributes are readable (ms).
+#ifndef APP_BASIC_IDENTITY_RETRY_MS
+#define APP_BASIC_IDENTITY_RETRY_MS 2000
+#endif
+
+// Sensor watchdog period while joined (ms). Lazy: checked on the first wake
+// after the period, never a wake of its own.
+#ifndef APP_SENSOR_WATCHDOG_MS
+#define APP_SENSOR_WATCHDOG_MS 5000
+#endif
+
+// Slack of runtime deadlines whose exact moment does not matter (auto-join,
+// end of post-join windows): they may run this much late to share a wake.
+#ifndef APP_RUNTIME_TASK_SLACK_MS
+#define APP_RUNTIME_TASK_SLACK_MS 1000
+#endif
+
+// Runtime tasks (app_sched). Each runs only when its deadline is due; the
+// waking ones keep the scheduler sleeptimer armed, which is what bounds the
+// power manager's sleep.
+static void app_af_init_watchdog_handler(app_sched_task_t *task);
+static void app_deferred_join_handler(app_sched_task_t *task);
+static void app_auto_join_handler(app_sched_task_t *task);
+static void app_sensor_watchdog_handler(app_sched_task_t *task);
+static void app_basic_identity_handler(app_sched_task_t *task);
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT) && (APP_DEBUG_AWAKE_AFTER_JOIN_MS > 0)
+static void app_join_awake_end_handler(app_sched_task_t *task);
+#endif
+#if (APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS > 0)
+static void app_fast_poll_end_handler(app_sched_task_t *task);
+#endif
+#if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
+static void app_manual_poll_handler(app_sched_task_t *task);
+#endif
+
+static app_sched_task_t app_af_init_watchdog_task =
+  APP_SCHED_TASK_INIT(app_af_init_watchdog_handler, 0);
+static app_sched_task_t app_deferred_join_task =
+  APP_SCHED_TASK_INIT(app_deferred_join_handler, 0);
+static app_sched_task_t app_auto_join_task =
+  APP_SCHED_TASK_INIT(app_auto_join_handler, APP_RUNTIME_TASK_SLACK_MS);
+static app_sched_task_t app_sensor_watchdog_task =
+  APP_SCHED_TASK_INIT(app_sensor_watchdog_handler, APP_SCHED_LAZY);
+static app_sched_task_t app_basic_identity_task =
+  APP_SCHED_TASK_INIT(app_basic_identity_handler, APP_SCHED_LAZY);
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT) && (APP_DEBUG_AWAKE_AFTER_JOIN_MS > 0)
-static bool app_join_awake_active = false;
-static uint32_t app_join_awake_start_tick = 0;
+static app_sched_task_t app_join_awake_end_task =
+  APP_SCHED_TASK_INIT(app_join_awake_end_handler, APP_RUNTIME_TASK_SLACK_MS);
 #endif
 #if (APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS > 0)
-static bool app_fast_poll_active = false;
-static uint32_t app_fast_poll_start_tick = 0;
-#endif
-static bool app_manual_poll_boost_active = false;
-static uint32_t app_manual_poll_boost_start_tick = 0;
-static uint32_t app_manual_poll_boost_last_tick = 0;
-static uint32_t app_button_unlock_tick = 0;
-static uint32_t app_leave_unlock_tick = 0;
-static uint32_t app_join_retry_unlock_tick = 0;
-static bool app_auto_join_scheduled = false;
-static uint32_t app_auto_join_tick = 0;
-static sl_sleeptimer_timer_handle_t app_rejoin_wake_timer;
+static app_sched_task_t app_fast_poll_end_task =
+  APP_SCHED_TASK_INIT(app_fast_poll_end_handler, APP_RUNTIME_TASK_SLACK_MS);
+#endif
+#if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
+// Lazy like the loop check it replaces: during the boost the fast-poll
+// window keeps the MCU awake anyway, and it never extends a sleep.
+static app_sched_task_t app_manual_poll_task =
+  APP_SCHED_TASK_INIT(app_manual_poll_handler, APP_SCHED_LAZY);
+#endif
 
 // Rejoin delay after unintentional network loss (ms).
 // Gives the coordinator a moment to settle before we scan.
@@ -263,27 +321,11 @@ static sl_sleeptimer_timer_handle_t app_rejoin_wake_timer;
 #define APP_REJOIN_MAX_DELAY_MS 600000
 #endif
 
-static void app_rejoin_wake_timer_callback(sl_sleeptimer_timer_handle_t *handle,
-                                           void *data)
-{
-  (void)handle;
-  (void)data;
-  // Nothing to do — the timer firing wakes the CPU from sleep so that
-  // app_runtime_poll() can process app_auto_join_scheduled.
-}
-
-// Schedule an auto-rejoin attempt after delay_ms.  Uses a one-shot
-// sleeptimer to guarantee the CPU wakes from deep sleep.
+// Schedule an auto-rejoin attempt after delay_ms.  The task is a waking
+// one, so its deadline bounds deep sleep.
 static void app_schedule_auto_rejoin(uint32_t delay_ms)
 {
-  uint32_t now = sl_sleeptimer_get_tick_count();
-  app_auto_join_scheduled = true;
-  app_auto_join_tick = now + sl_sleeptimer_ms_to_tick(delay_ms);
-  sl_sleeptimer_stop_timer(&app_rejoin_wake_timer);
-  sl_sleeptimer_start_timer_ms(&app_rejoin_wake_timer,
-                               delay_ms,
-                               app_rejoin_wake_timer_callback,
-                               NULL, 0, 0);
+  app_sched_start_ms(&app_auto_join_task, delay_ms);
   APP_DEBUG_PRINTF("Auto-rejoin scheduled in %lu ms\n",
                    (unsigned long)delay_ms);
 }
@@ -306,8 +348,6 @@ static const uint8_t zigbee_alliance_key[EMBER_ENCRYPTION_KEY_SIZE] = {
 };
 
 // Forward declarations
-static void led_blink_event_handler(sl_zigbee_event_t *event);
-static void led_off_event_handler(sl_zigbee_event_t *event);
 static void rejoin_retry_event_handler(sl_zigbee_event_t *event) APP_UNUSED;
 static void start_optimized_rejoin(void) APP_UNUSED;
 static void handle_short_press(void);
@@ -331,33 +371,19 @@ static bool app_handle_basic_mfg_rw_command(const EmberAfClusterCommand *cmd);
 static void app_debug_reset_network_state(void);
 #endif
 
-static bool app_join_retry_blocked(uint32_t now)
+static bool app_join_retry_blocked(void)
 {
-  if (app_join_retry_unlock_tick == 0) {
-    return false;
-  }
-  if ((int32_t)(app_join_retry_unlock_tick - now) <= 0) {
-    app_join_retry_unlock_tick = 0;
-    return false;
-  }
-  return true;
+  return app_sched_remaining_ms(&app_join_retry_guard) > 0;
 }
 
-static bool app_leave_guard_active(uint32_t now)
+static bool app_leave_guard_active(void)
 {
-  if (app_leave_unlock_tick == 0) {
-    return false;
-  }
-  if ((int32_t)(app_leave_unlock_tick - now) <= 0) {
-    app_leave_unlock_tick = 0;
-    return false;
-  }
-  return true;
+  return app_sched_remaining_ms(&app_leave_guard) > 0;
 }
 
-static void app_set_join_retry_backoff(uint32_t now, uint32_t delay_ms)
+static void app_set_join_retry_backoff(uint32_t delay_ms)
 {
-  app_join_retry_unlock_tick = now + sl_sleeptimer_ms_to_tick(delay_ms);
+  app_sched_start_ms(&app_join_retry_guard, delay_ms);
 }
 
 #if APP_RUNTIME_NETWORK_STEERING
@@ -401,7 +427,6 @@ void emberAfPluginNetworkSteeringCompleteCallback(EmberStatus status,
  */
 static void app_init_once(void)
 {
-  uint32_t now = sl_sleeptimer_get_tick_count();
 #if APP_DEBUG_SPI_ONLY
   APP_DEBUG_PRINTF("SPI-only debug mode\n");
   app_flash_probe();
@@ -413,8 +438,7 @@ static void app_init_once(void)
   }
   APP_DEBUG_PRINTF("AF init callback\n");
   af_init_seen = true;
-  af_init_force_pending = false;
-  af_init_force_tick = 0;
+  app_sched_cancel(&app_af_init_watchdog_task);
 
 #ifdef SL_CATALOG_SIMPLE_BUTTON_PRESENT
   // TRADFRI boards may not have an external pull-up on BTN0 (PB13).
@@ -427,11 +451,10 @@ static void app_init_once(void)
 
   // Drop any stale press state captured before AF init was complete.
   // This avoids false "long press" on the first post-boot release edge.
-  button_short_press_pending = false;
-  button_long_press_pending = false;
+  app_event_flush();
   button_pressed = false;
   button_press_start_tick = 0;
-  app_button_unlock_tick = now + sl_sleeptimer_ms_to_tick(APP_DEBUG_BUTTON_GUARD_AFTER_BOOT_MS);
+  app_sched_start_ms(&app_button_guard, APP_DEBUG_BUTTON_GUARD_AFTER_BOOT_MS);
   APP_DEBUG_PRINTF("Button guard: ignoring BTN0 for %lu ms after init\n",
                    (unsigned long)APP_DEBUG_BUTTON_GUARD_AFTER_BOOT_MS);
 
@@ -444,10 +467,6 @@ static void app_init_once(void)
   emberAfCorePrintln("Silicon Labs EFR32MG1P + Bosch BME280");
   emberAfCorePrintln("Press BTN0 to join network or trigger sensor reading");
 
-  // Initialize LED events
-  sl_zigbee_event_init(&led_blink_event, led_blink_event_handler);
-  sl_zigbee_event_init(&led_off_event, led_off_event_handler);
-
   // Button handling uses emberAfTickCallback() to check flags - no events needed
 
   // Initialize optimized rejoin event (TEMPORARILY DISABLED - event queue issue)
@@ -456,7 +475,7 @@ static void app_init_once(void)
   // Initialize configuration from NVM
   app_config_init();
   if (!log_basic_identity()) {
-    basic_identity_pending = true;
+    app_sched_start_ms(&app_basic_identity_task, APP_BASIC_IDENTITY_RETRY_MS);
   }
 
 #if APP_DEBUG_DIAG_ALWAYS
@@ -475,6 +494,14 @@ static void app_init_once(void)
 #endif
   }
 
+  // Self-heal periodic sensor updates; idles while not joined.
+  app_sched_start_ms(&app_sensor_watchdog_task, APP_SENSOR_WATCHDOG_MS);
+
+  // A join requested before AF init runs from the main loop, not from here.
+  if (join_pending) {
+    app_sched_start_ms(&app_deferred_join_task, 0);
+  }
+
 #if APP_AUTO_JOIN_ON_BOOT
   if (emberAfNetworkState() != EMBER_JOINED_NETWORK && !network_join_in_progress) {
     app_schedule_auto_rejoin(APP_AUTO_JOIN_DELAY_MS);
@@ -523,188 +550,186 @@ void app_debug_force_af_init(void)
 #if defined(APP_DEBUG_FORCE_AF_INIT) && (APP_DEBUG_FORCE_AF_INIT != 0)
   if (!af_init_seen) {
     APP_DEBUG_PRINTF("AF init requested (debug)\n");
-    af_init_force_pending = true;
+    app_sched_start_ms(&app_af_init_watchdog_task, APP_AF_INIT_WATCHDOG_MS);
   }
 #endif
 }
 
-void app_runtime_poll(void)
+static void app_af_init_watchdog_handler(app_sched_task_t *task)
 {
-  static uint32_t sensor_watchdog_last_tick = 0;
-  uint32_t now = sl_sleeptimer_get_tick_count();
-  uint32_t now_ms = sl_sleeptimer_tick_to_ms(now);
-  bool button_guard_active = (app_button_unlock_tick != 0)
-                             && ((int32_t)(app_button_unlock_tick - now) > 0);
-  bool leave_guard_active = app_leave_guard_active(now);
-  if (leave_guard_active) {
-    button_guard_active = true;
-  }
-
-  // Hard gate: while joining, ignore all button activity completely.
-  if (network_join_in_progress) {
-    button_short_press_pending = false;
-    button_long_press_pending = false;
-    button_pressed = false;
-    button_press_start_tick = 0;
-  }
-  if (leave_guard_active) {
-    button_short_press_pending = false;
-    button_long_press_pending = false;
-    button_pressed = false;
-    button_press_start_tick = 0;
-  }
-
-  if (!af_init_reported && af_init_seen) {
-    af_init_reported = true;
-    APP_DEBUG_PRINTF("AF init seen (tick)\n");
-  }
-
-  if (af_init_force_pending && !af_init_seen) {
-    if (af_init_force_tick == 0) {
-      af_init_force_tick = now;
-    } else if (sl_sleeptimer_tick_to_ms(now - af_init_force_tick) >= 2000) {
-      APP_DEBUG_PRINTF("AF init timeout - fallback callback\n");
-      app_init_once();
-      af_init_force_pending = false;
-    }
+  (void)task;
+  if (!af_init_seen) {
+    APP_DEBUG_PRINTF("AF init timeout - fallback callback\n");
+    app_init_once();
   }
+}
 
-#if defined(SL_CATALOG_SIMPLE_BUTTON_PRESENT) && (APP_DEBUG_POLL_SIMPLE_BUTTON_INSTANCES != 0)
-  // Keep simple_button state machine updated even if AF tick callback isn't
-  // scheduled frequently on this target.
-  sl_simple_button_poll_instances();
-#endif
-
-  // Some debug builds run without AF tick wiring, so process deferred joins here.
+// Some debug builds run without AF tick wiring, so process deferred joins here.
+static void app_deferred_join_handler(app_sched_task_t *task)
+{
+  (void)task;
   if (join_pending && af_init_seen && !network_join_in_progress) {
     join_pending = false;
     APP_DEBUG_PRINTF("Join: deferred request starting (poll)\n");
     start_network_join();
   }
+}
 
-  if (app_auto_join_scheduled) {
-    EmberNetworkStatus state = emberAfNetworkState();
-    if (state == EMBER_JOINED_NETWORK || network_join_in_progress) {
-      app_auto_join_scheduled = false;
-      app_auto_join_tick = 0;
-    } else if (af_init_seen
-               && app_auto_join_tick != 0
-               && (int32_t)(now - app_auto_join_tick) >= 0) {
-      app_auto_join_scheduled = false;
-      app_auto_join_tick = 0;
-      APP_DEBUG_PRINTF("Debug: auto-join timer fired\n");
-      start_network_join();
-    }
+static void app_auto_join_handler(app_sched_task_t *task)
+{
+  EmberNetworkStatus state = emberAfNetworkState();
+  if (state == EMBER_JOINED_NETWORK || network_join_in_progress) {
+    return;
   }
-
-  // Self-heal: if joined and periodic sensor updates stall, re-arm them.
-  if (emberAfNetworkState() == EMBER_JOINED_NETWORK) {
-    if (sensor_watchdog_last_tick == 0
-        || sl_sleeptimer_tick_to_ms(now - sensor_watchdog_last_tick) >= 5000) {
-      sensor_watchdog_last_tick = now;
-      uint32_t last_update_ms = app_sensor_get_last_update_ms();
-      bool timer_running = app_sensor_is_timer_running();
-      if (!timer_running
-          || (last_update_ms != 0 && (now_ms - last_update_ms) > 45000)) {
-        APP_DEBUG_PRINTF("Sensor watchdog: restart periodic updates (timer=%d last_age=%lu ms)\n",
-                         timer_running ? 1 : 0,
-                         (unsigned long)(last_update_ms == 0 ? 0 : (now_ms - last_update_ms)));
-        app_sensor_start_periodic_updates();
-      }
-    }
+  if (app_sched_timer_woke()) {
+    app_diag_wake_hint(APP_DIAG_WAKE_REJOIN_TIMER);
+  }
+  if (!af_init_seen) {
+    // Keep the request until the framework is up.
+    app_sched_start_ms(task, APP_AF_INIT_WATCHDOG_MS);
+    return;
   }
+  APP_DEBUG_PRINTF("Debug: auto-join timer fired\n");
+  start_network_join();
+}
 
-  // Some targets do not run emberAfTickCallback reliably in this app flow.
-  // Consume button flags here as well to guarantee action dispatch.
-  if (button_short_press_pending) {
-    button_short_press_pending = false;
-    if (button_guard_active) {
-      APP_DEBUG_PRINTF("Button guard: short press ignored\n");
-    } else {
-      APP_DEBUG_PRINTF("Button short press\n");
-      emberAfCorePrintln("Button: Short press detected (poll callback)");
-      handle_short_press();
-    }
+// Self-heal: if joined and periodic sensor updates stall, re-arm them.
+static void app_sensor_watchdog_handler(app_sched_task_t *task)
+{
+  app_sched_start_ms(task, APP_SENSOR_WATCHDOG_MS);
+  if (emberAfNetworkState() != EMBER_JOINED_NETWORK) {
+    return;
   }
 
-  if (button_long_press_pending) {
-    button_long_press_pending = false;
-    if (button_guard_active) {
-      APP_DEBUG_PRINTF("Button guard: long press ignored\n");
-    } else {
-      APP_DEBUG_PRINTF("Button long press\n");
-      emberAfCorePrintln("Button: Long press detected (poll callback)");
-      handle_long_press();
-    }
+  uint32_t update_age_ms = app_sensor_get_update_age_ms();
+  bool timer_running = app_sensor_is_timer_running();
+  // Stalled once a sample is 35 s overdue (45 s at the 10 s interval)
+  uint32_t stall_ms = app_sensor_get_interval_ms() + 35000u;
+  if (!timer_running || update_age_ms > stall_ms) {
+    APP_DEBUG_PRINTF("Sensor watchdog: restart periodic updates (timer=%d last_age=%lu ms)\n",
+                     timer_running ? 1 : 0,
+                     (unsigned long)update_age_ms);
+    app_sensor_start_periodic_updates();
   }
-  if (basic_identity_pending && af_init_seen) {
-    if (basic_identity_tick == 0 ||
-        sl_sleeptimer_tick_to_ms(now - basic_identity_tick) >= 2000) {
-      basic_identity_tick = now;
-      if (log_basic_identity()) {
-        basic_identity_pending = false;
-      }
-    }
+}
+
+static void app_basic_identity_handler(app_sched_task_t *task)
+{
+  if (!log_basic_identity()) {
+    app_sched_start_ms(task, APP_BASIC_IDENTITY_RETRY_MS);
   }
+}
+
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT) && (APP_DEBUG_AWAKE_AFTER_JOIN_MS > 0)
-  if (app_join_awake_active && app_join_awake_start_tick != 0) {
-    uint32_t elapsed_ms = sl_sleeptimer_tick_to_ms(now - app_join_awake_start_tick);
-    if (elapsed_ms >= APP_DEBUG_AWAKE_AFTER_JOIN_MS) {
-      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM0);
-      app_join_awake_active = false;
-      app_join_awake_start_tick = 0;
-      APP_DEBUG_PRINTF("Debug: post-join awake window ended\n");
-    }
-  }
+static void app_join_awake_end_handler(app_sched_task_t *task)
+{
+  (void)task;
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM0);
+  APP_DEBUG_PRINTF("Debug: post-join awake window ended\n");
+}
 #endif
 
 #if (APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS > 0)
-  if (app_fast_poll_active && app_fast_poll_start_tick != 0) {
-    uint32_t elapsed_ms = sl_sleeptimer_tick_to_ms(now - app_fast_poll_start_tick);
-    if (elapsed_ms >= APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS) {
+static void app_fast_poll_end_handler(app_sched_task_t *task)
+{
+  (void)task;
 #if (APP_DEBUG_NO_SLEEP != 0)
-      // In no-sleep debug mode keep short-poll/app-tasks active after the
-      // "window" so SWO remains alive and SED stays responsive for diagnostics.
-      APP_DEBUG_PRINTF("Debug: fast poll window ended (no-sleep mode, keeping short poll)\n");
+  // In no-sleep debug mode keep short-poll/app-tasks active after the
+  // "window" so SWO remains alive and SED stays responsive for diagnostics.
+  APP_DEBUG_PRINTF("Debug: fast poll window ended (no-sleep mode, keeping short poll)\n");
 #else
-      // Return to normal sleepy-end-device behavior after interview window.
-      emberAfSetDefaultPollControlCallback(EMBER_AF_LONG_POLL);
-      emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL);
-      emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL_FOR_PARENT_CONNECTIVITY);
-      emberAfSetDefaultSleepControl(EMBER_AF_OK_TO_SLEEP);
-      APP_DEBUG_PRINTF("Debug: fast poll window ended (back to long poll)\n");
-#endif
-      app_fast_poll_active = false;
-      app_fast_poll_start_tick = 0;
-    }
-  }
+  // Return to normal sleepy-end-device behavior after interview window.
+  emberAfSetDefaultPollControlCallback(EMBER_AF_LONG_POLL);
+  emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL);
+  emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL_FOR_PARENT_CONNECTIVITY);
+  emberAfSetDefaultSleepControl(EMBER_AF_OK_TO_SLEEP);
+  APP_DEBUG_PRINTF("Debug: fast poll window ended (back to long poll)\n");
+#endif
+}
 #endif
 
 #if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
-  if (app_manual_poll_boost_active) {
-    if (emberAfNetworkState() != EMBER_JOINED_NETWORK) {
-      app_manual_poll_boost_active = false;
-      app_manual_poll_boost_start_tick = 0;
-      app_manual_poll_boost_last_tick = 0;
-    } else {
-      uint32_t elapsed_ms = sl_sleeptimer_tick_to_ms(now - app_manual_poll_boost_start_tick);
-      if (elapsed_ms >= APP_RUNTIME_MANUAL_POLL_BOOST_MS) {
-        app_manual_poll_boost_active = false;
-        app_manual_poll_boost_start_tick = 0;
-        app_manual_poll_boost_last_tick = 0;
-        APP_DEBUG_PRINTF("Debug: manual poll boost window ended\n");
-      } else if (app_manual_poll_boost_last_tick == 0
-                 || sl_sleeptimer_tick_to_ms(now - app_manual_poll_boost_last_tick)
-                 >= APP_DEBUG_MANUAL_POLL_INTERVAL_MS) {
-        app_manual_poll_boost_last_tick = now;
-        EmberStatus poll_st = emberPollForData();
-        if (poll_st != EMBER_SUCCESS && poll_st != EMBER_MAC_SCANNING) {
-          APP_DEBUG_PRINTF("Debug: manual poll -> 0x%02x\n", poll_st);
-        }
-      }
+static void app_manual_poll_handler(app_sched_task_t *task)
+{
+  if (emberAfNetworkState() != EMBER_JOINED_NETWORK) {
+    return;
+  }
+  if ((int32_t)(sl_sleeptimer_get_tick_count() - app_manual_poll_boost_end_tick) >= 0) {
+    APP_DEBUG_PRINTF("Debug: manual poll boost window ended\n");
+    return;
+  }
+  EmberStatus poll_st = emberPollForData();
+  if (poll_st != EMBER_SUCCESS && poll_st != EMBER_MAC_SCANNING) {
+    APP_DEBUG_PRINTF("Debug: manual poll -> 0x%02x\n", poll_st);
+  }
+  app_sched_start_ms(task, APP_DEBUG_MANUAL_POLL_INTERVAL_MS);
+}
+#endif
+
+static void app_runtime_dispatch_button(const app_event_t *event)
+{
+  bool long_press = (event->type == APP_EVENT_BUTTON_LONG);
+
+  // Hard gate: while joining or right after a leave, drop button activity.
+  if (network_join_in_progress || app_leave_guard_active()) {
+    button_pressed = false;
+    button_press_start_tick = 0;
+    return;
+  }
+
+  if (app_sched_remaining_ms(&app_button_guard) > 0) {
+    APP_DEBUG_PRINTF("Button guard: %s press ignored\n", long_press ? "long" : "short");
+    return;
+  }
+
+  if (long_press) {
+    APP_DEBUG_PRINTF("Button long press (%lu ms)\n", (unsigned long)event->arg);
+    emberAfCorePrintln("Button: Long press detected (poll callback)");
+    handle_long_press();
+  } else {
+    APP_DEBUG_PRINTF("Button short press (%lu ms)\n", (unsigned long)event->arg);
+    emberAfCorePrintln("Button: Short press detected (poll callback)");
+    handle_short_press();
+  }
+}
+
+static void app_runtime_dispatch_events(void)
+{
+  app_event_t event;
+
+  while (app_event_get(&event)) {
+    switch (event.type) {
+      case APP_EVENT_BUTTON_SHORT:
+      case APP_EVENT_BUTTON_LONG:
+        app_runtime_dispatch_button(&event);
+        break;
+      default:
+        break;
     }
   }
+}
+
+void app_runtime_poll(void)
+{
+#if defined(SL_CATALOG_SIMPLE_BUTTON_PRESENT) && (APP_DEBUG_POLL_SIMPLE_BUTTON_INSTANCES != 0)
+  // Keep simple_button state machine updated even if AF tick callback isn't
+  // scheduled frequently on this target.
+  sl_simple_button_poll_instances();
 #endif
+
+  // Some targets do not run emberAfTickCallback reliably in this app flow.
+  // Drain interrupt events here to guarantee action dispatch.
+  if (app_event_pending()) {
+    app_runtime_dispatch_events();
+  }
+
+  // Everything timed runs from the scheduler, and only once due; a wake
+  // with nothing due costs one tick comparison here.
+  app_sched_process();
+  if (app_sched_timer_woke()) {
+    // Tasks with a source of their own (sensor, rejoin) already hinted it
+    app_diag_wake_hint(APP_DIAG_WAKE_APP_TIMER);
+  }
 }
 
 bool app_button_ready(void)
@@ -920,7 +945,6 @@ void emberAfStackStatusCallback(EmberStatus status)
   (void)status;
   return;
 #endif
-  uint32_t now = sl_sleeptimer_get_tick_count();
   APP_DEBUG_PRINTF("Stack status: 0x%02x\n", status);
   if (status == EMBER_NETWORK_UP) {
     emberAfCorePrintln("Network joined successfully");
@@ -936,30 +960,27 @@ void emberAfStackStatusCallback(EmberStatus status)
 #else
     APP_DEBUG_PRINTF("Join: keep-alive mode: stack default\n");
 #endif
-    app_button_unlock_tick = now + sl_sleeptimer_ms_to_tick(APP_RUNTIME_BUTTON_GUARD_AFTER_JOIN_MS);
+    app_sched_start_ms(&app_button_guard, APP_RUNTIME_BUTTON_GUARD_AFTER_JOIN_MS);
     APP_DEBUG_PRINTF("Button guard: ignoring BTN0 for %lu ms after join\n",
                      (unsigned long)APP_RUNTIME_BUTTON_GUARD_AFTER_JOIN_MS);
 
 #if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
     if (runtime_node_type == EMBER_SLEEPY_END_DEVICE) {
-      app_manual_poll_boost_active = true;
-      app_manual_poll_boost_start_tick = sl_sleeptimer_get_tick_count();
-      app_manual_poll_boost_last_tick = 0;
+      app_manual_poll_boost_end_tick = sl_sleeptimer_get_tick_count()
+                                       + sl_sleeptimer_ms_to_tick(APP_RUNTIME_MANUAL_POLL_BOOST_MS);
+      app_sched_start_ms(&app_manual_poll_task, 0);
       APP_DEBUG_PRINTF("Debug: manual poll boost enabled for %lu ms (interval=%lu ms)\n",
                        (unsigned long)APP_RUNTIME_MANUAL_POLL_BOOST_MS,
                        (unsigned long)APP_DEBUG_MANUAL_POLL_INTERVAL_MS);
     } else {
-      app_manual_poll_boost_active = false;
-      app_manual_poll_boost_start_tick = 0;
-      app_manual_poll_boost_last_tick = 0;
+      app_sched_cancel(&app_manual_poll_task);
     }
 #endif
 
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT) && (APP_DEBUG_AWAKE_AFTER_JOIN_MS > 0)
-    if (!app_join_awake_active) {
+    if (!app_sched_is_armed(&app_join_awake_end_task)) {
       sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM0);
-      app_join_awake_active = true;
-      app_join_awake_start_tick = sl_sleeptimer_get_tick_count();
+      app_sched_start_ms(&app_join_awake_end_task, APP_DEBUG_AWAKE_AFTER_JOIN_MS);
       APP_DEBUG_PRINTF("Debug: keeping EM0 for %lu ms after join\n",
                        (unsigned long)APP_DEBUG_AWAKE_AFTER_JOIN_MS);
     }
@@ -972,8 +993,7 @@ void emberAfStackStatusCallback(EmberStatus status)
     emberAfSetShortPollIntervalMsCallback((int16u)APP_RUNTIME_FAST_POLL_INTERVAL_MS);
     emberAfSetWakeTimeoutMsCallback((int16u)APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS);
     emberAfSetDefaultSleepControl(EMBER_AF_STAY_AWAKE);
-    app_fast_poll_active = true;
-    app_fast_poll_start_tick = sl_sleeptimer_get_tick_count();
+    app_sched_start_ms(&app_fast_poll_end_task, APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS);
     APP_DEBUG_PRINTF("Debug: fast poll enabled for %lu ms (short=%lu ms)\n",
                      (unsigned long)APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS,
                      (unsigned long)APP_RUNTIME_FAST_POLL_INTERVAL_MS);
@@ -985,23 +1005,20 @@ void emberAfStackStatusCallback(EmberStatus status)
     network_join_in_progress = false;
     join_scan_in_progress = false;
     join_network_found = false;
-    app_join_retry_unlock_tick = 0;
+    app_sched_cancel(&app_join_retry_guard);
 
     // Cancel any pending rejoin attempts - network is up
-    sl_sleeptimer_stop_timer(&app_rejoin_wake_timer);
-    app_auto_join_scheduled = false;
-    app_auto_join_tick = 0;
+    app_sched_cancel(&app_auto_join_task);
 
     // Stop LED blinking
-    led_blink_active = false;
-    sl_zigbee_event_set_inactive(&led_blink_event);
+    app_sched_cancel(&led_blink_task);
 
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
     // Turn LED on solid to indicate network is up
     sl_led_turn_on(&sl_led_led0);
 
     // Schedule LED to turn off after 3 seconds to save power
-    sl_zigbee_event_set_delay_ms(&led_off_event, 3000);
+    app_sched_start_ms(&led_off_task, 3000);
 #endif
 
     // Avoid heavy sensor transactions right at join/interview start.
@@ -1015,41 +1032,40 @@ void emberAfStackStatusCallback(EmberStatus status)
     if (app_intentional_leave_pending) {
       emberAfCorePrintln("Network down after manual leave - scheduling rejoin");
       app_intentional_leave_pending = false;
-      app_leave_unlock_tick = now + sl_sleeptimer_ms_to_tick(APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
-      app_set_join_retry_backoff(now, APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
+      app_sched_start_ms(&app_leave_guard, APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
+      app_set_join_retry_backoff(APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
       APP_DEBUG_PRINTF("Button guard: ignoring BTN0 for %lu ms after leave\n",
                        (unsigned long)APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
       // Auto-rejoin after the button guard window expires.
       app_schedule_auto_rejoin(APP_DEBUG_BUTTON_GUARD_AFTER_LEAVE_MS);
     } else {
       emberAfCorePrintln("Network down - scheduling auto-rejoin");
-      app_set_join_retry_backoff(now, APP_DEBUG_JOIN_RETRY_BACKOFF_AFTER_LEAVE_MS);
+      app_set_join_retry_backoff(APP_DEBUG_JOIN_RETRY_BACKOFF_AFTER_LEAVE_MS);
 
       // Schedule automatic rejoin attempt after backoff delay.
       app_schedule_auto_rejoin(APP_REJOIN_AFTER_LOSS_DELAY_MS);
     }
-    app_button_unlock_tick = 0;
+    app_sched_cancel(&app_button_guard);
     join_security_configured = false;
 
 #if (APP_RUNTIME_FAST_POLL_AFTER_JOIN_MS > 0)
     emberAfSetDefaultPollControlCallback(EMBER_AF_LONG_POLL);
     emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL);
     emberAfRemoveFromCurrentAppTasksCallback(EMBER_AF_FORCE_SHORT_POLL_FOR_PARENT_CONNECTIVITY);
-    app_fast_poll_active = false;
-    app_fast_poll_start_tick = 0;
+    app_sched_cancel(&app_fast_poll_end_task);
 #endif
     // Always allow sleep when network is down regardless of fast-poll config.
     emberAfSetDefaultSleepControl(EMBER_AF_OK_TO_SLEEP);
 
-    app_manual_poll_boost_active = false;
-    app_manual_poll_boost_start_tick = 0;
-    app_manual_poll_boost_last_tick = 0;
+#if (APP_RUNTIME_MANUAL_POLL_BOOST_MS > 0)
+    app_sched_cancel(&app_manual_poll_task);
+#endif
 
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
     // Turn LED off when network is down
     sl_led_turn_off(&sl_led_led0);
     // Cancel any pending LED off event
-    sl_zigbee_event_set_inactive(&led_off_event);
+    app_sched_cancel(&led_off_task);
 #endif
 
     // Stop periodic sensor timer while network is down to avoid wakeups.
@@ -1060,12 +1076,61 @@ void emberAfStackStatusCallback(EmberStatus status)
 
 void emberAfPluginEndDeviceSupportPollCompletedCallback(EmberStatus status)
 {
+  app_diag_wake_hint(APP_DIAG_WAKE_POLL);
+  app_energy_note_poll();
+
+  // Samples due close to this poll ride on its wake
+  app_sensor_note_poll(emberAfGetCurrentPollIntervalMsCallback());
+
   // Avoid log spam on normal idle polls.
   if (status != EMBER_MAC_NO_DATA) {
     APP_DEBUG_PRINTF("Poll complete: status=0x%02x\n", status);
   }
 }
 
+// With APP_REPORT_BUNDLE, the standard reports of the measured clusters are
+// replaced by the bundle frame and never reach the radio.
+bool emberAfPreMessageSendCallback(EmberAfMessageStruct *messageStruct,
+                                   EmberStatus *status)
+{
+  if (messageStruct == NULL || messageStruct->apsFrame == NULL) {
+    return false;
+  }
+  if (app_sensor_suppress_report(messageStruct->apsFrame->sourceEndpoint,
+                                 messageStruct->apsFrame->clusterId,
+                                 messageStruct->message,
+                                 messageStruct->messageLength)) {
+    *status = EMBER_SUCCESS;
+    return true;
+  }
+  return false;
+}
+
+bool emberAfMessageSentCallback(EmberOutgoingMessageType type,
+                                uint16_t indexOrDestination,
+                                EmberApsFrame *apsFrame,
+                                uint16_t msgLen,
+                                uint8_t *message,
+                                EmberStatus status)
+{
+  (void)type;
+  (void)indexOrDestination;
+
+  if (apsFrame != NULL) {
+    app_sensor_note_message_sent(apsFrame->sourceEndpoint, message, msgLen);
+  }
+
+  // Runs once per APS message, delivered or not. MAC and APS retries are not
+  // visible here, so each message is charged as a single frame.
+  app_energy_note_tx(msgLen);
+
+  // Battery just carried a TX; lets a due battery measurement see that load.
+  if (status == EMBER_SUCCESS) {
+    app_sensor_note_radio_tx();
+  }
+  return false;
+}
+
 static bool app_handle_basic_mfg_rw_command(const EmberAfClusterCommand *cmd)
 {
   if (cmd == NULL || cmd->apsFrame == NULL) {
@@ -1105,6 +1170,12 @@ static bool app_handle_basic_mfg_rw_command(const EmberAfClusterCommand *cmd)
                                                        &attr_type,
                                                        value,
                                                        &value_len);
+      if (st == EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE) {
+        st = app_diag_read_mfg_attribute(attribute_id, &attr_type, value, &value_len);
+      }
+      if (st == EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE) {
+        st = app_energy_read_mfg_attribute(attribute_id, &attr_type, value, &value_len);
+      }
 
       (void)emberAfPutInt16uInResp(attribute_id);
       (void)emberAfPutInt8uInResp((uint8_t)st);
@@ -1147,10 +1218,13 @@ static bool app_handle_basic_mfg_rw_command(const EmberAfClusterCommand *cmd)
         break;
       }
 
-      EmberAfStatus st = app_config_write_mfg_attribute(attribute_id,
-                                                        attr_type,
-                                                        &cmd->buffer[i],
-                                                        data_len);
+      EmberAfStatus st = (app_diag_is_attribute(attribute_id)
+                          || app_energy_is_attribute(attribute_id))
+                         ? EMBER_ZCL_STATUS_READ_ONLY
+                         : app_config_write_mfg_attribute(attribute_id,
+                                                          attr_type,
+                                                          &cmd->buffer[i],
+                                                          data_len);
       i += data_len;
 
       if (st != EMBER_ZCL_STATUS_SUCCESS) {
@@ -1178,6 +1252,11 @@ static bool app_handle_basic_mfg_rw_command(const EmberAfClusterCommand *cmd)
 
 bool emberAfPreCommandReceivedCallback(EmberAfClusterCommand *cmd)
 {
+  app_diag_wake_hint(APP_DIAG_WAKE_RADIO_RX);
+  if (cmd != NULL) {
+    app_energy_note_rx(cmd->bufLen);
+  }
+
   if (app_handle_basic_mfg_rw_command(cmd)) {
     return true;
   }
@@ -1256,30 +1335,23 @@ bool emberAfPreCommandReceivedCallback(EmberAfClusterCommand *cmd)
  * CANNOT call emberAfCorePrintln()!
  * CANNOT call sl_zigbee_event_set_active()!
  *
- * Only allowed: read hardware, do math, set volatile flags
- * The button_poll_event running in main context will check these flags
+ * Only allowed: read hardware, do math, app_event_post()
+ * app_runtime_poll() drains the events in main context
  */
 #ifdef SL_CATALOG_SIMPLE_BUTTON_PRESENT
 void sl_button_on_change(const sl_button_t *handle)
 {
   if (handle == &sl_button_btn0) {
+    app_diag_wake_hint(APP_DIAG_WAKE_BUTTON);
+
     if (network_join_in_progress) {
-      button_short_press_pending = false;
-      button_long_press_pending = false;
       button_pressed = false;
       button_press_start_tick = 0;
       return;
     }
 
-    if (app_button_unlock_tick != 0) {
-      uint32_t now = sl_sleeptimer_get_tick_count();
-      if ((int32_t)(app_button_unlock_tick - now) > 0) {
-        button_pressed = false;
-        button_press_start_tick = 0;
-        return;
-      }
-      app_button_unlock_tick = 0;
-    }
+    // The button and leave guards are app_sched state, main loop only;
+    // app_runtime_dispatch_button() applies them to the queued press.
 
     // Ignore button edges before AF init to avoid stale hold-duration math.
     if (!af_init_seen) {
@@ -1309,14 +1381,13 @@ void sl_button_on_change(const sl_button_t *handle)
           return;
         }
 
-        // Set flags for main context to poll
-        // These will be checked by button_poll_event_handler()
+        // Queue the action for the main loop (app_runtime_poll drains it).
+        // A full ring drops the press and counts it as an overflow.
         if (duration_ms >= BUTTON_DEBOUNCE_MS) {
-          if (duration_ms >= APP_BUTTON_LONG_PRESS_MS) {
-            button_long_press_pending = true;
-          } else {
-            button_short_press_pending = true;
-          }
+          (void)app_event_post(duration_ms >= APP_BUTTON_LONG_PRESS_MS
+                               ? APP_EVENT_BUTTON_LONG
+                               : APP_EVENT_BUTTON_SHORT,
+                               duration_ms);
         }
 
         button_pressed = false;
@@ -1331,14 +1402,14 @@ void sl_button_on_change(const sl_button_t *handle)
  *
  * Blinks the LED while joining network.
  */
-static void led_blink_event_handler(sl_zigbee_event_t *event)
+static void led_blink_handler(app_sched_task_t *task)
 {
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
-  if (led_blink_active) {
-    sl_led_toggle(&sl_led_led0);
-    // Blink every 500ms
-    sl_zigbee_event_set_delay_ms(&led_blink_event, 500);
-  }
+  sl_led_toggle(&sl_led_led0);
+  // Blink every 500ms
+  app_sched_advance_ms(task, 500);
+#else
+  (void)task;
 #endif
 }
 
@@ -1347,8 +1418,9 @@ static void led_blink_event_handler(sl_zigbee_event_t *event)
  *
  * Turns off the LED after network join confirmation to save power.
  */
-static void led_off_event_handler(sl_zigbee_event_t *event)
+static void led_off_handler(app_sched_task_t *task)
 {
+  (void)task;
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
   sl_led_turn_off(&sl_led_led0);
   emberAfCorePrintln("LED turned off to save power");
@@ -1451,8 +1523,7 @@ static void try_next_channel(void)
 
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
     // Stop LED blinking
-    led_blink_active = false;
-    sl_zigbee_event_set_inactive(&led_blink_event);
+    app_sched_cancel(&led_blink_task);
     sl_led_turn_off(&sl_led_led0);
 #endif
   }
@@ -1596,7 +1667,7 @@ void emberAfScanCompleteCallback(uint8_t channel, EmberStatus status)
       join_network_found = false;
       current_channel_index = 0;
       join_security_configured = false;
-      app_set_join_retry_backoff(sl_sleeptimer_get_tick_count(), APP_DEBUG_JOIN_RETRY_BACKOFF_MS);
+      app_set_join_retry_backoff(APP_DEBUG_JOIN_RETRY_BACKOFF_MS);
       }
     return;
   }
@@ -1661,8 +1732,7 @@ static bool configure_join_security(void)
  */
 static void start_network_join(void)
 {
-  uint32_t now = sl_sleeptimer_get_tick_count();
-  if (app_join_retry_blocked(now)) {
+  if (app_join_retry_blocked()) {
     APP_DEBUG_PRINTF("Join: retry backoff active\n");
     return;
   }
@@ -1693,8 +1763,7 @@ static void start_network_join(void)
   network_join_in_progress = true;
 
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
-  led_blink_active = true;
-  sl_zigbee_event_set_active(&led_blink_event);
+  app_sched_start_ms(&led_blink_task, 0);
 #endif
 
   EmberStatus join_status = EMBER_INVALID_CALL;
@@ -1721,8 +1790,7 @@ static void start_network_join(void)
 
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
     if (!network_join_in_progress) {
-      led_blink_active = false;
-      sl_zigbee_event_set_inactive(&led_blink_event);
+      app_sched_cancel(&led_blink_task);
       sl_led_turn_off(&sl_led_led0);
     }
 #endif
@@ -1743,8 +1811,7 @@ static void handle_long_press(void)
   if (network_state == EMBER_JOINED_NETWORK) {
     emberAfCorePrintln("Long press: leaving and rejoining network...");
     app_intentional_leave_pending = true;
-    button_short_press_pending = false;
-    button_long_press_pending = false;
+    app_event_flush();
     button_pressed = false;
     button_press_start_tick = 0;
 
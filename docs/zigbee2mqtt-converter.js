@@ -1,7 +1,16 @@
 /**
  * Zigbee2MQTT External Converter for OpenBME280 sensor profiles.
- * Supports one manufacturer-specific config attribute:
- *   - sensor_read_interval (Basic/0x0000, attr 0xF000, mfgCode 0x1002)
+ * Supports manufacturer-specific config attributes (Basic/0x0000, mfgCode 0x1002):
+ *   - sensor_read_interval (attr 0xF000)
+ *   - sht31_measurement_mode (attr 0xF005, SHT31 profile only)
+ *   - adaptive_interval_min / adaptive_interval_max (attr 0xF006 / 0xF007)
+ *   - adaptive_aggressiveness (attr 0xF008, 0 = fixed interval)
+ *   - battery_chemistry (attr 0xF009, state-of-charge curve)
+ *   - i2c_* diagnostics counters (attrs 0xF020..0xF025, read-only)
+ *   - wake_* counters and em*_time residency (attrs 0xF026..0xF02F, read-only)
+ *   - energy_* estimate (attrs 0xF030..0xF033, read-only)
+ * Also decodes the optional report bundle (firmware APP_REPORT_BUNDLE=1):
+ * one mfg-specific genBasic report with attrs 0xF040..0xF044.
  */
 
 const fz = require('zigbee-herdsman-converters/converters/fromZigbee');
@@ -14,6 +23,62 @@ const ea = exposes.access;
 
 const MANUFACTURER_CODE = 0x1002;
 const SENSOR_READ_INTERVAL_ATTR = 0xF000;
+const SHT31_MEASUREMENT_MODE_ATTR = 0xF005;
+const BATTERY_CHEMISTRY_ATTR = 0xF009;
+// Adaptive interval settings: key -> attribute id and ZCL type
+const ADAPTIVE_ATTRS = {
+  adaptive_interval_min: {id: 0xF006, type: 0x21},
+  adaptive_interval_max: {id: 0xF007, type: 0x21},
+  adaptive_aggressiveness: {id: 0xF008, type: 0x20},
+};
+// Bits 0-1 repeatability (0 low, 1 medium, 2 high), bit 2 clock stretching
+const SHT31_MEASUREMENT_MODES = {
+  low: 0x00,
+  medium: 0x01,
+  high: 0x02,
+  low_stretch: 0x04,
+  medium_stretch: 0x05,
+  high_stretch: 0x06,
+};
+
+const BATTERY_CHEMISTRIES = {
+  alkaline: 0x00,
+  nimh: 0x01,
+  lithium: 0x02,
+};
+
+// Read-only diagnostics counters (uint32 since boot): key -> attribute id
+const DIAG_ATTRS = {
+  i2c_nack_count: 0xF020,
+  i2c_arb_lost_count: 0xF021,
+  i2c_bus_error_count: 0xF022,
+  i2c_timeout_count: 0xF023,
+  i2c_recovery_count: 0xF024,
+  i2c_recovery_failed_count: 0xF025,
+  wake_sensor_timer_count: 0xF026,
+  wake_rejoin_timer_count: 0xF027,
+  wake_poll_count: 0xF028,
+  wake_button_count: 0xF029,
+  wake_radio_rx_count: 0xF02A,
+  wake_unknown_count: 0xF02B,
+  wake_app_timer_count: 0xF02C,
+  em0_time_ms: 0xF02D,
+  em1_time_ms: 0xF02E,
+  em2_time_s: 0xF02F,
+  energy_consumed_uah: 0xF030,
+  energy_avg_current_na: 0xF031,
+  energy_projected_life_h: 0xF032,
+  energy_soc_reanchor_count: 0xF033,
+};
+
+// Report bundle: attr id -> [key, scale] matching the standard converters
+const REPORT_BUNDLE_ATTRS = {
+  0xF040: ['temperature', (v) => v / 100],
+  0xF041: ['humidity', (v) => v / 100],
+  0xF042: ['pressure', (v) => v],
+  0xF043: ['voltage', (v) => v * 100],
+  0xF044: ['battery', (v) => v / 2],
+};
 
 const fzLocal = {
   openbme280_config: {
@@ -21,9 +86,32 @@ const fzLocal = {
     type: ['attributeReport', 'readResponse'],
     convert: (model, msg, publish, options, meta) => {
       const data = msg.data || {};
+      const result = {};
       const raw = data[SENSOR_READ_INTERVAL_ATTR] ?? data[SENSOR_READ_INTERVAL_ATTR.toString()];
-      if (raw === undefined) return {};
-      return {sensor_read_interval: raw};
+      if (raw !== undefined) result.sensor_read_interval = raw;
+      const mode = data[SHT31_MEASUREMENT_MODE_ATTR] ?? data[SHT31_MEASUREMENT_MODE_ATTR.toString()];
+      if (mode !== undefined) {
+        const name = Object.keys(SHT31_MEASUREMENT_MODES).find((k) => SHT31_MEASUREMENT_MODES[k] === mode);
+        if (name !== undefined) result.sht31_measurement_mode = name;
+      }
+      const chemistry = data[BATTERY_CHEMISTRY_ATTR] ?? data[BATTERY_CHEMISTRY_ATTR.toString()];
+      if (chemistry !== undefined) {
+        const name = Object.keys(BATTERY_CHEMISTRIES).find((k) => BATTERY_CHEMISTRIES[k] === chemistry);
+        if (name !== undefined) result.battery_chemistry = name;
+      }
+      for (const [key, attr] of Object.entries(ADAPTIVE_ATTRS)) {
+        const value = data[attr.id] ?? data[attr.id.toString()];
+        if (value !== undefined) result[key] = value;
+      }
+      for (const [key, id] of Object.entries(DIAG_ATTRS)) {
+        const value = data[id] ?? data[id.toString()];
+        if (value !== undefined) result[key] = value;
+      }
+      for (const [id, [key, scale]] of Object.entries(REPORT_BUNDLE_ATTRS)) {
+        const value = data[id] ?? data[Number(id)];
+        if (value !== undefined) result[key] = scale(value);
+      }
+      return result;
     },
   },
 };
@@ -40,6 +128,51 @@ const tzLocal = {
       await entity.read('genBasic', [SENSOR_READ_INTERVAL_ATTR], {manufacturerCode: MANUFACTURER_CODE});
     },
   },
+  openbme280_sht31_mode: {
+    key: ['sht31_measurement_mode'],
+    convertSet: async (entity, key, value, meta) => {
+      const mode = SHT31_MEASUREMENT_MODES[value];
+      if (mode === undefined) throw new Error(`Unsupported SHT31 measurement mode: ${value}`);
+      await entity.write('genBasic', {[SHT31_MEASUREMENT_MODE_ATTR]: {value: mode, type: 0x30}},
+                         {manufacturerCode: MANUFACTURER_CODE});
+      return {state: {sht31_measurement_mode: value}};
+    },
+    convertGet: async (entity, key, meta) => {
+      await entity.read('genBasic', [SHT31_MEASUREMENT_MODE_ATTR], {manufacturerCode: MANUFACTURER_CODE});
+    },
+  },
+  openbme280_battery_chemistry: {
+    key: ['battery_chemistry'],
+    convertSet: async (entity, key, value, meta) => {
+      const chemistry = BATTERY_CHEMISTRIES[value];
+      if (chemistry === undefined) throw new Error(`Unsupported battery chemistry: ${value}`);
+      await entity.write('genBasic', {[BATTERY_CHEMISTRY_ATTR]: {value: chemistry, type: 0x30}},
+                         {manufacturerCode: MANUFACTURER_CODE});
+      return {state: {battery_chemistry: value}};
+    },
+    convertGet: async (entity, key, meta) => {
+      await entity.read('genBasic', [BATTERY_CHEMISTRY_ATTR], {manufacturerCode: MANUFACTURER_CODE});
+    },
+  },
+  openbme280_adaptive: {
+    key: Object.keys(ADAPTIVE_ATTRS),
+    convertSet: async (entity, key, value, meta) => {
+      const attr = ADAPTIVE_ATTRS[key];
+      const number = Number(value);
+      await entity.write('genBasic', {[attr.id]: {value: number, type: attr.type}},
+                         {manufacturerCode: MANUFACTURER_CODE});
+      return {state: {[key]: number}};
+    },
+    convertGet: async (entity, key, meta) => {
+      await entity.read('genBasic', [ADAPTIVE_ATTRS[key].id], {manufacturerCode: MANUFACTURER_CODE});
+    },
+  },
+  openbme280_diag: {
+    key: Object.keys(DIAG_ATTRS),
+    convertGet: async (entity, key, meta) => {
+      await entity.read('genBasic', [DIAG_ATTRS[key]], {manufacturerCode: MANUFACTURER_CODE});
+    },
+  },
 };
 
 module.exports = {
@@ -58,6 +191,10 @@ module.exports = {
   toZigbee: [
     tz.factory_reset,
     tzLocal.openbme280_config,
+    tzLocal.openbme280_sht31_mode,
+    tzLocal.openbme280_adaptive,
+    tzLocal.openbme280_battery_chemistry,
+    tzLocal.openbme280_diag,
   ],
   exposes: [
     e.temperature(),
@@ -71,6 +208,30 @@ module.exports = {
       .withValueStep(1)
       .withUnit('s')
       .withDescription('Sensor reading interval in seconds'),
+    exposes.enum('sht31_measurement_mode', ea.ALL, Object.keys(SHT31_MEASUREMENT_MODES))
+      .withDescription('SHT31 repeatability (conversion max 4.5/6.5/15.5 ms) and clock stretching'),
+    exposes.numeric('adaptive_interval_min', ea.ALL)
+      .withValueMin(10)
+      .withValueMax(3600)
+      .withValueStep(1)
+      .withUnit('s')
+      .withDescription('Shortest adaptive reading interval (used while values change fast)'),
+    exposes.numeric('adaptive_interval_max', ea.ALL)
+      .withValueMin(10)
+      .withValueMax(3600)
+      .withValueStep(1)
+      .withUnit('s')
+      .withDescription('Longest adaptive reading interval (reached while values are stable)'),
+    exposes.numeric('adaptive_aggressiveness', ea.ALL)
+      .withValueMin(0)
+      .withValueMax(8)
+      .withValueStep(1)
+      .withDescription('Interval growth per stable reading in eighths; 0 keeps sensor_read_interval fixed'),
+    exposes.enum('battery_chemistry', ea.ALL, Object.keys(BATTERY_CHEMISTRIES))
+      .withDescription('Cell type of the 2xAAA pack; selects the discharge curve behind the battery percentage'),
+    ...Object.keys(DIAG_ATTRS).map((key) => exposes.numeric(key, ea.STATE_GET)
+      .withCategory('diagnostic')
+      .withDescription('Diagnostics value since boot (read on demand)')),
   ],
   configure: async (device, coordinatorEndpoint, logger) => {
     const endpoint = device.getEndpoint(1);
@@ -16,6 +16,9 @@
 // I2C peripheral configuration for TRÅDFRI
 #define BME280_I2C_PERIPHERAL         I2C0
 #define BME280_I2C_CLOCK              cmuClock_I2C0
+#define BME280_I2C_IRQN               I2C0_IRQn
+#define BME280_I2C_IRQ_HANDLER        I2C0_IRQHandler
+#define BME280_I2C_DMA_SIGNAL         dmadrvPeripheralSignal_I2C0_RXDATAV
 #define BME280_I2C_FREQ               100000  // 100 kHz for better noise immunity
 
 // I2C SDA pin - PC10 on TRÅDFRI (available on connector)
@@ -8,6 +8,7 @@
 #include "sl_event_handler.h"
 #include "sl_sleeptimer.h"
 #include "app_sensor.h"
+#include "app_diag.h"
 #include <stdio.h>
 #include <stdint.h>
 #include "app/framework/include/af.h"
@@ -123,6 +124,9 @@ int main(void)
   // Initialize Silicon Labs system
   sl_system_init();
 
+  // Wake-source and energy-mode accounting (diagnostics attributes)
+  app_diag_init();
+
 #if APP_DEBUG_CRASH_PRINT || APP_DEBUG_BOOT_SPAM_MS
   app_debug_record_reset_info();
 #endif
@@ -133,7 +137,7 @@ int main(void)
 #endif
 
 #if APP_DEBUG_FORCE_AF_INIT
-  // Enable AF-init watchdog; fallback callback is handled in app_runtime_poll().
+  // Enable AF-init watchdog; fallback callback runs as an app_sched task.
   // Avoid direct emberAfInit() call here to keep framework init sequence intact.
   printf("Debug: AF init watchdog enabled\n");
   app_debug_force_af_init();
@@ -202,13 +206,14 @@ int main(void)
     }
 #endif
 
-    // Process periodic sensor work scheduled by sleeptimer callback.
-    app_sensor_process();
-
-    // Runtime poll drives button handling, deferred join, auto-join timer,
-    // and sensor watchdog. Keep it enabled for both release and debug builds.
+    // Runtime poll dispatches button flags and runs the app_sched tasks that
+    // are due (sensor timer, deferred join, auto-join, sensor watchdog, LED,
+    // post-join windows). Keep it enabled for both release and debug builds.
     app_runtime_poll();
 
+    // Process sensor work flagged by the tasks above (same pass, before sleep).
+    app_sensor_process();
+
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
     // Sleep until next event
 #if (APP_DEBUG_SLEEP_TRACE != 0)
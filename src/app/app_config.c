@@ -2,12 +2,19 @@
  * @file app_config.c
  * @brief Configuration attribute handler for OpenBME280 sensor profiles
  *
- * Keeps only one manufacturer-specific Basic attribute:
+ * Manufacturer-specific Basic attributes:
  * - 0xF000 Sensor Read Interval (seconds)
+ * - 0xF005 SHT31 Measurement Mode (SHT31 profile only)
+ * - 0xF006 / 0xF007 Adaptive Interval Min / Max (seconds)
+ * - 0xF008 Adaptive Aggressiveness (0 = fixed interval)
+ * - 0xF009 Battery Chemistry (state-of-charge curve)
  */
 
 #include "app_config.h"
 #include "app_sensor.h"
+#include "app_profile.h"
+#define APP_LOG_MODULE APP_LOG_MODULE_CONFIG
+#include "app_log.h"
 #include "af.h"
 #include "app/framework/include/af.h"
 
@@ -17,6 +24,8 @@
 #define APP_SENSOR_INTERVAL_MAX_SECONDS 3600u
 #define APP_SENSOR_INTERVAL_DEFAULT_SECONDS 10u
 
+#define APP_SHT31_MODE_VALID_MASK (APP_SHT31_MODE_REPEATABILITY_MASK | APP_SHT31_MODE_CLOCK_STRETCH)
+
 // Global configuration (loaded from NVM at startup)
 static app_config_t config;
 
@@ -32,6 +41,18 @@ static EmberAfStatus read_config_attribute(EmberAfAttributeId attribute_id,
                                                         data_size);
 }
 
+static bool interval_is_valid(uint16_t seconds)
+{
+  return seconds >= APP_SENSOR_INTERVAL_MIN_SECONDS
+         && seconds <= APP_SENSOR_INTERVAL_MAX_SECONDS;
+}
+
+static bool sht31_mode_is_valid(uint8_t mode)
+{
+  return (mode & ~APP_SHT31_MODE_VALID_MASK) == 0u
+         && (mode & APP_SHT31_MODE_REPEATABILITY_MASK) <= 2u;
+}
+
 static EmberAfStatus write_config_attribute(EmberAfAttributeId attribute_id,
                                             const uint8_t *data,
                                             EmberAfAttributeType data_type)
@@ -44,6 +65,13 @@ static EmberAfStatus write_config_attribute(EmberAfAttributeId attribute_id,
                                                          data_type);
 }
 
+static void apply_adaptive_config(void)
+{
+  app_sensor_set_adaptive_interval(config.adaptive_interval_min_seconds,
+                                   config.adaptive_interval_max_seconds,
+                                   config.adaptive_aggressiveness);
+}
+
 void app_config_init(void)
 {
   EmberAfStatus status;
@@ -60,8 +88,66 @@ void app_config_init(void)
 
   config.sensor_read_interval_seconds = interval;
 
-  emberAfCorePrintln("Config loaded:");
-  emberAfCorePrintln("  Read interval: %d seconds", config.sensor_read_interval_seconds);
+  uint8_t sht31_mode = APP_SHT31_MODE_DEFAULT;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  status = read_config_attribute(ZCL_SHT31_MEASUREMENT_MODE_ATTRIBUTE_ID,
+                                 &sht31_mode,
+                                 sizeof(sht31_mode));
+  if (status != EMBER_ZCL_STATUS_SUCCESS || !sht31_mode_is_valid(sht31_mode)) {
+    sht31_mode = APP_SHT31_MODE_DEFAULT;
+  }
+#endif
+  config.sht31_measurement_mode = sht31_mode;
+
+  uint16_t adaptive_min = APP_ADAPTIVE_INTERVAL_MIN_DEFAULT_SECONDS;
+  uint16_t adaptive_max = APP_ADAPTIVE_INTERVAL_MAX_DEFAULT_SECONDS;
+  uint8_t aggressiveness = APP_ADAPTIVE_AGGRESSIVENESS_DEFAULT;
+  status = read_config_attribute(ZCL_ADAPTIVE_INTERVAL_MIN_ATTRIBUTE_ID,
+                                 (uint8_t *)&adaptive_min,
+                                 sizeof(adaptive_min));
+  if (status != EMBER_ZCL_STATUS_SUCCESS || !interval_is_valid(adaptive_min)) {
+    adaptive_min = APP_ADAPTIVE_INTERVAL_MIN_DEFAULT_SECONDS;
+  }
+  status = read_config_attribute(ZCL_ADAPTIVE_INTERVAL_MAX_ATTRIBUTE_ID,
+                                 (uint8_t *)&adaptive_max,
+                                 sizeof(adaptive_max));
+  if (status != EMBER_ZCL_STATUS_SUCCESS || !interval_is_valid(adaptive_max)) {
+    adaptive_max = APP_ADAPTIVE_INTERVAL_MAX_DEFAULT_SECONDS;
+  }
+  if (adaptive_min > adaptive_max) {
+    adaptive_min = APP_ADAPTIVE_INTERVAL_MIN_DEFAULT_SECONDS;
+    adaptive_max = APP_ADAPTIVE_INTERVAL_MAX_DEFAULT_SECONDS;
+  }
+  status = read_config_attribute(ZCL_ADAPTIVE_AGGRESSIVENESS_ATTRIBUTE_ID,
+                                 &aggressiveness,
+                                 sizeof(aggressiveness));
+  if (status != EMBER_ZCL_STATUS_SUCCESS || aggressiveness > APP_ADAPTIVE_AGGRESSIVENESS_MAX) {
+    aggressiveness = APP_ADAPTIVE_AGGRESSIVENESS_DEFAULT;
+  }
+  config.adaptive_interval_min_seconds = adaptive_min;
+  config.adaptive_interval_max_seconds = adaptive_max;
+  config.adaptive_aggressiveness = aggressiveness;
+
+  uint8_t chemistry = APP_BATTERY_CHEMISTRY_DEFAULT;
+  status = read_config_attribute(ZCL_BATTERY_CHEMISTRY_ATTRIBUTE_ID,
+                                 &chemistry,
+                                 sizeof(chemistry));
+  if (status != EMBER_ZCL_STATUS_SUCCESS || chemistry > APP_BATTERY_CHEMISTRY_LITHIUM) {
+    chemistry = APP_BATTERY_CHEMISTRY_DEFAULT;
+  }
+  config.battery_chemistry = chemistry;
+  app_sensor_set_battery_chemistry(chemistry);
+
+  APP_LOG_INFO("Config loaded:");
+  APP_LOG_INFO("  Read interval: %d seconds", config.sensor_read_interval_seconds);
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  APP_LOG_INFO("  SHT31 mode: 0x%02X", config.sht31_measurement_mode);
+#endif
+  APP_LOG_INFO("  Adaptive interval: %d..%d seconds, aggressiveness %d",
+               config.adaptive_interval_min_seconds,
+               config.adaptive_interval_max_seconds,
+               config.adaptive_aggressiveness);
+  APP_LOG_INFO("  Battery chemistry: %d", config.battery_chemistry);
 }
 
 const app_config_t *app_config_get(void)
@@ -78,8 +164,51 @@ EmberAfStatus app_config_read_mfg_attribute(EmberAfAttributeId attribute_id,
     return EMBER_ZCL_STATUS_INVALID_FIELD;
   }
 
-  if (attribute_id != ZCL_SENSOR_READ_INTERVAL_ATTRIBUTE_ID) {
-    return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  if (attribute_id == ZCL_SHT31_MEASUREMENT_MODE_ATTRIBUTE_ID) {
+    if (*value_len_io < sizeof(uint8_t)) {
+      return EMBER_ZCL_STATUS_INSUFFICIENT_SPACE;
+    }
+    *attribute_type = ZCL_ENUM8_ATTRIBUTE_TYPE;
+    value_out[0] = config.sht31_measurement_mode;
+    *value_len_io = 1;
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+#endif
+
+  if (attribute_id == ZCL_BATTERY_CHEMISTRY_ATTRIBUTE_ID) {
+    if (*value_len_io < sizeof(uint8_t)) {
+      return EMBER_ZCL_STATUS_INSUFFICIENT_SPACE;
+    }
+    *attribute_type = ZCL_ENUM8_ATTRIBUTE_TYPE;
+    value_out[0] = config.battery_chemistry;
+    *value_len_io = 1;
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+
+  if (attribute_id == ZCL_ADAPTIVE_AGGRESSIVENESS_ATTRIBUTE_ID) {
+    if (*value_len_io < sizeof(uint8_t)) {
+      return EMBER_ZCL_STATUS_INSUFFICIENT_SPACE;
+    }
+    *attribute_type = ZCL_INT8U_ATTRIBUTE_TYPE;
+    value_out[0] = config.adaptive_aggressiveness;
+    *value_len_io = 1;
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+
+  uint16_t seconds;
+  switch (attribute_id) {
+    case ZCL_SENSOR_READ_INTERVAL_ATTRIBUTE_ID:
+      seconds = config.sensor_read_interval_seconds;
+      break;
+    case ZCL_ADAPTIVE_INTERVAL_MIN_ATTRIBUTE_ID:
+      seconds = config.adaptive_interval_min_seconds;
+      break;
+    case ZCL_ADAPTIVE_INTERVAL_MAX_ATTRIBUTE_ID:
+      seconds = config.adaptive_interval_max_seconds;
+      break;
+    default:
+      return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
   }
 
   if (*value_len_io < sizeof(uint16_t)) {
@@ -87,12 +216,39 @@ EmberAfStatus app_config_read_mfg_attribute(EmberAfAttributeId attribute_id,
   }
 
   *attribute_type = ZCL_INT16U_ATTRIBUTE_TYPE;
-  value_out[0] = (uint8_t)(config.sensor_read_interval_seconds & 0xFFu);
-  value_out[1] = (uint8_t)(config.sensor_read_interval_seconds >> 8);
+  value_out[0] = (uint8_t)(seconds & 0xFFu);
+  value_out[1] = (uint8_t)(seconds >> 8);
   *value_len_io = 2;
   return EMBER_ZCL_STATUS_SUCCESS;
 }
 
+EmberAfStatus app_config_read_u32_attribute(EmberAfAttributeId attribute_id,
+                                            app_config_u32_lookup_t lookup,
+                                            uint8_t *attribute_type,
+                                            uint8_t *value_out,
+                                            uint8_t *value_len_io)
+{
+  uint32_t value;
+
+  if (lookup == NULL || attribute_type == NULL || value_out == NULL || value_len_io == NULL) {
+    return EMBER_ZCL_STATUS_INVALID_FIELD;
+  }
+  if (!lookup(attribute_id, &value)) {
+    return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+  }
+  if (*value_len_io < sizeof(uint32_t)) {
+    return EMBER_ZCL_STATUS_INSUFFICIENT_SPACE;
+  }
+
+  *attribute_type = ZCL_INT32U_ATTRIBUTE_TYPE;
+  value_out[0] = (uint8_t)(value & 0xFFu);
+  value_out[1] = (uint8_t)((value >> 8) & 0xFFu);
+  value_out[2] = (uint8_t)((value >> 16) & 0xFFu);
+  value_out[3] = (uint8_t)(value >> 24);
+  *value_len_io = 4;
+  return EMBER_ZCL_STATUS_SUCCESS;
+}
+
 EmberAfStatus app_config_write_mfg_attribute(EmberAfAttributeId attribute_id,
                                              uint8_t attribute_type,
                                              const uint8_t *value,
@@ -102,7 +258,52 @@ EmberAfStatus app_config_write_mfg_attribute(EmberAfAttributeId attribute_id,
     return EMBER_ZCL_STATUS_INVALID_FIELD;
   }
 
-  if (attribute_id != ZCL_SENSOR_READ_INTERVAL_ATTRIBUTE_ID) {
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  if (attribute_id == ZCL_SHT31_MEASUREMENT_MODE_ATTRIBUTE_ID) {
+    if (attribute_type != ZCL_ENUM8_ATTRIBUTE_TYPE || value_len != 1) {
+      return EMBER_ZCL_STATUS_INVALID_DATA_TYPE;
+    }
+    if (!sht31_mode_is_valid(value[0])) {
+      return EMBER_ZCL_STATUS_INVALID_VALUE;
+    }
+    if (!app_sensor_set_sht31_mode(value[0])) {
+      return EMBER_ZCL_STATUS_FAILURE;
+    }
+    config.sht31_measurement_mode = value[0];
+    (void)write_config_attribute(attribute_id, value, ZCL_ENUM8_ATTRIBUTE_TYPE);
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+#endif
+
+  if (attribute_id == ZCL_BATTERY_CHEMISTRY_ATTRIBUTE_ID) {
+    if (attribute_type != ZCL_ENUM8_ATTRIBUTE_TYPE || value_len != 1) {
+      return EMBER_ZCL_STATUS_INVALID_DATA_TYPE;
+    }
+    if (value[0] > APP_BATTERY_CHEMISTRY_LITHIUM) {
+      return EMBER_ZCL_STATUS_INVALID_VALUE;
+    }
+    config.battery_chemistry = value[0];
+    app_sensor_set_battery_chemistry(value[0]);
+    (void)write_config_attribute(attribute_id, value, ZCL_ENUM8_ATTRIBUTE_TYPE);
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+
+  if (attribute_id == ZCL_ADAPTIVE_AGGRESSIVENESS_ATTRIBUTE_ID) {
+    if (attribute_type != ZCL_INT8U_ATTRIBUTE_TYPE || value_len != 1) {
+      return EMBER_ZCL_STATUS_INVALID_DATA_TYPE;
+    }
+    if (value[0] > APP_ADAPTIVE_AGGRESSIVENESS_MAX) {
+      return EMBER_ZCL_STATUS_INVALID_VALUE;
+    }
+    config.adaptive_aggressiveness = value[0];
+    apply_adaptive_config();
+    (void)write_config_attribute(attribute_id, value, ZCL_INT8U_ATTRIBUTE_TYPE);
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+
+  if (attribute_id != ZCL_SENSOR_READ_INTERVAL_ATTRIBUTE_ID
+      && attribute_id != ZCL_ADAPTIVE_INTERVAL_MIN_ATTRIBUTE_ID
+      && attribute_id != ZCL_ADAPTIVE_INTERVAL_MAX_ATTRIBUTE_ID) {
     return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
   }
 
@@ -111,11 +312,29 @@ EmberAfStatus app_config_write_mfg_attribute(EmberAfAttributeId attribute_id,
   }
 
   uint16_t interval = (uint16_t)(value[0] | ((uint16_t)value[1] << 8));
-  if (interval < APP_SENSOR_INTERVAL_MIN_SECONDS
-      || interval > APP_SENSOR_INTERVAL_MAX_SECONDS) {
+  if (!interval_is_valid(interval)) {
     return EMBER_ZCL_STATUS_INVALID_VALUE;
   }
 
+  if (attribute_id == ZCL_ADAPTIVE_INTERVAL_MIN_ATTRIBUTE_ID) {
+    if (interval > config.adaptive_interval_max_seconds) {
+      return EMBER_ZCL_STATUS_INVALID_VALUE;
+    }
+    config.adaptive_interval_min_seconds = interval;
+    apply_adaptive_config();
+    (void)write_config_attribute(attribute_id, value, ZCL_INT16U_ATTRIBUTE_TYPE);
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+  if (attribute_id == ZCL_ADAPTIVE_INTERVAL_MAX_ATTRIBUTE_ID) {
+    if (interval < config.adaptive_interval_min_seconds) {
+      return EMBER_ZCL_STATUS_INVALID_VALUE;
+    }
+    config.adaptive_interval_max_seconds = interval;
+    apply_adaptive_config();
+    (void)write_config_attribute(attribute_id, value, ZCL_INT16U_ATTRIBUTE_TYPE);
+    return EMBER_ZCL_STATUS_SUCCESS;
+  }
+
   config.sensor_read_interval_seconds = interval;
   app_sensor_set_interval((uint32_t)interval * 1000u);
   (void)write_config_attribute(attribute_id, value, ZCL_INT16U_ATTRIBUTE_TYPE);
@@ -143,7 +362,7 @@ void emberAfBasicClusterServerAttributeChangedCallback(uint8_t endpoint,
       && interval >= APP_SENSOR_INTERVAL_MIN_SECONDS
       && interval <= APP_SENSOR_INTERVAL_MAX_SECONDS) {
     config.sensor_read_interval_seconds = interval;
-    emberAfCorePrintln("Sensor read interval changed to %d seconds", interval);
+    APP_LOG_INFO("Sensor read interval changed to %d seconds", interval);
     app_sensor_set_interval((uint32_t)interval * 1000u);
   }
 }
@@ -15,6 +15,31 @@
 
 // Manufacturer-specific Basic cluster attributes (0xF000 range)
 #define ZCL_SENSOR_READ_INTERVAL_ATTRIBUTE_ID 0xF000  // uint16, seconds
+#define ZCL_SHT31_MEASUREMENT_MODE_ATTRIBUTE_ID 0xF005  // enum8, SHT31 profile only
+#define ZCL_ADAPTIVE_INTERVAL_MIN_ATTRIBUTE_ID 0xF006  // uint16, seconds
+#define ZCL_ADAPTIVE_INTERVAL_MAX_ATTRIBUTE_ID 0xF007  // uint16, seconds
+#define ZCL_ADAPTIVE_AGGRESSIVENESS_ATTRIBUTE_ID 0xF008  // uint8, 0 = fixed interval
+#define ZCL_BATTERY_CHEMISTRY_ATTRIBUTE_ID 0xF009  // enum8, APP_BATTERY_CHEMISTRY_*
+// Report-only bundle of measured values, 0xF040..0xF044 (APP_REPORT_BUNDLE):
+// temperature, humidity, pressure, battery voltage, battery percentage
+#define ZCL_REPORT_BUNDLE_BASE_ATTRIBUTE_ID 0xF040
+
+// SHT31 measurement mode encoding (attribute 0xF005)
+#define APP_SHT31_MODE_REPEATABILITY_MASK 0x03u  // 0 = low, 1 = medium, 2 = high
+#define APP_SHT31_MODE_CLOCK_STRETCH      0x04u
+#define APP_SHT31_MODE_DEFAULT            0x02u  // High repeatability, no stretching
+
+// Adaptive interval bounds (attributes 0xF006..0xF008)
+#define APP_ADAPTIVE_INTERVAL_MIN_DEFAULT_SECONDS 10u
+#define APP_ADAPTIVE_INTERVAL_MAX_DEFAULT_SECONDS 300u
+#define APP_ADAPTIVE_AGGRESSIVENESS_MAX           8u
+#define APP_ADAPTIVE_AGGRESSIVENESS_DEFAULT       0u
+
+// Battery chemistry encoding (attribute 0xF009), matches battery_chemistry_t
+#define APP_BATTERY_CHEMISTRY_ALKALINE 0u
+#define APP_BATTERY_CHEMISTRY_NIMH     1u
+#define APP_BATTERY_CHEMISTRY_LITHIUM  2u
+#define APP_BATTERY_CHEMISTRY_DEFAULT  APP_BATTERY_CHEMISTRY_ALKALINE
 
 /**
  * @brief Configuration structure holding all customizable parameters
@@ -22,6 +47,15 @@
 typedef struct {
   // Sensor reading interval (10-3600 seconds)
   uint16_t sensor_read_interval_seconds;
+  // SHT31 repeatability / clock stretching (APP_SHT31_MODE_*)
+  uint8_t sht31_measurement_mode;
+  // Adaptive interval bounds (10-3600 seconds, min <= max)
+  uint16_t adaptive_interval_min_seconds;
+  uint16_t adaptive_interval_max_seconds;
+  // Adaptive interval growth step (0 = fixed interval, 1-8)
+  uint8_t adaptive_aggressiveness;
+  // Battery pack chemistry (APP_BATTERY_CHEMISTRY_*)
+  uint8_t battery_chemistry;
 } app_config_t;
 
 /**
@@ -52,6 +86,34 @@ EmberAfStatus app_config_read_mfg_attribute(EmberAfAttributeId attribute_id,
                                             uint8_t *value_out,
                                             uint8_t *value_len_io);
 
+/**
+ * @brief Look up a read-only uint32 manufacturer-specific attribute.
+ *
+ * @param attribute_id Basic cluster attribute id (0xF0xx)
+ * @param value Output value
+ * @return true if the attribute belongs to the caller's block
+ */
+typedef bool (*app_config_u32_lookup_t)(EmberAfAttributeId attribute_id, uint32_t *value);
+
+/**
+ * @brief Read a uint32 manufacturer-specific Basic attribute through a lookup.
+ *
+ * Shared by the read-only counter blocks (app_diag, app_energy): checks the
+ * arguments and buffer, and encodes the value as INT32U, little-endian.
+ *
+ * @param attribute_id Basic cluster attribute id (0xF0xx)
+ * @param lookup Module lookup for attribute_id
+ * @param attribute_type Output Zigbee type id
+ * @param value_out Output value bytes (little-endian)
+ * @param value_len_io Input: max buffer len, Output: actual len
+ * @return EMBER_ZCL_STATUS_SUCCESS on success or ZCL error status
+ */
+EmberAfStatus app_config_read_u32_attribute(EmberAfAttributeId attribute_id,
+                                            app_config_u32_lookup_t lookup,
+                                            uint8_t *attribute_type,
+                                            uint8_t *value_out,
+                                            uint8_t *value_len_io);
+
 /**
  * @brief Write manufacturer-specific Basic attribute into runtime config.
  *
@@ -0,0 +1,197 @@
+/**
+ * @file app_diag.c
+ * @brief Read-only diagnostics attributes
+ *
+ * Manufacturer-specific Basic attributes (uint32, read-only):
+ * - 0xF020..0xF023 I2C NACK / arbitration lost / bus error / timeout counts
+ * - 0xF024 / 0xF025 I2C bus recoveries / recoveries that left SDA low
+ * - 0xF026..0xF02C wakes by source: sensor timer, rejoin timer, poll,
+ *   button, radio RX, unknown, other app timer
+ * - 0xF02D / 0xF02E / 0xF02F EM0 ms / EM1 ms / EM2 s residency
+ */
+
+#include "app_diag.h"
+#include "app_config.h"
+#include "hal_i2c.h"
+#include "af.h"
+#include "app/framework/include/af.h"
+#include "sl_component_catalog.h"
+#include "sl_sleeptimer.h"
+#include "em_core.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+
+static app_diag_power_stats_t diag_power;
+static volatile uint8_t diag_wake_hint = APP_DIAG_WAKE_UNKNOWN;
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+// Residency in sleeptimer ticks per energy mode (EM3 folded into EM2)
+static uint64_t diag_em_ticks[3];
+static uint32_t diag_em_since = 0;
+static bool diag_woke = false;   // An EM2 wake is open (not yet counted)
+
+static sl_power_manager_em_transition_event_handle_t diag_em_handle;
+
+static void app_diag_em_transition(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint8_t from_index = (from > SL_POWER_MANAGER_EM2) ? 2u : (uint8_t)from;
+  bool to_sleep = (to >= SL_POWER_MANAGER_EM2);
+
+  diag_em_ticks[from_index] += (uint32_t)(now - diag_em_since);
+  diag_em_since = now;
+
+  // Runs with interrupts masked: the wake interrupt is serviced only after
+  // the leaving-EM2 transition, so its hint lands in the new wake.
+  if (to_sleep) {
+    if (diag_woke) {
+      diag_power.wakes[diag_wake_hint]++;
+      diag_woke = false;
+    }
+  } else if (from >= SL_POWER_MANAGER_EM2) {
+    diag_woke = true;
+    diag_wake_hint = APP_DIAG_WAKE_UNKNOWN;
+  }
+}
+
+static const sl_power_manager_em_transition_event_info_t diag_em_info = {
+  .event_mask = SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM0
+                | SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM1
+                | SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM2
+                | SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM3,
+  .on_event = app_diag_em_transition,
+};
+
+static uint32_t app_diag_ticks_to_ms(uint64_t ticks)
+{
+  uint64_t ms = 0;
+  if (sl_sleeptimer_tick64_to_ms(ticks, &ms) != SL_STATUS_OK || ms > UINT32_MAX) {
+    return UINT32_MAX;
+  }
+  return (uint32_t)ms;
+}
+#endif
+
+void app_diag_init(void)
+{
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  diag_em_since = sl_sleeptimer_get_tick_count();
+  sl_power_manager_subscribe_em_transition_event(&diag_em_handle, &diag_em_info);
+#endif
+}
+
+void app_diag_wake_hint(app_diag_wake_t source)
+{
+  if (source >= APP_DIAG_WAKE_COUNT) {
+    return;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if ((uint8_t)source < diag_wake_hint) {
+    diag_wake_hint = (uint8_t)source;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void app_diag_get_power_stats(app_diag_power_stats_t *stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *stats = diag_power;
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  // Called in EM0: the open interval since the last transition is EM0 time
+  uint64_t em0_ticks = diag_em_ticks[0]
+                       + (uint32_t)(sl_sleeptimer_get_tick_count() - diag_em_since);
+  uint64_t em1_ticks = diag_em_ticks[1];
+  uint64_t em2_ticks = diag_em_ticks[2];
+#endif
+  CORE_EXIT_ATOMIC();
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  stats->em0_ms = app_diag_ticks_to_ms(em0_ticks);
+  stats->em1_ms = app_diag_ticks_to_ms(em1_ticks);
+  stats->em2_s = (uint32_t)(em2_ticks / sl_sleeptimer_get_timer_frequency());
+#endif
+}
+
+static bool app_diag_read_u32(EmberAfAttributeId attribute_id, uint32_t *value)
+{
+  hal_i2c_error_stats_t i2c;
+  app_diag_power_stats_t power;
+
+  hal_i2c_get_error_stats(&i2c);
+  app_diag_get_power_stats(&power);
+  switch (attribute_id) {
+    case ZCL_DIAG_I2C_NACK_ATTRIBUTE_ID:
+      *value = i2c.nack;
+      return true;
+    case ZCL_DIAG_I2C_ARB_LOST_ATTRIBUTE_ID:
+      *value = i2c.arb_lost;
+      return true;
+    case ZCL_DIAG_I2C_BUS_ERROR_ATTRIBUTE_ID:
+      *value = i2c.bus_error;
+      return true;
+    case ZCL_DIAG_I2C_TIMEOUT_ATTRIBUTE_ID:
+      *value = i2c.timeout;
+      return true;
+    case ZCL_DIAG_I2C_RECOVERY_ATTRIBUTE_ID:
+      *value = i2c.recoveries;
+      return true;
+    case ZCL_DIAG_I2C_RECOVERY_FAILED_ATTRIBUTE_ID:
+      *value = i2c.recovery_failed;
+      return true;
+    case ZCL_DIAG_WAKE_SENSOR_TIMER_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_SENSOR_TIMER];
+      return true;
+    case ZCL_DIAG_WAKE_REJOIN_TIMER_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_REJOIN_TIMER];
+      return true;
+    case ZCL_DIAG_WAKE_POLL_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_POLL];
+      return true;
+    case ZCL_DIAG_WAKE_BUTTON_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_BUTTON];
+      return true;
+    case ZCL_DIAG_WAKE_RADIO_RX_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_RADIO_RX];
+      return true;
+    case ZCL_DIAG_WAKE_UNKNOWN_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_UNKNOWN];
+      return true;
+    case ZCL_DIAG_WAKE_APP_TIMER_ATTRIBUTE_ID:
+      *value = power.wakes[APP_DIAG_WAKE_APP_TIMER];
+      return true;
+    case ZCL_DIAG_EM0_MS_ATTRIBUTE_ID:
+      *value = power.em0_ms;
+      return true;
+    case ZCL_DIAG_EM1_MS_ATTRIBUTE_ID:
+      *value = power.em1_ms;
+      return true;
+    case ZCL_DIAG_EM2_S_ATTRIBUTE_ID:
+      *value = power.em2_s;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool app_diag_is_attribute(EmberAfAttributeId attribute_id)
+{
+  return attribute_id >= ZCL_DIAG_I2C_NACK_ATTRIBUTE_ID
+         && attribute_id <= ZCL_DIAG_EM2_S_ATTRIBUTE_ID;
+}
+
+EmberAfStatus app_diag_read_mfg_attribute(EmberAfAttributeId attribute_id,
+                                          uint8_t *attribute_type,
+                                          uint8_t *value_out,
+                                          uint8_t *value_len_io)
+{
+  return app_config_read_u32_attribute(attribute_id, app_diag_read_u32,
+                                       attribute_type, value_out, value_len_io);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file app_diag.h
+ * @brief Read-only diagnostics attributes
+ *
+ * Runtime counters exposed as manufacturer-specific Basic attributes
+ * (mfgCode APP_MANUFACTURER_CODE, 0xF020 range). They have no ZCL storage:
+ * values are taken from the driver counters when the attribute is read.
+ *
+ * Also the wake accounting behind them. Every wake from EM2 is counted once,
+ * under the most specific source hinted during it (app_diag_wake_t order),
+ * when the device goes back to sleep. Energy-mode residency is accumulated
+ * from sleeptimer ticks at each power manager transition.
+ */
+
+#ifndef APP_DIAG_H
+#define APP_DIAG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "af.h"
+
+// I2C failure counters since boot, uint32 (hal_i2c_get_error_stats)
+#define ZCL_DIAG_I2C_NACK_ATTRIBUTE_ID            0xF020
+#define ZCL_DIAG_I2C_ARB_LOST_ATTRIBUTE_ID        0xF021
+#define ZCL_DIAG_I2C_BUS_ERROR_ATTRIBUTE_ID       0xF022
+#define ZCL_DIAG_I2C_TIMEOUT_ATTRIBUTE_ID         0xF023
+#define ZCL_DIAG_I2C_RECOVERY_ATTRIBUTE_ID        0xF024
+#define ZCL_DIAG_I2C_RECOVERY_FAILED_ATTRIBUTE_ID 0xF025
+
+// Wakes from EM2 by source since boot, uint32
+#define ZCL_DIAG_WAKE_SENSOR_TIMER_ATTRIBUTE_ID   0xF026
+#define ZCL_DIAG_WAKE_REJOIN_TIMER_ATTRIBUTE_ID   0xF027
+#define ZCL_DIAG_WAKE_POLL_ATTRIBUTE_ID           0xF028
+#define ZCL_DIAG_WAKE_BUTTON_ATTRIBUTE_ID         0xF029
+#define ZCL_DIAG_WAKE_RADIO_RX_ATTRIBUTE_ID       0xF02A
+#define ZCL_DIAG_WAKE_UNKNOWN_ATTRIBUTE_ID        0xF02B
+#define ZCL_DIAG_WAKE_APP_TIMER_ATTRIBUTE_ID      0xF02C
+// Energy-mode residency since boot, uint32
+#define ZCL_DIAG_EM0_MS_ATTRIBUTE_ID              0xF02D
+#define ZCL_DIAG_EM1_MS_ATTRIBUTE_ID              0xF02E
+#define ZCL_DIAG_EM2_S_ATTRIBUTE_ID               0xF02F
+
+/**
+ * @brief Wake sources, most specific first
+ *
+ * When several sources are hinted during one wake the lowest value wins: a
+ * timer wake that also polls counts as a timer wake, a poll that delivers a
+ * command counts as radio RX.
+ */
+typedef enum {
+  APP_DIAG_WAKE_BUTTON = 0,     // BTN0 edge
+  APP_DIAG_WAKE_SENSOR_TIMER,   // Sensor timer task on a scheduler timer wake
+  APP_DIAG_WAKE_REJOIN_TIMER,   // Auto-join task on a scheduler timer wake
+  APP_DIAG_WAKE_APP_TIMER,      // Any other app_sched task (LED, windows)
+  APP_DIAG_WAKE_RADIO_RX,       // ZCL command received
+  APP_DIAG_WAKE_POLL,           // End-device data poll
+  APP_DIAG_WAKE_UNKNOWN,        // No hint (stack timers, other interrupts)
+  APP_DIAG_WAKE_COUNT
+} app_diag_wake_t;
+
+/**
+ * @brief Wake and residency counters since boot
+ */
+typedef struct {
+  uint32_t wakes[APP_DIAG_WAKE_COUNT];  // Indexed by app_diag_wake_t
+  uint32_t em0_ms;   // Includes the current awake period
+  uint32_t em1_ms;
+  uint32_t em2_s;    // EM2/EM3 sleep, seconds (ms would wrap in 49 days)
+} app_diag_power_stats_t;
+
+/**
+ * @brief Start wake and residency accounting (call once, early in main)
+ */
+void app_diag_init(void);
+
+/**
+ * @brief Name a source for the current wake (interrupt safe)
+ * @param source Wake source; a more specific one already hinted is kept
+ */
+void app_diag_wake_hint(app_diag_wake_t source);
+
+/**
+ * @brief Snapshot the wake and residency counters
+ * @param stats Output
+ */
+void app_diag_get_power_stats(app_diag_power_stats_t *stats);
+
+/**
+ * @brief Check whether an attribute id belongs to the diagnostics range
+ * @param attribute_id Basic cluster attribute id
+ * @return true for a diagnostics attribute (read-only)
+ */
+bool app_diag_is_attribute(EmberAfAttributeId attribute_id);
+
+/**
+ * @brief Read a diagnostics attribute
+ *
+ * @param attribute_id Basic cluster attribute id (0xF020..0xF02F)
+ * @param attribute_type Output Zigbee type id
+ * @param value_out Output value bytes (little-endian)
+ * @param value_len_io Input: max buffer len, Output: actual len
+ * @return EMBER_ZCL_STATUS_SUCCESS on success or ZCL error status
+ */
+EmberAfStatus app_diag_read_mfg_attribute(EmberAfAttributeId attribute_id,
+                                          uint8_t *attribute_type,
+                                          uint8_t *value_out,
+                                          uint8_t *value_len_io);
+
+#endif // APP_DIAG_H
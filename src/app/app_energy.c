@@ -0,0 +1,253 @@
+/**
+ * @file app_energy.c
+ * @brief Per-operation charge model (software coulomb counter)
+ *
+ * Manufacturer-specific Basic attributes (uint32, read-only):
+ * - 0xF030 charge used since boot, uAh
+ * - 0xF031 average current since boot, nA
+ * - 0xF032 projected battery life left, hours (0xFFFFFFFF unknown)
+ * - 0xF033 times the battery curve overrode the coulomb count
+ */
+
+#include "app_energy.h"
+#include "app_config.h"
+#include "app_diag.h"
+#include "battery.h"
+#include "hal_i2c.h"
+#include "hal_eeprom.h"
+#include "af.h"
+#include "app/framework/include/af.h"
+#include "sl_component_catalog.h"
+#include "sl_sleeptimer.h"
+
+// Model defaults for the TRADFRI module at 3.0 V (EFR32MG1P datasheet figures
+// plus SPI flash and sensor margins). Calibrate per board against a current
+// trace; every value is a compile-time override.
+
+// Currents while in each energy mode (CPU, clocks, retained RAM)
+#ifndef APP_ENERGY_EM0_UA
+#define APP_ENERGY_EM0_UA 3000u
+#endif
+#ifndef APP_ENERGY_EM1_UA
+#define APP_ENERGY_EM1_UA 1300u
+#endif
+// Sleep floor: EM2 with RTCC, sensor and flash in standby
+#ifndef APP_ENERGY_EM2_NA
+#define APP_ENERGY_EM2_NA 3000u
+#endif
+
+// Radio, on top of the CPU: fixed part per frame (headers, CCA, ACK, turn
+// around) and per payload byte (32 us at 250 kbit/s)
+#ifndef APP_ENERGY_TX_FRAME_NC
+#define APP_ENERGY_TX_FRAME_NC 25000u
+#endif
+#ifndef APP_ENERGY_TX_BYTE_NC
+#define APP_ENERGY_TX_BYTE_NC 270u
+#endif
+#ifndef APP_ENERGY_RX_FRAME_NC
+#define APP_ENERGY_RX_FRAME_NC 15000u
+#endif
+#ifndef APP_ENERGY_RX_BYTE_NC
+#define APP_ENERGY_RX_BYTE_NC 320u
+#endif
+// Data request, ACK and receive window of one MAC poll
+#ifndef APP_ENERGY_POLL_NC
+#define APP_ENERGY_POLL_NC 40000u
+#endif
+
+// Peripherals, on top of the CPU
+#ifndef APP_ENERGY_I2C_TRANSFER_NC
+#define APP_ENERGY_I2C_TRANSFER_NC 150u
+#endif
+#ifndef APP_ENERGY_ADC_CONVERSION_NC
+#define APP_ENERGY_ADC_CONVERSION_NC 50u
+#endif
+#ifndef APP_ENERGY_FLASH_READ_BYTE_NC
+#define APP_ENERGY_FLASH_READ_BYTE_NC 80u
+#endif
+#ifndef APP_ENERGY_FLASH_PROGRAM_NC
+#define APP_ENERGY_FLASH_PROGRAM_NC 45000u
+#endif
+#ifndef APP_ENERGY_FLASH_ERASE_NC
+#define APP_ENERGY_FLASH_ERASE_NC 750000u
+#endif
+
+// Uptime before the average is trusted for a battery life projection; the
+// join and first reports dominate the first minutes
+#ifndef APP_ENERGY_PROJECTION_MIN_S
+#define APP_ENERGY_PROJECTION_MIN_S 3600u
+#endif
+
+#define NC_PER_UAH 3600000ull
+
+#define ENERGY_PERCENT_UNKNOWN 0xFFu
+
+static uint32_t energy_tx_frames = 0;
+static uint32_t energy_tx_bytes = 0;
+static uint32_t energy_rx_frames = 0;
+static uint32_t energy_rx_bytes = 0;
+static uint32_t energy_polls = 0;
+static uint8_t energy_battery_percent = ENERGY_PERCENT_UNKNOWN;
+
+// Charge since boot by consumer, nC
+typedef struct {
+  uint64_t cpu;
+  uint64_t sleep;
+  uint64_t radio;
+  uint64_t poll;
+  uint64_t i2c;
+  uint64_t adc;
+  uint64_t flash;
+} energy_nc_t;
+
+static uint64_t app_energy_uptime_ms(void)
+{
+  uint64_t ms = 0;
+  (void)sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return ms;
+}
+
+static uint32_t app_energy_saturate(uint64_t value)
+{
+  return (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+}
+
+static uint64_t app_energy_compute(energy_nc_t *nc, uint64_t uptime_ms)
+{
+  app_diag_power_stats_t power;
+  hal_eeprom_op_counts_t flash;
+
+  app_diag_get_power_stats(&power);
+  hal_eeprom_get_op_counts(&flash);
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  nc->cpu = (uint64_t)power.em0_ms * APP_ENERGY_EM0_UA
+            + (uint64_t)power.em1_ms * APP_ENERGY_EM1_UA;
+  nc->sleep = (uint64_t)power.em2_s * APP_ENERGY_EM2_NA;
+  (void)uptime_ms;
+#else
+  // No sleep: all of it in EM0
+  nc->cpu = uptime_ms * APP_ENERGY_EM0_UA;
+  nc->sleep = 0;
+#endif
+  nc->radio = (uint64_t)energy_tx_frames * APP_ENERGY_TX_FRAME_NC
+              + (uint64_t)energy_tx_bytes * APP_ENERGY_TX_BYTE_NC
+              + (uint64_t)energy_rx_frames * APP_ENERGY_RX_FRAME_NC
+              + (uint64_t)energy_rx_bytes * APP_ENERGY_RX_BYTE_NC;
+  nc->poll = (uint64_t)energy_polls * APP_ENERGY_POLL_NC;
+  nc->i2c = (uint64_t)hal_i2c_get_transfer_count() * APP_ENERGY_I2C_TRANSFER_NC;
+  nc->adc = (uint64_t)battery_get_conversion_count() * APP_ENERGY_ADC_CONVERSION_NC;
+  nc->flash = (uint64_t)flash.read_bytes * APP_ENERGY_FLASH_READ_BYTE_NC
+              + (uint64_t)flash.page_programs * APP_ENERGY_FLASH_PROGRAM_NC
+              + (uint64_t)flash.sector_erases * APP_ENERGY_FLASH_ERASE_NC;
+
+  return nc->cpu + nc->sleep + nc->radio + nc->poll + nc->i2c + nc->adc + nc->flash;
+}
+
+void app_energy_note_tx(uint16_t payload_len)
+{
+  energy_tx_frames++;
+  energy_tx_bytes += payload_len;
+}
+
+void app_energy_note_rx(uint16_t payload_len)
+{
+  energy_rx_frames++;
+  energy_rx_bytes += payload_len;
+}
+
+void app_energy_note_poll(void)
+{
+  energy_polls++;
+}
+
+void app_energy_note_battery_percent(uint8_t percent)
+{
+  energy_battery_percent = (percent <= 200u) ? percent : ENERGY_PERCENT_UNKNOWN;
+}
+
+uint32_t app_energy_get_consumed_uah(void)
+{
+  energy_nc_t nc;
+  return app_energy_saturate(app_energy_compute(&nc, app_energy_uptime_ms()) / NC_PER_UAH);
+}
+
+void app_energy_get_stats(app_energy_stats_t *stats)
+{
+  energy_nc_t nc;
+
+  if (stats == NULL) {
+    return;
+  }
+
+  uint64_t uptime_ms = app_energy_uptime_ms();
+  uint64_t total = app_energy_compute(&nc, uptime_ms);
+
+  stats->cpu_uc = app_energy_saturate(nc.cpu / 1000u);
+  stats->sleep_uc = app_energy_saturate(nc.sleep / 1000u);
+  stats->radio_uc = app_energy_saturate(nc.radio / 1000u);
+  stats->poll_uc = app_energy_saturate(nc.poll / 1000u);
+  stats->i2c_uc = app_energy_saturate(nc.i2c / 1000u);
+  stats->adc_uc = app_energy_saturate(nc.adc / 1000u);
+  stats->flash_uc = app_energy_saturate(nc.flash / 1000u);
+  stats->total_uah = app_energy_saturate(total / NC_PER_UAH);
+  // nC per ms is uA
+  stats->avg_na = (uptime_ms > 0u) ? app_energy_saturate((total * 1000u) / uptime_ms) : 0u;
+}
+
+static uint32_t app_energy_projected_hours(void)
+{
+  app_energy_stats_t stats;
+
+  if (energy_battery_percent == ENERGY_PERCENT_UNKNOWN
+      || app_energy_uptime_ms() < (uint64_t)APP_ENERGY_PROJECTION_MIN_S * 1000u) {
+    return UINT32_MAX;
+  }
+  app_energy_get_stats(&stats);
+  if (stats.avg_na == 0u) {
+    return UINT32_MAX;
+  }
+
+  // uAh left at the reported state of charge, over the average so far
+  uint64_t remaining_uah = ((uint64_t)battery_get_capacity_mah() * 1000u
+                            * energy_battery_percent) / 200u;
+  return app_energy_saturate((remaining_uah * 1000u) / stats.avg_na);
+}
+
+static bool app_energy_read_u32(EmberAfAttributeId attribute_id, uint32_t *value)
+{
+  app_energy_stats_t stats;
+
+  switch (attribute_id) {
+    case ZCL_ENERGY_CONSUMED_UAH_ATTRIBUTE_ID:
+      *value = app_energy_get_consumed_uah();
+      return true;
+    case ZCL_ENERGY_AVG_CURRENT_NA_ATTRIBUTE_ID:
+      app_energy_get_stats(&stats);
+      *value = stats.avg_na;
+      return true;
+    case ZCL_ENERGY_PROJECTED_LIFE_H_ATTRIBUTE_ID:
+      *value = app_energy_projected_hours();
+      return true;
+    case ZCL_ENERGY_SOC_REANCHOR_ATTRIBUTE_ID:
+      *value = battery_get_coulomb_reanchor_count();
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool app_energy_is_attribute(EmberAfAttributeId attribute_id)
+{
+  return attribute_id >= ZCL_ENERGY_CONSUMED_UAH_ATTRIBUTE_ID
+         && attribute_id <= ZCL_ENERGY_SOC_REANCHOR_ATTRIBUTE_ID;
+}
+
+EmberAfStatus app_energy_read_mfg_attribute(EmberAfAttributeId attribute_id,
+                                            uint8_t *attribute_type,
+                                            uint8_t *value_out,
+                                            uint8_t *value_len_io)
+{
+  return app_config_read_u32_attribute(attribute_id, app_energy_read_u32,
+                                       attribute_type, value_out, value_len_io);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file app_energy.h
+ * @brief Per-operation charge model (software coulomb counter)
+ *
+ * Charge used since boot, estimated from what the device did: a calibrated
+ * cost per radio frame and byte, MAC data poll, I2C transfer, ADC
+ * conversion and SPI flash operation, plus the EM0/EM1/EM2 residency from
+ * app_diag at a fixed current each. Radio and poll activity is reported by
+ * the stack callbacks in app.c; the drivers keep their own operation counts
+ * and are read when the total is computed.
+ *
+ * Exposed as read-only manufacturer-specific Basic attributes (0xF030
+ * range). The total also feeds the battery state-of-charge cross-check.
+ */
+
+#ifndef APP_ENERGY_H
+#define APP_ENERGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "af.h"
+
+// Energy estimate, uint32, read-only
+#define ZCL_ENERGY_CONSUMED_UAH_ATTRIBUTE_ID      0xF030  // Charge used since boot, uAh
+#define ZCL_ENERGY_AVG_CURRENT_NA_ATTRIBUTE_ID    0xF031  // Average since boot, nA
+#define ZCL_ENERGY_PROJECTED_LIFE_H_ATTRIBUTE_ID  0xF032  // Hours left, 0xFFFFFFFF unknown
+#define ZCL_ENERGY_SOC_REANCHOR_ATTRIBUTE_ID      0xF033  // Count/curve disagreements
+
+/**
+ * @brief Charge since boot by consumer, uC (saturating)
+ */
+typedef struct {
+  uint32_t cpu_uc;      // EM0 and EM1 residency
+  uint32_t sleep_uc;    // EM2 floor
+  uint32_t radio_uc;    // Frames sent and received
+  uint32_t poll_uc;     // MAC data polls
+  uint32_t i2c_uc;      // I2C transfers
+  uint32_t adc_uc;      // Battery ADC conversions
+  uint32_t flash_uc;    // SPI flash reads, programs, erases
+  uint32_t total_uah;   // Sum of the above, uAh
+  uint32_t avg_na;      // Average current since boot, nA
+} app_energy_stats_t;
+
+/**
+ * @brief Charge one outgoing frame (main context)
+ * @param payload_len APS payload length in bytes
+ */
+void app_energy_note_tx(uint16_t payload_len);
+
+/**
+ * @brief Charge one received frame (main context)
+ * @param payload_len ZCL frame length in bytes
+ */
+void app_energy_note_rx(uint16_t payload_len);
+
+/**
+ * @brief Charge one completed MAC data poll (main context)
+ */
+void app_energy_note_poll(void);
+
+/**
+ * @brief Record the reported state of charge for the battery life projection
+ * @param percent BatteryPercentageRemaining, 0-200
+ */
+void app_energy_note_battery_percent(uint8_t percent);
+
+/**
+ * @brief Charge used since boot
+ * @return uAh
+ */
+uint32_t app_energy_get_consumed_uah(void);
+
+/**
+ * @brief Compute the per-consumer breakdown
+ * @param stats Output
+ */
+void app_energy_get_stats(app_energy_stats_t *stats);
+
+/**
+ * @brief Check whether an attribute id belongs to the energy range
+ * @param attribute_id Manufacturer-specific attribute id
+ * @return true for 0xF030..0xF033 (read-only)
+ */
+bool app_energy_is_attribute(EmberAfAttributeId attribute_id);
+
+/**
+ * @brief Read an energy attribute
+ * @param attribute_id Manufacturer-specific attribute id
+ * @param attribute_type Output ZCL type
+ * @param value_out Output buffer
+ * @param value_len_io Buffer size in, value size out
+ * @return SUCCESS, or UNSUPPORTED_ATTRIBUTE for ids outside the range
+ */
+EmberAfStatus app_energy_read_mfg_attribute(EmberAfAttributeId attribute_id,
+                                            uint8_t *attribute_type,
+                                            uint8_t *value_out,
+                                            uint8_t *value_len_io);
+
+#endif // APP_ENERGY_H
@@ -0,0 +1,88 @@
+/**
+ * @file app_event.c
+ * @brief Interrupt-to-main event queue
+ */
+
+#include "app_event.h"
+#include <stddef.h>
+#include "em_device.h"
+#include "sl_sleeptimer.h"
+
+// Ring capacity, a power of two no larger than 128 (free-running uint8_t
+// indices; head - tail is the fill level)
+#ifndef APP_EVENT_QUEUE_SIZE
+#define APP_EVENT_QUEUE_SIZE 8
+#endif
+
+#if (APP_EVENT_QUEUE_SIZE < 2) || (APP_EVENT_QUEUE_SIZE > 128) \
+  || ((APP_EVENT_QUEUE_SIZE & (APP_EVENT_QUEUE_SIZE - 1)) != 0)
+#error "APP_EVENT_QUEUE_SIZE must be a power of two in 2..128"
+#endif
+
+#define EVENT_MASK (APP_EVENT_QUEUE_SIZE - 1u)
+
+static app_event_t event_ring[APP_EVENT_QUEUE_SIZE];
+static volatile uint8_t event_head = 0;    // Written by the producer only
+static volatile uint8_t event_tail = 0;    // Written by the consumer only
+static volatile app_event_stats_t event_stats;  // Written by the producer only
+
+bool app_event_post(app_event_type_t type, uint32_t arg)
+{
+  uint8_t head = event_head;
+  uint8_t used = (uint8_t)(head - event_tail);
+
+  if (used >= APP_EVENT_QUEUE_SIZE) {
+    event_stats.overflows++;
+    return false;
+  }
+
+  app_event_t *slot = &event_ring[head & EVENT_MASK];
+  slot->type = (uint8_t)type;
+  slot->tick = sl_sleeptimer_get_tick_count();
+  slot->arg = arg;
+  // Payload must be visible before the consumer can see the new head
+  __DMB();
+  event_head = (uint8_t)(head + 1u);
+
+  event_stats.posted++;
+  if ((uint8_t)(used + 1u) > event_stats.high_water) {
+    event_stats.high_water = (uint8_t)(used + 1u);
+  }
+  return true;
+}
+
+bool app_event_get(app_event_t *event)
+{
+  uint8_t tail = event_tail;
+
+  if (event == NULL || tail == event_head) {
+    return false;
+  }
+  // Read the payload only after observing the head that published it
+  __DMB();
+  *event = event_ring[tail & EVENT_MASK];
+  // Slot is free for the producer only after the copy
+  __DMB();
+  event_tail = (uint8_t)(tail + 1u);
+  return true;
+}
+
+bool app_event_pending(void)
+{
+  return event_tail != event_head;
+}
+
+void app_event_flush(void)
+{
+  event_tail = event_head;
+}
+
+void app_event_get_stats(app_event_stats_t *stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  stats->posted = event_stats.posted;
+  stats->overflows = event_stats.overflows;
+  stats->high_water = event_stats.high_water;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file app_event.h
+ * @brief Interrupt-to-main event queue
+ *
+ * Single-producer/single-consumer ring of typed, timestamped events. The
+ * producer is one interrupt context (the BTN0 callback); the consumer is the
+ * main loop, which drains it in app_runtime_poll(). Neither side takes a
+ * critical section: each side writes only its own index, and the payload is
+ * published before the head index moves.
+ *
+ * A full ring drops the new event and counts it; nothing is overwritten, so
+ * the consumer always sees events in the order they happened.
+ */
+
+#ifndef APP_EVENT_H
+#define APP_EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  APP_EVENT_BUTTON_SHORT = 1,  // arg: hold time in ms
+  APP_EVENT_BUTTON_LONG  = 2,  // arg: hold time in ms
+} app_event_type_t;
+
+typedef struct {
+  uint8_t type;    // app_event_type_t
+  uint32_t tick;   // Sleeptimer tick at post time
+  uint32_t arg;    // Type-specific
+} app_event_t;
+
+/**
+ * @brief Queue counters since boot
+ */
+typedef struct {
+  uint32_t posted;      // Events accepted
+  uint32_t overflows;   // Events dropped on a full ring
+  uint8_t high_water;   // Most events queued at once
+} app_event_stats_t;
+
+/**
+ * @brief Post an event (producer side, interrupt safe)
+ * @param type Event type
+ * @param arg Type-specific argument
+ * @return false if the ring was full and the event was dropped
+ */
+bool app_event_post(app_event_type_t type, uint32_t arg);
+
+/**
+ * @brief Take the oldest event (consumer side, main context)
+ * @param event Output
+ * @return false if the ring is empty
+ */
+bool app_event_get(app_event_t *event);
+
+/**
+ * @brief Check for queued events without taking one (consumer side)
+ * @return true if at least one event is queued
+ */
+bool app_event_pending(void);
+
+/**
+ * @brief Drop every queued event (consumer side)
+ */
+void app_event_flush(void);
+
+/**
+ * @brief Snapshot the queue counters
+ * @param stats Output
+ */
+void app_event_get_stats(app_event_stats_t *stats);
+
+#endif // APP_EVENT_H
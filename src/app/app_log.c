@@ -0,0 +1,63 @@
+/**
+ * @file app_log.c
+ * @brief Tokenized log ring (APP_LOG_TOKENIZED builds)
+ */
+
+#include "app_log.h"
+
+#if APP_LOG_TOKENIZED
+
+#include <stdarg.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+
+#if (APP_LOG_RING_WORDS & (APP_LOG_RING_WORDS - 1u)) != 0
+#error "APP_LOG_RING_WORDS must be a power of two"
+#endif
+
+#define RING_MASK (APP_LOG_RING_WORDS - 1u)
+
+app_log_ring_t app_log_ring = {
+  .magic = APP_LOG_RING_MAGIC,
+  .size_words = APP_LOG_RING_WORDS,
+};
+
+static uint32_t record_words(uint32_t header)
+{
+  return 2u + (header >> 28);
+}
+
+void app_log_token(uint32_t header, ...)
+{
+  uint32_t len = record_words(header);
+  uint32_t timestamp = sl_sleeptimer_get_tick_count();
+  uint32_t head;
+  va_list args;
+
+  if (app_log_ring.tick_hz == 0u) {
+    app_log_ring.tick_hz = sl_sleeptimer_get_timer_frequency();
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  // Flight-recorder policy: drop the oldest complete records to make room
+  while ((app_log_ring.head - app_log_ring.tail) + len > APP_LOG_RING_WORDS) {
+    app_log_ring.tail += record_words(app_log_ring.words[app_log_ring.tail & RING_MASK]);
+    app_log_ring.dropped++;
+  }
+
+  head = app_log_ring.head;
+  app_log_ring.words[head++ & RING_MASK] = header;
+  app_log_ring.words[head++ & RING_MASK] = timestamp;
+  va_start(args, header);
+  for (uint32_t i = 2u; i < len; i++) {
+    app_log_ring.words[head++ & RING_MASK] = va_arg(args, uint32_t);
+  }
+  va_end(args);
+  app_log_ring.head = head;
+
+  CORE_EXIT_ATOMIC();
+}
+
+#endif // APP_LOG_TOKENIZED
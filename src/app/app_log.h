@@ -0,0 +1,160 @@
+/**
+ * @file app_log.h
+ * @brief Application logging with compile-time levels and tokenized records
+ *
+ * APP_LOG_ERROR/WARN/INFO/DEBUG take printf-style arguments. Calls above
+ * APP_LOG_LEVEL compile to nothing (arguments are still type-checked, format
+ * strings are not linked).
+ *
+ * Text mode (default) prints through emberAfCorePrintln. Tokenized mode
+ * (APP_LOG_TOKENIZED=1) keeps the format strings out of the image: each call
+ * stores a header word (module, source line, level, argument count), a
+ * sleeptimer timestamp and its arguments as raw 32-bit words in a RAM ring
+ * (app_log_ring). tools/decode_app_log.py rebuilds the text from a memory dump
+ * of the ring and the source tree, so the decoder must see the same sources
+ * the image was built from.
+ *
+ * Tokenized limitations: at most APP_LOG_MAX_ARGS arguments, each truncated
+ * to 32 bits; %s records the pointer only (the decoder can resolve pointers
+ * into flash when given the ELF).
+ *
+ * Each source file selects its module before including this header:
+ *   #define APP_LOG_MODULE APP_LOG_MODULE_SENSOR
+ *   #include "app_log.h"
+ */
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+#include <stdint.h>
+
+#define APP_LOG_LEVEL_NONE  0
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARN  2
+#define APP_LOG_LEVEL_INFO  3
+#define APP_LOG_LEVEL_DEBUG 4
+
+// Highest level compiled in; the debug build sets APP_LOG_LEVEL_DEBUG
+#ifndef APP_LOG_LEVEL
+#define APP_LOG_LEVEL APP_LOG_LEVEL_WARN
+#endif
+
+// 1 = record tokens into the RAM ring instead of printing
+#ifndef APP_LOG_TOKENIZED
+#define APP_LOG_TOKENIZED 0
+#endif
+
+// Ring size in 32-bit words (power of two)
+#ifndef APP_LOG_RING_WORDS
+#define APP_LOG_RING_WORDS 256u
+#endif
+
+// Module ids (header bits 25:16); decode_app_log.py reads this list
+#define APP_LOG_MODULE_NONE   0
+#define APP_LOG_MODULE_APP    1  // app.c
+#define APP_LOG_MODULE_SENSOR 2  // src/app/app_sensor.c
+#define APP_LOG_MODULE_CONFIG 3  // src/app/app_config.c
+
+#ifndef APP_LOG_MODULE
+#define APP_LOG_MODULE APP_LOG_MODULE_NONE
+#endif
+
+#define APP_LOG_MAX_ARGS 12
+
+#define APP_LOG_ERROR(...) APP_LOG_AT(APP_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define APP_LOG_WARN(...)  APP_LOG_AT(APP_LOG_LEVEL_WARN, __VA_ARGS__)
+#define APP_LOG_INFO(...)  APP_LOG_AT(APP_LOG_LEVEL_INFO, __VA_ARGS__)
+#define APP_LOG_DEBUG(...) APP_LOG_AT(APP_LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+// Same as APP_LOG_AT for callers whose formats carry their own newline
+#define APP_LOG_PRINTF(level, ...) \
+  APP_LOG_IF(level, APP_LOG_EMIT_PRINTF(level, __VA_ARGS__))
+
+#define APP_LOG_AT(level, ...) \
+  APP_LOG_IF(level, APP_LOG_EMIT(level, __VA_ARGS__))
+
+#define APP_LOG_IF(level, stmt)          \
+  do {                                   \
+    if ((level) <= APP_LOG_LEVEL) {      \
+      stmt;                              \
+    }                                    \
+  } while (0)
+
+#if APP_LOG_TOKENIZED
+
+#define APP_LOG_EMIT(level, ...) \
+  app_log_token(APP_LOG_HEADER(level, APP_LOG_NARGS(__VA_ARGS__) - 1) APP_LOG_ARGS(__VA_ARGS__))
+#define APP_LOG_EMIT_PRINTF(level, ...) APP_LOG_EMIT(level, __VA_ARGS__)
+
+#else // !APP_LOG_TOKENIZED
+
+#include <stdio.h>
+
+// Defined by af.h; the including file must pull that in before logging
+#define APP_LOG_EMIT(level, ...)        emberAfCorePrintln(__VA_ARGS__)
+#define APP_LOG_EMIT_PRINTF(level, ...) printf(__VA_ARGS__)
+
+#endif // APP_LOG_TOKENIZED
+
+// Header word: [31:28] argument count, [27:26] level - 1, [25:16] module,
+// [15:0] source line
+#define APP_LOG_HEADER(level, nargs)              \
+  (((uint32_t)(nargs) << 28)                      \
+   | ((uint32_t)((level) - 1) << 26)              \
+   | (((uint32_t)APP_LOG_MODULE & 0x3FFu) << 16)  \
+   | ((uint32_t)__LINE__ & 0xFFFFu))
+
+// Count of the format string plus arguments (1..APP_LOG_MAX_ARGS + 1)
+#define APP_LOG_NARGS(...) \
+  APP_LOG_NARGS_(__VA_ARGS__, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define APP_LOG_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, n, ...) n
+
+// ", (uint32_t)arg" for each argument after the format string
+#define APP_LOG_ARGS(...) APP_LOG_ARGS_CAT(APP_LOG_ARGS_, APP_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define APP_LOG_ARGS_CAT(a, b) APP_LOG_ARGS_CAT_(a, b)
+#define APP_LOG_ARGS_CAT_(a, b) a##b
+#define APP_LOG_U32(x) , (uint32_t)(uintptr_t)(x)
+#define APP_LOG_ARGS_1(f)
+#define APP_LOG_ARGS_2(f, a) APP_LOG_U32(a)
+#define APP_LOG_ARGS_3(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_2(f, __VA_ARGS__)
+#define APP_LOG_ARGS_4(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_3(f, __VA_ARGS__)
+#define APP_LOG_ARGS_5(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_4(f, __VA_ARGS__)
+#define APP_LOG_ARGS_6(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_5(f, __VA_ARGS__)
+#define APP_LOG_ARGS_7(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_6(f, __VA_ARGS__)
+#define APP_LOG_ARGS_8(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_7(f, __VA_ARGS__)
+#define APP_LOG_ARGS_9(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_8(f, __VA_ARGS__)
+#define APP_LOG_ARGS_10(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_9(f, __VA_ARGS__)
+#define APP_LOG_ARGS_11(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_10(f, __VA_ARGS__)
+#define APP_LOG_ARGS_12(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_11(f, __VA_ARGS__)
+#define APP_LOG_ARGS_13(f, a, ...) APP_LOG_U32(a) APP_LOG_ARGS_12(f, __VA_ARGS__)
+
+#define APP_LOG_RING_MAGIC 0x474F4C41u  // "ALOG"
+
+/**
+ * @brief Tokenized log ring (located by its magic in a RAM dump)
+ *
+ * head and tail are free-running word counts; tail always points at the
+ * header of the oldest complete record. Each record is a header word, a
+ * sleeptimer tick count and the argument words.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t size_words;
+  uint32_t tick_hz;            // Sleeptimer frequency, set on first record
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile uint32_t dropped;   // Records overwritten before being read
+  uint32_t words[APP_LOG_RING_WORDS];
+} app_log_ring_t;
+
+#if APP_LOG_TOKENIZED
+extern app_log_ring_t app_log_ring;
+
+/**
+ * @brief Append a record to the ring (use the APP_LOG_* macros)
+ * @param header APP_LOG_HEADER word; the argument count follows in bits 31:28
+ */
+void app_log_token(uint32_t header, ...);
+#endif
+
+#endif // APP_LOG_H
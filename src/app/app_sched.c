@@ -0,0 +1,242 @@
+/**
+ * @file app_sched.c
+ * @brief Timer service for main-context application tasks
+ */
+
+#include "app_sched.h"
+#include <stddef.h>
+#include "sl_sleeptimer.h"
+
+static app_sched_task_t *task_list = NULL;
+static sl_sleeptimer_timer_handle_t sched_timer;
+static volatile bool sched_timer_fired = false;
+static bool sched_running = false;
+static bool sched_have_deadline = false;
+static uint32_t sched_next_deadline = 0;   // Earliest deadline, lazy tasks included
+static bool sched_last_timer_wake = false;
+static app_sched_stats_t sched_stats;
+
+static bool app_sched_tick_reached(uint32_t now, uint32_t deadline)
+{
+  return (int32_t)(now - deadline) >= 0;
+}
+
+static uint32_t app_sched_ms_to_ticks(uint32_t ms)
+{
+  uint32_t ticks = 0;
+  if (sl_sleeptimer_ms32_to_tick(ms, &ticks) != SL_STATUS_OK) {
+    ticks = 0x7FFFFFFFu;   // Beyond the tick range: as late as comparisons allow
+  }
+  return ticks;
+}
+
+static void app_sched_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sched_timer_fired = true;
+}
+
+/**
+ * Recompute the earliest deadline and keep the sleeptimer at the earliest
+ * latest-start of the waking tasks; the wake there also runs every other
+ * task already due. With no waking task armed the timer is stopped so the
+ * power manager has nothing of ours to wake for.
+ */
+static void app_sched_rearm(void)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  bool have_any = false;
+  bool have_wake = false;
+  uint32_t next_any = 0;
+  uint32_t next_wake = 0;
+
+  for (app_sched_task_t *task = task_list; task != NULL; task = task->next) {
+    if (!have_any || (int32_t)(task->deadline - next_any) < 0) {
+      next_any = task->deadline;
+      have_any = true;
+    }
+    if (task->slack_ms != APP_SCHED_LAZY
+        && (!have_wake || (int32_t)(task->latest - next_wake) < 0)) {
+      next_wake = task->latest;
+      have_wake = true;
+    }
+  }
+
+  sched_have_deadline = have_any;
+  sched_next_deadline = next_any;
+
+  if (!have_wake) {
+    (void)sl_sleeptimer_stop_timer(&sched_timer);
+    return;
+  }
+
+  // A deadline already reached is picked up by the current main loop pass;
+  // arm one tick anyway so a pass that already ran still gets a wake.
+  uint32_t ticks = app_sched_tick_reached(now, next_wake) ? 1u : (next_wake - now);
+  (void)sl_sleeptimer_restart_timer(&sched_timer,
+                                    ticks,
+                                    app_sched_timer_callback,
+                                    NULL,
+                                    0,
+                                    0);
+}
+
+static void app_sched_unlink(app_sched_task_t *task)
+{
+  app_sched_task_t **link = &task_list;
+
+  while (*link != NULL) {
+    if (*link == task) {
+      *link = task->next;
+      break;
+    }
+    link = &(*link)->next;
+  }
+  task->next = NULL;
+  task->armed = false;
+}
+
+static void app_sched_arm(app_sched_task_t *task, uint32_t deadline)
+{
+  if (task->armed) {
+    app_sched_unlink(task);
+  }
+
+  task->deadline = deadline;
+  task->latest = deadline;
+  if (task->slack_ms != APP_SCHED_LAZY) {
+    task->latest += app_sched_ms_to_ticks(task->slack_ms);
+  }
+  task->next = task_list;
+  task_list = task;
+  task->armed = true;
+  if (!sched_running) {
+    app_sched_rearm();
+  }
+}
+
+void app_sched_start_ms(app_sched_task_t *task, uint32_t delay_ms)
+{
+  if (task == NULL) {
+    return;
+  }
+
+  uint32_t ticks = app_sched_ms_to_ticks(delay_ms);
+  if (ticks == 0u && sched_running) {
+    ticks = 1u;   // Re-armed from a handler: next pass, not this one
+  }
+  app_sched_arm(task, sl_sleeptimer_get_tick_count() + ticks);
+}
+
+void app_sched_advance_ms(app_sched_task_t *task, uint32_t period_ms)
+{
+  if (task == NULL) {
+    return;
+  }
+
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint32_t ticks = app_sched_ms_to_ticks(period_ms);
+  if (ticks == 0u) {
+    ticks = 1u;
+  }
+  uint32_t deadline = task->deadline + ticks;
+  if (app_sched_tick_reached(now, deadline)) {
+    deadline = now + ticks;
+  }
+  app_sched_arm(task, deadline);
+}
+
+void app_sched_cancel(app_sched_task_t *task)
+{
+  if (task == NULL || !task->armed) {
+    return;
+  }
+  app_sched_unlink(task);
+  if (!sched_running) {
+    app_sched_rearm();
+  }
+}
+
+bool app_sched_is_armed(const app_sched_task_t *task)
+{
+  return task != NULL && task->armed;
+}
+
+uint32_t app_sched_remaining_ms(const app_sched_task_t *task)
+{
+  if (task == NULL || !task->armed) {
+    return 0;
+  }
+
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint32_t deadline = task->deadline;
+  if (app_sched_tick_reached(now, deadline)) {
+    return 0;
+  }
+  return (uint32_t)sl_sleeptimer_tick_to_ms(deadline - now);
+}
+
+void app_sched_process(void)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  bool timer_wake = false;
+  uint32_t waking_run = 0;
+
+  sched_stats.wakes++;
+  if (sched_timer_fired) {
+    sched_timer_fired = false;
+    sched_stats.timer_wakes++;
+    timer_wake = true;
+  }
+  sched_last_timer_wake = timer_wake;
+  if (!sched_have_deadline || !app_sched_tick_reached(now, sched_next_deadline)) {
+    sched_stats.idle_wakes++;
+    return;
+  }
+
+  // Handlers may arm or cancel tasks, so rescan from the head after each one.
+  // Tasks re-armed from a handler always land after `now` and wait for the
+  // next pass.
+  bool ran;
+  sched_running = true;
+  do {
+    ran = false;
+    for (app_sched_task_t *task = task_list; task != NULL; task = task->next) {
+      if (app_sched_tick_reached(now, task->deadline)) {
+        app_sched_unlink(task);
+        if (task->slack_ms != APP_SCHED_LAZY) {
+          waking_run++;
+        }
+        if (task->handler != NULL) {
+          sched_stats.tasks_run++;
+          task->handler(task);
+        }
+        ran = true;
+        break;
+      }
+    }
+  } while (ran);
+  sched_running = false;
+
+  // Each waking task would have needed a wake of its own; the scheduler
+  // timer paid for one of them at most.
+  if (waking_run > 0u) {
+    sched_stats.wakes_saved += timer_wake ? (waking_run - 1u) : waking_run;
+  }
+
+  app_sched_rearm();
+}
+
+bool app_sched_timer_woke(void)
+{
+  return sched_last_timer_wake;
+}
+
+void app_sched_get_stats(app_sched_stats_t *stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  *stats = sched_stats;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file app_sched.h
+ * @brief Timer service for main-context application tasks
+ *
+ * Tasks are statically allocated descriptors armed with a delay. Every
+ * application timer runs on one sleeptimer, kept at the earliest point some
+ * task can no longer wait for: its deadline plus its slack. That wake runs
+ * every task already due, so deadlines within each other's slack share one
+ * wake and the power manager sleeps exactly until the next one.
+ *
+ * Lazy tasks (slack APP_SCHED_LAZY) never arm the sleeptimer and run on the
+ * first wake at or after their deadline (watchdogs, retries that do not
+ * justify a wake of their own). Tasks without a handler are plain deadlines
+ * (guard windows) read with app_sched_remaining_ms().
+ *
+ * app_sched_process() runs due handlers from the main loop and costs one
+ * comparison on a wake with nothing due. Arming and cancelling are main
+ * context only; handlers may re-arm or cancel any task, including their own.
+ */
+
+#ifndef APP_SCHED_H
+#define APP_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Slack of a task that never wakes the MCU on its own
+#define APP_SCHED_LAZY UINT32_MAX
+
+typedef struct app_sched_task app_sched_task_t;
+
+/**
+ * @brief Task handler, main context; the task is disarmed when it runs
+ */
+typedef void (*app_sched_handler_t)(app_sched_task_t *task);
+
+struct app_sched_task {
+  app_sched_handler_t handler;  // NULL: deadline only, nothing runs
+  uint32_t slack_ms;            // How late it may run to share a wake
+
+  // Scheduler-owned state
+  bool armed;
+  uint32_t deadline;            // Sleeptimer ticks
+  uint32_t latest;              // deadline + slack, ticks
+  app_sched_task_t *next;
+};
+
+#define APP_SCHED_TASK_INIT(handler_fn, slack) \
+  { .handler = (handler_fn), .slack_ms = (slack) }
+
+/**
+ * @brief Scheduler counters since boot
+ */
+typedef struct {
+  uint32_t wakes;        // app_sched_process() calls
+  uint32_t idle_wakes;   // ... that found nothing due
+  uint32_t timer_wakes;  // Scheduler sleeptimer expiries
+  uint32_t tasks_run;    // Handler invocations
+  uint32_t wakes_saved;  // Waking tasks run on a wake they did not need
+} app_sched_stats_t;
+
+/**
+ * @brief Arm (or re-arm) a task to run after delay_ms
+ * @param task Task descriptor
+ * @param delay_ms Delay from now; 0 runs it on the next app_sched_process()
+ */
+void app_sched_start_ms(app_sched_task_t *task, uint32_t delay_ms);
+
+/**
+ * @brief Re-arm a task period_ms after its previous deadline
+ *
+ * Drift-free periodic re-arm for use from the task's own handler: a task run
+ * late (slack) keeps its phase. A deadline already in the past restarts the
+ * period from now instead of running back to back.
+ *
+ * @param task Task descriptor
+ * @param period_ms Period
+ */
+void app_sched_advance_ms(app_sched_task_t *task, uint32_t period_ms);
+
+/**
+ * @brief Disarm a task (no-op if not armed)
+ * @param task Task descriptor
+ */
+void app_sched_cancel(app_sched_task_t *task);
+
+/**
+ * @brief Check whether a task is armed
+ * @param task Task descriptor
+ * @return true while the task waits for its deadline
+ */
+bool app_sched_is_armed(const app_sched_task_t *task);
+
+/**
+ * @brief Time left until a task's deadline (interrupt safe, read only)
+ * @param task Task descriptor
+ * @return Milliseconds to the deadline; 0 if not armed or already due
+ */
+uint32_t app_sched_remaining_ms(const app_sched_task_t *task);
+
+/**
+ * @brief Run the handlers of all due tasks (main loop, once per wake)
+ */
+void app_sched_process(void);
+
+/**
+ * @brief Whether the latest app_sched_process() pass followed an expiry of
+ *        the scheduler sleeptimer (wake attribution)
+ * @return true if the scheduler timer fired since the previous pass
+ */
+bool app_sched_timer_woke(void);
+
+/**
+ * @brief Snapshot the scheduler counters
+ * @param stats Output
+ */
+void app_sched_get_stats(app_sched_stats_t *stats);
+
+#endif // APP_SCHED_H
@@ -6,16 +6,24 @@
 #include "app_sensor.h"
 #include "app_config.h"
 #include "app_profile.h"
+#define APP_LOG_MODULE APP_LOG_MODULE_SENSOR
+#include "app_log.h"
 #if (APP_SENSOR_PROFILE != APP_SENSOR_PROFILE_SHT31)
 #include "bme280_min.h"
 #endif
 #include "sht31.h"
 #include "battery.h"
+#include "hal_i2c.h"
 #include "af.h"
 #include "app/framework/include/af.h"
+#include "em_cmu.h"
 #include "sl_sleeptimer.h"
+#include "app_sched.h"
+#include "app_diag.h"
+#include "app_energy.h"
 #include "sl_status.h"
 #include <stdio.h>
+#include <string.h>
 
 // Endpoint where sensor clusters are located
 #define SENSOR_ENDPOINT  1
@@ -42,16 +50,486 @@ static void app_notify_reporting(uint8_t endpoint,
                                           data);
 }
 
+// Deadbands of the attribute shadow cache, in attribute units. A value
+// within the deadband of the last written one skips the ZCL write and the
+// reporting-table scan; 0 skips unchanged values only. Keep these below the
+// reportable change a coordinator is expected to configure.
+#ifndef APP_DEADBAND_TEMPERATURE
+#define APP_DEADBAND_TEMPERATURE      5u   // 0.01 C
+#endif
+#ifndef APP_DEADBAND_HUMIDITY
+#define APP_DEADBAND_HUMIDITY         10u  // 0.01 %RH
+#endif
+#ifndef APP_DEADBAND_PRESSURE
+#define APP_DEADBAND_PRESSURE         0u   // kPa
+#endif
+#ifndef APP_DEADBAND_BATTERY_VOLTAGE
+#define APP_DEADBAND_BATTERY_VOLTAGE  0u   // 100 mV
+#endif
+#ifndef APP_DEADBAND_BATTERY_PERCENT
+#define APP_DEADBAND_BATTERY_PERCENT  1u   // 0.5 %
+#endif
+
+typedef enum {
+  APP_ATTR_TEMPERATURE = 0,
+  APP_ATTR_HUMIDITY,
+  APP_ATTR_PRESSURE,
+  APP_ATTR_BATTERY_VOLTAGE,
+  APP_ATTR_BATTERY_PERCENT,
+  APP_ATTR_COUNT
+} app_attr_index_t;
+
+typedef struct {
+  EmberAfClusterId cluster_id;
+  EmberAfAttributeId attribute_id;
+  EmberAfAttributeType type;
+  uint16_t deadband;
+  const char *name;
+} app_attr_desc_t;
+
+static const app_attr_desc_t attr_desc[APP_ATTR_COUNT] = {
+  [APP_ATTR_TEMPERATURE] = {
+    ZCL_TEMP_MEASUREMENT_CLUSTER_ID, ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID,
+    ZCL_INT16S_ATTRIBUTE_TYPE, APP_DEADBAND_TEMPERATURE, "temperature"
+  },
+  [APP_ATTR_HUMIDITY] = {
+    ZCL_HUMIDITY_MEASUREMENT_CLUSTER_ID, ZCL_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID,
+    ZCL_INT16U_ATTRIBUTE_TYPE, APP_DEADBAND_HUMIDITY, "humidity"
+  },
+  [APP_ATTR_PRESSURE] = {
+    ZCL_PRESSURE_MEASUREMENT_CLUSTER_ID, ZCL_PRESSURE_MEASURED_VALUE_ATTRIBUTE_ID,
+    ZCL_INT16S_ATTRIBUTE_TYPE, APP_DEADBAND_PRESSURE, "pressure"
+  },
+  [APP_ATTR_BATTERY_VOLTAGE] = {
+    ZCL_POWER_CONFIG_CLUSTER_ID, ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID,
+    ZCL_INT8U_ATTRIBUTE_TYPE, APP_DEADBAND_BATTERY_VOLTAGE, "battery voltage"
+  },
+  [APP_ATTR_BATTERY_PERCENT] = {
+    ZCL_POWER_CONFIG_CLUSTER_ID, ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
+    ZCL_INT8U_ATTRIBUTE_TYPE, APP_DEADBAND_BATTERY_PERCENT, "battery percentage"
+  },
+};
+
+// Last value written to each attribute
+typedef struct {
+  int32_t value;
+  bool valid;
+} app_attr_shadow_t;
+
+static app_attr_shadow_t attr_shadow[APP_ATTR_COUNT];
+static app_sensor_publish_stats_t publish_stats;
+
+// Report stage: each attribute write notifies the reporting plugin, which
+// already sends one Report Attributes frame per cluster for the changes it
+// finds on its next tick; app_flush_reports() adds nothing in standard mode.
+// With APP_REPORT_BUNDLE the measured values go out instead as a single
+// manufacturer-specific Report Attributes frame on Basic (0xF040 +
+// app_attr_index_t) to the coordinator, and the standard reports of the
+// bundled clusters are dropped before they are sent (app.c,
+// emberAfPreMessageSendCallback). The attributes are still written, so reads
+// keep working; the bundle is repeated at least every
+// APP_REPORT_BUNDLE_MAX_INTERVAL_S in place of max-interval reports.
+#ifndef APP_REPORT_BUNDLE
+#define APP_REPORT_BUNDLE 0
+#endif
+#ifndef APP_REPORT_BUNDLE_DEST_ENDPOINT
+#define APP_REPORT_BUNDLE_DEST_ENDPOINT 1
+#endif
+#ifndef APP_REPORT_BUNDLE_MAX_INTERVAL_S
+#define APP_REPORT_BUNDLE_MAX_INTERVAL_S 3600u
+#endif
+
+// Milliseconds since a sleeptimer tick. The tick counter wraps after 2^32
+// ticks (about 36 h at 32768 Hz), so timestamps here are kept as ticks and
+// only their difference is converted; that stays correct across the wrap.
+static uint32_t app_ms_since(uint32_t since_tick)
+{
+  return (uint32_t)sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - since_tick);
+}
+
+#if APP_REPORT_BUNDLE
+// Bit per app_attr_index_t written since the last bundle
+static uint8_t report_pending_mask = 0;
+static bool report_bundle_sent = false;
+static uint32_t report_bundle_last_tick = 0;
+#endif
+
+// Attribute storage is native byte order, sized by the attribute type
+static uint8_t app_encode_attribute(const app_attr_desc_t *desc, int32_t value, uint8_t *data)
+{
+  if (desc->type == ZCL_INT8U_ATTRIBUTE_TYPE) {
+    data[0] = (uint8_t)value;
+    return 1;
+  }
+  uint16_t value16 = (uint16_t)value;
+  memcpy(data, &value16, sizeof(value16));
+  return 2;
+}
+
+// Forget the shadow so the next sample writes and reports every attribute
+static void app_invalidate_attribute_shadow(void)
+{
+  for (uint8_t i = 0; i < APP_ATTR_COUNT; i++) {
+    attr_shadow[i].valid = false;
+  }
+}
+
+// Write one measured attribute and notify reporting, unless the value is
+// within the deadband of the last written one.
+static void app_publish_attribute(app_attr_index_t index, int32_t value)
+{
+  const app_attr_desc_t *desc = &attr_desc[index];
+  app_attr_shadow_t *shadow = &attr_shadow[index];
+
+  if (shadow->valid) {
+    uint32_t delta = (value > shadow->value) ? (uint32_t)(value - shadow->value)
+                                             : (uint32_t)(shadow->value - value);
+    if (delta <= desc->deadband) {
+      publish_stats.skipped++;
+      return;
+    }
+  }
+
+  uint8_t data[2];
+  (void)app_encode_attribute(desc, value, data);
+
+  EmberAfStatus status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
+                                                     desc->cluster_id,
+                                                     desc->attribute_id,
+                                                     data,
+                                                     desc->type);
+  if (status != EMBER_ZCL_STATUS_SUCCESS) {
+    APP_LOG_ERROR("Error: Failed to update %s attribute (0x%x)", desc->name, status);
+    return;
+  }
+  app_notify_reporting(SENSOR_ENDPOINT, desc->cluster_id, desc->attribute_id, desc->type, data);
+  shadow->value = value;
+  shadow->valid = true;
+#if APP_REPORT_BUNDLE
+  report_pending_mask |= (uint8_t)(1u << index);
+#endif
+  publish_stats.written++;
+}
+
+#if APP_REPORT_BUNDLE
+// One Report Attributes frame carrying every measured value
+static bool app_send_report_bundle(void)
+{
+  const uint8_t frame_control = (uint8_t)(ZCL_GLOBAL_COMMAND
+                                          | ZCL_MANUFACTURER_SPECIFIC_MASK
+                                          | ZCL_FRAME_CONTROL_SERVER_TO_CLIENT
+                                          | ZCL_DISABLE_DEFAULT_RESPONSE_MASK);
+
+  (void)emberAfFillExternalManufacturerSpecificBuffer(frame_control,
+                                                       ZCL_BASIC_CLUSTER_ID,
+                                                       APP_MANUFACTURER_CODE,
+                                                       ZCL_REPORT_ATTRIBUTES_COMMAND_ID,
+                                                       "");
+  for (uint8_t i = 0; i < APP_ATTR_COUNT; i++) {
+    if (!attr_shadow[i].valid) {
+      continue;
+    }
+    uint8_t data[2];
+    uint8_t len = app_encode_attribute(&attr_desc[i], attr_shadow[i].value, data);
+    (void)emberAfPutInt16uInResp((uint16_t)(ZCL_REPORT_BUNDLE_BASE_ATTRIBUTE_ID + i));
+    (void)emberAfPutInt8uInResp(attr_desc[i].type);
+    (void)emberAfAppendToExternalBuffer(data, len);
+  }
+
+  emberAfSetCommandEndpoints(SENSOR_ENDPOINT, APP_REPORT_BUNDLE_DEST_ENDPOINT);
+  EmberStatus status = emberAfSendCommandUnicast(EMBER_OUTGOING_DIRECT, 0x0000);
+  if (status != EMBER_SUCCESS) {
+    APP_LOG_ERROR("Error: report bundle send failed (0x%x)", status);
+    return false;
+  }
+  return true;
+}
+#endif
+
+// Send the bundle when this sample changed a value or the last one is older
+// than APP_REPORT_BUNDLE_MAX_INTERVAL_S. A bundle that cannot be queued is
+// retried on the next sample.
+static void app_flush_reports(void)
+{
+#if APP_REPORT_BUNDLE
+  bool heartbeat_due = report_bundle_sent
+                       && app_ms_since(report_bundle_last_tick)
+                          >= APP_REPORT_BUNDLE_MAX_INTERVAL_S * 1000u;
+
+  if (report_pending_mask == 0u && !heartbeat_due) {
+    return;
+  }
+  if (app_send_report_bundle()) {
+    report_pending_mask = 0;
+    report_bundle_sent = true;
+    report_bundle_last_tick = sl_sleeptimer_get_tick_count();
+  }
+#endif
+}
+
+// Report Attributes frame (ZCL global command 0x0A), mfg-specific or not
+static bool app_zcl_is_report(const uint8_t *message, uint16_t msg_len, bool *mfg_specific)
+{
+  if (message == NULL || msg_len < 3u) {
+    return false;
+  }
+  uint8_t frame_control = message[0];
+  *mfg_specific = (frame_control & ZCL_MANUFACTURER_SPECIFIC_MASK) != 0u;
+  uint16_t command_index = *mfg_specific ? 4u : 2u;
+
+  return (frame_control & ZCL_CLUSTER_SPECIFIC_COMMAND) == 0u
+         && msg_len > command_index
+         && message[command_index] == ZCL_REPORT_ATTRIBUTES_COMMAND_ID;
+}
+
+#if APP_REPORT_BUNDLE
+static bool app_is_bundled_cluster(uint16_t cluster_id)
+{
+  for (uint8_t i = 0; i < APP_ATTR_COUNT; i++) {
+    if (attr_desc[i].cluster_id == cluster_id) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+bool app_sensor_suppress_report(uint8_t source_endpoint,
+                                uint16_t cluster_id,
+                                const uint8_t *message,
+                                uint16_t msg_len)
+{
+#if APP_REPORT_BUNDLE
+  bool mfg_specific = false;
+
+  if (source_endpoint == SENSOR_ENDPOINT
+      && app_is_bundled_cluster(cluster_id)
+      && app_zcl_is_report(message, msg_len, &mfg_specific)
+      && !mfg_specific) {
+    publish_stats.reports_suppressed++;
+    return true;
+  }
+#else
+  (void)source_endpoint;
+  (void)cluster_id;
+  (void)message;
+  (void)msg_len;
+#endif
+  return false;
+}
+
+void app_sensor_note_message_sent(uint8_t source_endpoint,
+                                  const uint8_t *message,
+                                  uint16_t msg_len)
+{
+  bool mfg_specific = false;
+
+  if (source_endpoint == SENSOR_ENDPOINT
+      && app_zcl_is_report(message, msg_len, &mfg_specific)) {
+    publish_stats.report_frames++;
+  }
+}
+
 static bool sensor_ready = false;
 static bool battery_ready = false;
 static bool sensor_timer_running = false;
-static volatile bool sensor_update_pending = false;
+static bool sensor_update_pending = false;
 static bool sensor_network_down_logged = false;
-static uint32_t sensor_last_update_ms = 0;
-static sl_sleeptimer_timer_handle_t sensor_update_timer;
+static bool sensor_updated = false;
+static uint32_t sensor_last_update_tick = 0;
+
+// Sensor timer slack: a sample may run this much late to share a wake with
+// another app_sched deadline. The period keeps its phase either way.
+#ifndef APP_SENSOR_TIMER_SLACK_MS
+#define APP_SENSOR_TIMER_SLACK_MS 1000
+#endif
+
+static void sensor_update_timer_handler(app_sched_task_t *task);
+static app_sched_task_t sensor_update_task =
+  APP_SCHED_TASK_INIT(sensor_update_timer_handler, APP_SENSOR_TIMER_SLACK_MS);
+// A conversion is running while the MCU sleeps; app_sensor_process()
+// finishes the sample once the driver's conversion timer has expired
+static bool sensor_measurement_pending = false;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+static bool sensor_reconfigure_pending = false;
+#endif
+
+// Wake coalescing with the end-device data poll. A poll that completes
+// within APP_WAKE_COALESCE_SLACK_MS before the sensor timer takes the sample
+// on its own wake; a sensor timer that expires within the slack before the
+// predicted next poll waits for that poll. Either way the periodic timer is
+// restarted from the poll, so later samples stay in phase with it.
+// 0 disables coalescing (polls are still counted).
+#ifndef APP_WAKE_COALESCE_SLACK_MS
+#define APP_WAKE_COALESCE_SLACK_MS 2000
+#endif
+
+static app_sensor_wake_stats_t wake_stats;
+static bool poll_seen = false;
+static uint32_t poll_last_tick = 0;
+static uint32_t poll_interval_ms = 0;
+#if (APP_WAKE_COALESCE_SLACK_MS > 0)
+static bool sensor_update_on_poll = false;
+static bool sensor_waiting_for_poll = false;
+static void sensor_poll_fallback_handler(app_sched_task_t *task);
+static app_sched_task_t sensor_poll_fallback_task =
+  APP_SCHED_TASK_INIT(sensor_poll_fallback_handler, 0);
+#endif
+
+// One acquisition result, independent of the sensor profile
+typedef struct {
+  bool valid;
+  bool has_humidity;
+  bool has_pressure;
+  int32_t temperature;  // 0.01 C
+  int32_t humidity;     // 0.01 %RH
+  int32_t pressure;     // Pa
+} app_sensor_sample_t;
+
+// Battery schedule, independent of the sensor interval. The ZCL reporting
+// defaults for BatteryVoltage are 3600..7200 s, so hourly is plenty.
+#ifndef APP_BATTERY_INTERVAL_S
+#define APP_BATTERY_INTERVAL_S 3600u
+#endif
+// 1 = take a due measurement right after a radio TX (loaded voltage, the one
+// that predicts brownout) instead of with the next sample
+#ifndef APP_BATTERY_AFTER_TX
+#define APP_BATTERY_AFTER_TX 1
+#endif
+// Longest a due measurement waits for a TX before it runs with a sample
+#ifndef APP_BATTERY_TX_WAIT_S
+#define APP_BATTERY_TX_WAIT_S 600u
+#endif
+
+// Battery conversion runs from the ADC interrupt. One started with a sample
+// overlaps its acquisition, and a sample that is ready first waits for the
+// completion event; one started after a TX is published on its own.
+static bool battery_measurement_pending = false;
+static bool battery_for_sample = false;
+static bool battery_sample_fresh = false;
+static bool battery_measured = false;
+static uint32_t battery_last_tick = 0;  // Start of the last measurement
+static bool sample_waiting_for_battery = false;
+static app_sensor_sample_t deferred_sample;
+static uint16_t battery_sample_mv = 0;
+
+// BatteryPercentageRemaining smoothing: EMA with weight 1/2^shift, so a
+// reading near a curve breakpoint does not flap and trigger reports
+#ifndef APP_BATTERY_EMA_SHIFT
+#define APP_BATTERY_EMA_SHIFT 2
+#endif
+// A rise of more than this (0.5 % units) restarts the filter (new cells)
+#ifndef APP_BATTERY_EMA_RESET_STEP
+#define APP_BATTERY_EMA_RESET_STEP 40
+#endif
+static uint16_t battery_percent_ema = 0;  // 0-200 in 1/256 units
+static bool battery_percent_ema_valid = false;
+// Temperature of the latest sample (0.01 C) for the state-of-charge curve
+static int32_t battery_temperature = BATTERY_TEMPERATURE_UNKNOWN;
+
+// Cross-check the voltage curve against the app_energy coulomb count
+#ifndef APP_BATTERY_COULOMB_CHECK
+#define APP_BATTERY_COULOMB_CHECK 1
+#endif
 
 // Configurable sensor update interval
 static uint32_t sensor_update_interval_ms = SENSOR_UPDATE_INTERVAL_MS;
+// Period the sensor timer runs at (sensor_update_interval_ms unless adapted)
+static uint32_t sensor_timer_interval_ms = SENSOR_UPDATE_INTERVAL_MS;
+
+// Adaptive interval (attributes 0xF006..0xF008). A quiet sample stretches the
+// timer period by aggressiveness/8 toward the maximum; a sample whose rate of
+// change exceeds a threshold, by more than the noise floor, drops it back to
+// the minimum. Aggressiveness 0 keeps the fixed interval.
+#ifndef APP_ADAPTIVE_TEMP_NOISE
+#define APP_ADAPTIVE_TEMP_NOISE      10   // 0.01 C
+#endif
+#ifndef APP_ADAPTIVE_TEMP_RATE
+#define APP_ADAPTIVE_TEMP_RATE       10   // 0.01 C per minute
+#endif
+#ifndef APP_ADAPTIVE_HUMIDITY_NOISE
+#define APP_ADAPTIVE_HUMIDITY_NOISE  50   // 0.01 %RH
+#endif
+#ifndef APP_ADAPTIVE_HUMIDITY_RATE
+#define APP_ADAPTIVE_HUMIDITY_RATE   50   // 0.01 %RH per minute
+#endif
+#ifndef APP_ADAPTIVE_PRESSURE_NOISE
+#define APP_ADAPTIVE_PRESSURE_NOISE  20   // Pa
+#endif
+#ifndef APP_ADAPTIVE_PRESSURE_RATE
+#define APP_ADAPTIVE_PRESSURE_RATE   20   // Pa per minute
+#endif
+
+static uint32_t adaptive_min_ms = SENSOR_UPDATE_INTERVAL_MS;
+static uint32_t adaptive_max_ms = SENSOR_UPDATE_INTERVAL_MS;
+static uint8_t adaptive_aggressiveness = 0;
+static bool adaptive_have_last = false;
+static app_sensor_sample_t adaptive_last_sample;
+static uint32_t adaptive_last_tick = 0;
+
+// Sample filter between acquisition and the ZCL write. A burst of
+// APP_SENSOR_MEDIAN_N reads (1 = off) is reduced to its per-channel median,
+// then the result is checked against the sensor output range and, with
+// APP_SENSOR_DELTA_REJECT, against the last accepted sample: a jump larger
+// than the step allowance plus the rate times the elapsed minutes is dropped.
+// After APP_SENSOR_REJECT_MAX rejections in a row the next jump is taken as a
+// real step change.
+#ifndef APP_SENSOR_MEDIAN_N
+#define APP_SENSOR_MEDIAN_N 1
+#endif
+#ifndef APP_SENSOR_DELTA_REJECT
+#define APP_SENSOR_DELTA_REJECT 1
+#endif
+#ifndef APP_SENSOR_REJECT_MAX
+#define APP_SENSOR_REJECT_MAX 3
+#endif
+#ifndef APP_FILTER_TEMP_STEP
+#define APP_FILTER_TEMP_STEP       300   // 0.01 C
+#endif
+#ifndef APP_FILTER_TEMP_RATE
+#define APP_FILTER_TEMP_RATE       500   // 0.01 C per minute
+#endif
+#ifndef APP_FILTER_HUMIDITY_STEP
+#define APP_FILTER_HUMIDITY_STEP   1000  // 0.01 %RH
+#endif
+#ifndef APP_FILTER_HUMIDITY_RATE
+#define APP_FILTER_HUMIDITY_RATE   2000  // 0.01 %RH per minute
+#endif
+#ifndef APP_FILTER_PRESSURE_STEP
+#define APP_FILTER_PRESSURE_STEP   300   // Pa
+#endif
+#ifndef APP_FILTER_PRESSURE_RATE
+#define APP_FILTER_PRESSURE_RATE   1000  // Pa per minute
+#endif
+// Elapsed time beyond this no longer widens the delta allowance
+#define APP_FILTER_MAX_ELAPSED_S   3600u
+
+#if (APP_SENSOR_MEDIAN_N < 1) || (APP_SENSOR_MEDIAN_N > 5) || ((APP_SENSOR_MEDIAN_N % 2) == 0)
+#error "APP_SENSOR_MEDIAN_N must be 1, 3 or 5"
+#endif
+#if (APP_SENSOR_REJECT_MAX < 1) || (APP_SENSOR_REJECT_MAX > 254)
+#error "APP_SENSOR_REJECT_MAX must be 1..254 (filter_reject_run is 8-bit)"
+#endif
+
+// Output range of the supported sensors (SHT31: -40..125 C, BME280: -40..85 C,
+// 300..1100 hPa)
+#define APP_FILTER_TEMP_MIN        (-4000)
+#define APP_FILTER_TEMP_MAX        12500
+#define APP_FILTER_HUMIDITY_MAX    10000
+#define APP_FILTER_PRESSURE_MIN    30000
+#define APP_FILTER_PRESSURE_MAX    110000
+
+static app_sensor_filter_stats_t filter_stats;
+static bool filter_have_last = false;
+static app_sensor_sample_t filter_last_sample;
+static uint32_t filter_last_tick = 0;
+static uint8_t filter_reject_run = 0;
+
+#if (APP_SENSOR_MEDIAN_N > 1)
+static app_sensor_sample_t sensor_burst[APP_SENSOR_MEDIAN_N];
+static uint8_t sensor_burst_count = 0;
+static uint8_t sensor_burst_reads = 0;
+#endif
 
 #ifndef APP_DEBUG_FAKE_SENSOR_VALUES
 #define APP_DEBUG_FAKE_SENSOR_VALUES 0
@@ -62,8 +540,13 @@ static uint32_t sensor_update_interval_ms = SENSOR_UPDATE_INTERVAL_MS;
 #ifndef APP_DEBUG_FAKE_DRIFT_MS
 #define APP_DEBUG_FAKE_DRIFT_MS 60000
 #endif
+// Log I2C interrupt count / CPU time / blocked time for every sample
+#ifndef APP_DEBUG_I2C_STATS
+#define APP_DEBUG_I2C_STATS 0
+#endif
 
-static uint32_t fake_last_change_ms = 0;
+static bool fake_changed = false;
+static uint32_t fake_last_change_tick = 0;
 typedef struct {
   int32_t temperature;
   uint32_t humidity;
@@ -77,12 +560,6 @@ static app_fake_sensor_data_t fake_sensor_data = {
 };
 static uint32_t fake_prng_state = 0x12345678u;
 
-static uint32_t app_get_ms(void)
-{
-  uint32_t ticks = sl_sleeptimer_get_tick_count();
-  return (uint32_t)sl_sleeptimer_tick_to_ms(ticks);
-}
-
 static uint32_t app_fake_prng_next(uint32_t salt)
 {
   fake_prng_state = (fake_prng_state * 1664525u) + 1013904223u + salt;
@@ -94,16 +571,18 @@ static int32_t app_fake_apply_delta_percent(int32_t base, int8_t percent)
   return base + ((base * percent) / 100);
 }
 
-static void app_update_fake_sensor_data(uint32_t now_ms)
+static void app_update_fake_sensor_data(void)
 {
-  if (fake_last_change_ms != 0 && (now_ms - fake_last_change_ms) < APP_DEBUG_FAKE_DRIFT_MS) {
+  if (fake_changed && app_ms_since(fake_last_change_tick) < APP_DEBUG_FAKE_DRIFT_MS) {
     return;
   }
-  fake_last_change_ms = now_ms;
+  uint32_t now_tick = sl_sleeptimer_get_tick_count();
+  fake_changed = true;
+  fake_last_change_tick = now_tick;
 
-  int8_t d_t = (int8_t)((int32_t)(app_fake_prng_next(now_ms) % 21u) - 10);
-  int8_t d_h = (int8_t)((int32_t)(app_fake_prng_next(now_ms + 1u) % 21u) - 10);
-  int8_t d_p = (int8_t)((int32_t)(app_fake_prng_next(now_ms + 2u) % 21u) - 10);
+  int8_t d_t = (int8_t)((int32_t)(app_fake_prng_next(now_tick) % 21u) - 10);
+  int8_t d_h = (int8_t)((int32_t)(app_fake_prng_next(now_tick + 1u) % 21u) - 10);
+  int8_t d_p = (int8_t)((int32_t)(app_fake_prng_next(now_tick + 2u) % 21u) - 10);
 
   fake_sensor_data.temperature = app_fake_apply_delta_percent(fake_sensor_data.temperature, d_t);
   fake_sensor_data.humidity = app_fake_apply_delta_percent(fake_sensor_data.humidity, d_h);
@@ -123,8 +602,63 @@ static void app_update_fake_sensor_data(uint32_t now_ms)
 }
 
 // Forward declarations
-static void sensor_update_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static uint32_t app_sensor_initial_timer_interval(void);
+static void app_sensor_adapt_interval(const app_sensor_sample_t *sample);
 static void process_periodic_sensor_update(void);
+static void app_sensor_publish(const app_sensor_sample_t *sample);
+static bool app_sensor_collect_battery(void);
+static void app_sensor_publish_battery(void);
+static void app_sensor_finish_measurement(void);
+
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+// Let the driver pick single-shot or periodic acquisition for the interval.
+static void app_sensor_configure_sht31(void)
+{
+  if (!sensor_ready) {
+    return;
+  }
+
+  sht31_energy_estimate_t energy;
+  sht31_estimate_energy(sensor_update_interval_ms, &energy);
+  if (!sht31_set_sample_interval(sensor_update_interval_ms)) {
+    APP_LOG_ERROR("Error: SHT31 acquisition mode change failed");
+  }
+
+  if (sht31_is_periodic()) {
+    APP_LOG_INFO("SHT31 periodic mode, period %lu ms",
+                 (unsigned long)sht31_get_periodic_period_ms(sht31_get_periodic_rate()));
+  } else {
+    APP_LOG_INFO("SHT31 single-shot mode");
+  }
+  APP_LOG_INFO("SHT31 charge/sample: single-shot=%lu nC periodic=%lu nC",
+               (unsigned long)energy.single_shot_nc,
+               (unsigned long)energy.periodic_nc);
+}
+#endif
+
+#if APP_DEBUG_I2C_STATS
+// CPU-active time is the cycles spent in I2C/LDMA interrupts; the rest of
+// the blocked time the core sits in EM1.
+static void app_log_i2c_stats(void)
+{
+  hal_i2c_stats_t stats;
+  hal_i2c_get_stats(&stats);
+
+  uint32_t core_mhz = CMU_ClockFreqGet(cmuClock_CORE) / 1000000u;
+  uint32_t cpu_us = (core_mhz != 0u) ? (stats.isr_cycles / core_mhz) : 0u;
+  uint32_t wait_us = (uint32_t)(((uint64_t)stats.wait_ticks * 1000000u)
+                                / sl_sleeptimer_get_timer_frequency());
+
+  APP_LOG_DEBUG("I2C: xfers=%lu dma=%lu err=%lu bytes=%lu irqs=%lu cpu=%lu us blocked=%lu us",
+                (unsigned long)stats.transfers,
+                (unsigned long)stats.dma_transfers,
+                (unsigned long)stats.errors,
+                (unsigned long)stats.bytes,
+                (unsigned long)stats.isr_count,
+                (unsigned long)cpu_us,
+                (unsigned long)wait_us);
+}
+#endif
 
 bool app_sensor_init(void)
 {
@@ -133,41 +667,56 @@ bool app_sensor_init(void)
   sensor_timer_running = false;
   sensor_update_pending = false;
   sensor_network_down_logged = false;
-  sensor_last_update_ms = 0;
+  sensor_updated = false;
+  battery_measurement_pending = false;
+  battery_for_sample = false;
+  battery_sample_fresh = false;
+  battery_measured = false;
+  battery_last_tick = 0;
+  sample_waiting_for_battery = false;
+  battery_percent_ema_valid = false;
+  battery_temperature = BATTERY_TEMPERATURE_UNKNOWN;
+  sensor_measurement_pending = false;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  sensor_reconfigure_pending = false;
+#endif
 
   // Initialize battery monitoring regardless of sensor presence.
   battery_ready = battery_init();
   if (!battery_ready) {
-    emberAfCorePrintln("Error: Battery monitoring initialization failed");
+    APP_LOG_ERROR("Error: Battery monitoring initialization failed");
   } else {
-    emberAfCorePrintln("Battery monitoring initialized successfully");
+    APP_LOG_INFO("Battery monitoring initialized successfully");
   }
 
   // Initialize sensor according to selected profile.
 #if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
   if (!sht31_init()) {
-    emberAfCorePrintln("Error: SHT31 initialization failed");
+    APP_LOG_ERROR("Error: SHT31 initialization failed");
     sensor_ready = false;
   } else {
     sensor_ready = true;
-    emberAfCorePrintln("Detected sensor: SHT31 (I2C addr 0x%02X)",
-                       sht31_get_i2c_addr());
+    APP_LOG_INFO("Detected sensor: SHT31 (I2C addr 0x%02X)",
+                 sht31_get_i2c_addr());
+    uint8_t mode = app_config_get()->sht31_measurement_mode;
+    (void)sht31_set_measurement_mode((sht31_repeatability_t)(mode & APP_SHT31_MODE_REPEATABILITY_MASK),
+                                     (mode & APP_SHT31_MODE_CLOCK_STRETCH) != 0u);
   }
 #else
   if (!bme280_init()) {
-    emberAfCorePrintln("Error: BME280/BMP280 initialization failed");
+    APP_LOG_ERROR("Error: BME280/BMP280 initialization failed");
     sensor_ready = false;
   } else {
     sensor_ready = true;
-    emberAfCorePrintln("Detected sensor chip ID: 0x%02X (%s)",
-                       bme280_get_chip_id(),
-                       bme280_has_humidity() ? "BME280" : "BMP280");
-    emberAfCorePrintln("BME280/BMP280 sensor initialized successfully");
+    APP_LOG_INFO("Detected sensor chip ID: 0x%02X (%s)",
+                 bme280_get_chip_id(),
+                 bme280_has_humidity() ? "BME280" : "BMP280");
+    APP_LOG_INFO("BME280/BMP280 sensor initialized successfully");
   }
 #endif
 
   if (!sensor_ready && !battery_ready) {
-    emberAfCorePrintln("Error: neither sensor nor battery monitor initialized");
+    APP_LOG_ERROR("Error: neither sensor nor battery monitor initialized");
     return false;
   }
 
@@ -177,14 +726,32 @@ bool app_sensor_init(void)
 #if APP_FORCE_SENSOR_INTERVAL_MS > 0
   sensor_update_interval_ms = APP_FORCE_SENSOR_INTERVAL_MS;
 #endif
+  adaptive_min_ms = (uint32_t)config->adaptive_interval_min_seconds * 1000u;
+  adaptive_max_ms = (uint32_t)config->adaptive_interval_max_seconds * 1000u;
+  adaptive_aggressiveness = config->adaptive_aggressiveness;
+  adaptive_have_last = false;
+  sensor_timer_interval_ms = app_sensor_initial_timer_interval();
 
   // Do not start periodic timer while network is down.
   // It will be armed on EMBER_NETWORK_UP via app_sensor_start_periodic_updates().
   sensor_timer_running = false;
   sensor_update_pending = false;
 
-  emberAfCorePrintln("Sensor poll interval: %d seconds (armed on network up)",
-                     sensor_update_interval_ms / 1000);
+  APP_LOG_INFO("Sensor poll interval: %d seconds (armed on network up)",
+               sensor_timer_interval_ms / 1000);
+
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  app_sensor_configure_sht31();
+#else
+  if (sensor_ready) {
+    bme280_energy_estimate_t energy;
+    bme280_estimate_energy(sensor_update_interval_ms, &energy);
+    APP_LOG_INFO("BME280 conversion %lu us, charge/sample: forced=%lu nC normal=%lu nC",
+                 (unsigned long)bme280_get_measurement_time_us(),
+                 (unsigned long)energy.forced_nc,
+                 (unsigned long)energy.normal_nc);
+  }
+#endif
 
   return true;
 }
@@ -193,45 +760,60 @@ void app_sensor_start_periodic_updates(void)
 {
   // Ensure periodic timer is running.
   if (!sensor_timer_running) {
-    sl_status_t timer_status =
-      sl_sleeptimer_start_periodic_timer_ms(&sensor_update_timer,
-                                            sensor_update_interval_ms,
-                                            sensor_update_timer_callback,
-                                            NULL,
-                                            0,
-                                            0);
-    if (timer_status != SL_STATUS_OK) {
-      emberAfCorePrintln("Error: sensor periodic timer start failed (0x%lx)",
-                         (unsigned long)timer_status);
-      return;
-    }
+    app_sched_start_ms(&sensor_update_task, sensor_timer_interval_ms);
     sensor_timer_running = true;
   }
 
-  // Force an immediate sample after join.
+  // Force an immediate sample after join, written and reported in full.
+  app_invalidate_attribute_shadow();
   sensor_update_pending = true;
   sensor_network_down_logged = false;
-  emberAfCorePrintln("Starting periodic sensor updates (interval: %d seconds)",
-                     sensor_update_interval_ms / 1000);
+  APP_LOG_INFO("Starting periodic sensor updates (interval: %d seconds)",
+               sensor_timer_interval_ms / 1000);
 }
 
 void app_sensor_stop_periodic_updates(void)
 {
   if (sensor_timer_running) {
-    sl_status_t timer_status = sl_sleeptimer_stop_timer(&sensor_update_timer);
-    if (timer_status != SL_STATUS_OK) {
-      emberAfCorePrintln("Warning: sensor timer stop failed (0x%lx)",
-                         (unsigned long)timer_status);
-    }
+    app_sched_cancel(&sensor_update_task);
     sensor_timer_running = false;
   }
 
   sensor_update_pending = false;
   sensor_network_down_logged = false;
+  poll_seen = false;
+#if (APP_WAKE_COALESCE_SLACK_MS > 0)
+  if (sensor_waiting_for_poll) {
+    app_sched_cancel(&sensor_poll_fallback_task);
+    sensor_waiting_for_poll = false;
+  }
+  sensor_update_on_poll = false;
+#endif
 }
 
 void app_sensor_process(void)
 {
+  if (sample_waiting_for_battery && battery_measurement_ready()) {
+    sample_waiting_for_battery = false;
+    app_sensor_publish(&deferred_sample);
+  }
+
+  if (battery_measurement_pending && !battery_for_sample && battery_measurement_ready()) {
+    (void)app_sensor_collect_battery();
+    app_sensor_publish_battery();
+    app_flush_reports();
+  }
+
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  if (sensor_measurement_pending && sht31_measurement_ready()) {
+    app_sensor_finish_measurement();
+  }
+#else
+  if (sensor_measurement_pending && bme280_measurement_ready()) {
+    app_sensor_finish_measurement();
+  }
+#endif
+
   if (!sensor_update_pending) {
     return;
   }
@@ -239,134 +821,593 @@ void app_sensor_process(void)
   process_periodic_sensor_update();
 }
 
+// Run the sensor timer at interval_ms, restarting it if it is armed
+static void app_sensor_apply_timer_interval(uint32_t interval_ms)
+{
+  sensor_timer_interval_ms = interval_ms;
+  if (!sensor_timer_running) {
+    return;
+  }
+  app_sched_start_ms(&sensor_update_task, sensor_timer_interval_ms);
+}
+
+// Starting period: the configured interval, inside the adaptive bounds
+static uint32_t app_sensor_initial_timer_interval(void)
+{
+  uint32_t interval_ms = sensor_update_interval_ms;
+
+  if (adaptive_aggressiveness != 0u) {
+    if (interval_ms < adaptive_min_ms) {
+      interval_ms = adaptive_min_ms;
+    } else if (interval_ms > adaptive_max_ms) {
+      interval_ms = adaptive_max_ms;
+    }
+  }
+  return interval_ms;
+}
+
 void app_sensor_set_interval(uint32_t interval_ms)
 {
   if (interval_ms < 10000) {
-    emberAfCorePrintln("Warning: Interval too short, using minimum 10 seconds");
+    APP_LOG_WARN("Warning: Interval too short, using minimum 10 seconds");
     interval_ms = 10000;
   }
 
   sensor_update_interval_ms = interval_ms;
-  emberAfCorePrintln("Sensor update interval changed to %d seconds", interval_ms / 1000);
+  APP_LOG_INFO("Sensor update interval changed to %d seconds", interval_ms / 1000);
+
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  // Applied after the in-flight conversion, if any, has been published
+  if (sensor_measurement_pending) {
+    sensor_reconfigure_pending = true;
+  } else {
+    app_sensor_configure_sht31();
+  }
+#endif
 
   if (!sensor_timer_running) {
-    emberAfCorePrintln("Sensor interval stored; periodic timer will start after sensor init");
+    sensor_timer_interval_ms = app_sensor_initial_timer_interval();
+    APP_LOG_INFO("Sensor interval stored; periodic timer will start after sensor init");
     return;
   }
 
-  sl_status_t timer_status =
-    sl_sleeptimer_restart_periodic_timer_ms(&sensor_update_timer,
-                                            sensor_update_interval_ms,
-                                            sensor_update_timer_callback,
-                                            NULL,
-                                            0,
-                                            0);
-  if (timer_status != SL_STATUS_OK) {
-    emberAfCorePrintln("Error: sensor periodic timer restart failed (0x%lx)",
-                       (unsigned long)timer_status);
+  app_sensor_apply_timer_interval(app_sensor_initial_timer_interval());
+}
+
+void app_sensor_set_adaptive_interval(uint16_t min_seconds,
+                                      uint16_t max_seconds,
+                                      uint8_t aggressiveness)
+{
+  if (min_seconds > max_seconds) {
+    return;
   }
+
+  adaptive_min_ms = (uint32_t)min_seconds * 1000u;
+  adaptive_max_ms = (uint32_t)max_seconds * 1000u;
+  adaptive_aggressiveness = aggressiveness;
+  adaptive_have_last = false;
+
+  if (aggressiveness == 0u) {
+    APP_LOG_INFO("Adaptive interval: off");
+  } else {
+    APP_LOG_INFO("Adaptive interval: %u..%u s, aggressiveness %u",
+                 min_seconds, max_seconds, aggressiveness);
+  }
+  app_sensor_apply_timer_interval(app_sensor_initial_timer_interval());
+}
+
+uint32_t app_sensor_get_interval_ms(void)
+{
+  return sensor_timer_interval_ms;
 }
 
-static void sensor_update_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+// True when a channel moved by more than its noise floor, faster than its
+// rate threshold (per minute).
+static bool app_sensor_channel_active(int32_t previous,
+                                      int32_t current,
+                                      uint32_t elapsed_ms,
+                                      uint32_t noise,
+                                      uint32_t rate_per_min)
 {
-  (void)handle;
-  (void)data;
+  uint32_t delta = (current > previous) ? (uint32_t)(current - previous)
+                                        : (uint32_t)(previous - current);
+
+  if (delta <= noise) {
+    return false;
+  }
+  return ((uint64_t)delta * 60000u) > ((uint64_t)rate_per_min * elapsed_ms);
+}
+
+// Pick the next timer period from the rate of change since the last sample.
+static void app_sensor_adapt_interval(const app_sensor_sample_t *sample)
+{
+  if (adaptive_aggressiveness == 0u || !sample->valid) {
+    return;
+  }
+
+  uint32_t next_ms = sensor_timer_interval_ms;
+  if (adaptive_have_last) {
+    const app_sensor_sample_t *last = &adaptive_last_sample;
+    uint32_t elapsed_ms = app_ms_since(adaptive_last_tick);
+    if (elapsed_ms == 0u) {
+      elapsed_ms = 1u;
+    }
+
+    bool active = app_sensor_channel_active(last->temperature, sample->temperature, elapsed_ms,
+                                            APP_ADAPTIVE_TEMP_NOISE, APP_ADAPTIVE_TEMP_RATE);
+    if (sample->has_humidity && last->has_humidity) {
+      active = active
+               || app_sensor_channel_active(last->humidity, sample->humidity, elapsed_ms,
+                                            APP_ADAPTIVE_HUMIDITY_NOISE, APP_ADAPTIVE_HUMIDITY_RATE);
+    }
+    if (sample->has_pressure && last->has_pressure) {
+      active = active
+               || app_sensor_channel_active(last->pressure, sample->pressure, elapsed_ms,
+                                            APP_ADAPTIVE_PRESSURE_NOISE, APP_ADAPTIVE_PRESSURE_RATE);
+    }
+
+    if (active) {
+      next_ms = adaptive_min_ms;
+    } else {
+      next_ms += (next_ms / 8u) * adaptive_aggressiveness;
+      if (next_ms > adaptive_max_ms) {
+        next_ms = adaptive_max_ms;
+      }
+    }
+  }
+
+  adaptive_last_sample = *sample;
+  adaptive_last_tick = sl_sleeptimer_get_tick_count();
+  adaptive_have_last = true;
+
+  if (next_ms != sensor_timer_interval_ms) {
+    APP_LOG_INFO("Adaptive interval: %lu -> %lu s",
+                 (unsigned long)(sensor_timer_interval_ms / 1000u),
+                 (unsigned long)(next_ms / 1000u));
+    app_sensor_apply_timer_interval(next_ms);
+  }
+}
+
+static void sensor_update_timer_handler(app_sched_task_t *task)
+{
+  if (app_sched_timer_woke()) {
+    app_diag_wake_hint(APP_DIAG_WAKE_SENSOR_TIMER);
+  }
+  app_sched_advance_ms(task, sensor_timer_interval_ms);
+  wake_stats.timer_wakes++;
+  sensor_update_pending = true;
+}
+
+#if (APP_WAKE_COALESCE_SLACK_MS > 0)
+static void sensor_poll_fallback_handler(app_sched_task_t *task)
+{
+  (void)task;
   sensor_update_pending = true;
 }
 
+// Milliseconds until the next poll predicted from the last one, or
+// UINT32_MAX before the first poll
+static uint32_t app_sensor_ms_until_poll(void)
+{
+  if (!poll_seen || poll_interval_ms == 0) {
+    return UINT32_MAX;
+  }
+  return poll_interval_ms - (app_ms_since(poll_last_tick) % poll_interval_ms);
+}
+
+// Hold a due sample for a poll expected within the slack. Returns true if the
+// sample was deferred; the fallback timer takes it if the poll never comes.
+static bool app_sensor_defer_to_poll(void)
+{
+  if (sensor_update_on_poll) {
+    sensor_update_on_poll = false;
+    return false;
+  }
+  if (sensor_waiting_for_poll) {
+    sensor_waiting_for_poll = false;
+    wake_stats.poll_missed++;
+    return false;
+  }
+
+  uint32_t until_poll_ms = app_sensor_ms_until_poll();
+  if (until_poll_ms > APP_WAKE_COALESCE_SLACK_MS) {
+    return false;
+  }
+  app_sched_start_ms(&sensor_poll_fallback_task,
+                     until_poll_ms + APP_WAKE_COALESCE_SLACK_MS);
+  sensor_waiting_for_poll = true;
+  wake_stats.deferred++;
+  return true;
+}
+#endif
+
 static void process_periodic_sensor_update(void)
 {
   // Only read sensor if network is up (power optimization)
   if (emberAfNetworkState() == EMBER_JOINED_NETWORK) {
     sensor_network_down_logged = false;
+#if (APP_WAKE_COALESCE_SLACK_MS > 0)
+    if (app_sensor_defer_to_poll()) {
+      return;
+    }
+#endif
     app_sensor_update();
   } else if (!sensor_network_down_logged) {
-    emberAfCorePrintln("Network down: sensor reads suspended");
+    APP_LOG_INFO("Network down: sensor reads suspended");
     sensor_network_down_logged = true;
   }
 }
 
-void app_sensor_update(void)
+// Whether the battery measurement is due
+static bool app_sensor_battery_due(void)
 {
-#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
-  sht31_data_t sht_data;
-#else
-  bme280_data_t bme_data;
+  return battery_ready
+         && !battery_measurement_pending
+         && (!battery_measured
+             || app_ms_since(battery_last_tick) >= APP_BATTERY_INTERVAL_S * 1000u);
+}
+
+// Whether the sample starting now should also measure the battery
+static bool app_sensor_battery_due_for_sample(void)
+{
+  if (!app_sensor_battery_due()) {
+    return false;
+  }
+#if APP_BATTERY_AFTER_TX
+  // Leave it to app_sensor_note_radio_tx() unless no TX came in time
+  if (battery_measured
+      && app_ms_since(battery_last_tick)
+         < (APP_BATTERY_INTERVAL_S + APP_BATTERY_TX_WAIT_S) * 1000u) {
+    return false;
+  }
 #endif
-  EmberAfStatus status;
-  bool has_humidity = false;
-  bool has_pressure = false;
-  bool have_sensor_sample = false;
-  int32_t raw_temperature = 0;   // 0.01 C
-  int32_t raw_humidity = 0;      // 0.01 %RH
-  int32_t raw_pressure = 0;      // Pa
-  uint32_t now_ms = app_get_ms();
+  return true;
+}
 
-  // Read sensor data
-  if (sensor_ready) {
-#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
-    if (sht31_read_data(&sht_data)) {
-      have_sensor_sample = true;
-      has_humidity = true;
-      has_pressure = false;
-      raw_temperature = sht_data.temperature;
-      raw_humidity = (int32_t)sht_data.humidity;
-      raw_pressure = 0;
-    } else {
-      emberAfCorePrintln("Error: Failed to read SHT31 data");
+// Start a battery conversion; the next one is due APP_BATTERY_INTERVAL_S later
+static void app_sensor_start_battery(bool for_sample)
+{
+  battery_last_tick = sl_sleeptimer_get_tick_count();
+  battery_for_sample = for_sample;
+  battery_measurement_pending = battery_start_measurement();
+  if (!battery_measurement_pending) {
+    battery_sample_mv = battery_fetch_voltage_mv();  // last good value
+    battery_sample_fresh = true;
+  }
+}
+
+// Collect a finished battery conversion; false while it is still running
+static bool app_sensor_collect_battery(void)
+{
+  if (!battery_measurement_pending) {
+    return true;
+  }
+  if (!battery_measurement_ready()) {
+    return false;
+  }
+  battery_measurement_pending = false;
+  battery_sample_mv = battery_fetch_voltage_mv();
+  battery_sample_fresh = true;
+  battery_measured = true;
+  return true;
+}
+
+// Smooth the state of charge; a large rise (battery swap) is taken as is
+static uint8_t app_sensor_filter_battery_percent(uint8_t percent)
+{
+  uint16_t sample = (uint16_t)((uint16_t)percent << 8);
+
+  if (!battery_percent_ema_valid
+      || percent > (uint8_t)(battery_percent_ema >> 8) + APP_BATTERY_EMA_RESET_STEP) {
+    battery_percent_ema = sample;
+    battery_percent_ema_valid = true;
+  } else {
+    battery_percent_ema = (uint16_t)((int32_t)battery_percent_ema
+                                     + ((int32_t)sample - (int32_t)battery_percent_ema)
+                                     / (1 << APP_BATTERY_EMA_SHIFT));
+  }
+  return (uint8_t)((battery_percent_ema + 128u) >> 8);
+}
+
+// Publish the collected battery measurement to the Power Configuration cluster
+static void app_sensor_publish_battery(void)
+{
+  if (!battery_sample_fresh) {
+    return;
+  }
+  battery_sample_fresh = false;
+
+  uint16_t battery_voltage_mv = battery_sample_mv;
+  uint8_t battery_voltage_100mv = (uint8_t)(battery_voltage_mv / 100);
+#if APP_BATTERY_COULOMB_CHECK
+  battery_set_charge_used_uah(app_energy_get_consumed_uah());
+#endif
+  uint8_t battery_soc = battery_calculate_percentage(battery_voltage_mv, battery_temperature);
+  uint8_t battery_percentage = app_sensor_filter_battery_percent(battery_soc);
+  app_energy_note_battery_percent(battery_percentage);
+  uint16_t battery_adc_raw = battery_get_last_raw_adc();
+  bool battery_sample_valid = battery_last_measurement_valid();
+
+  APP_LOG_DEBUG("Battery: adc=%d %s, %d mV (%d %%), raw: %d/200, filtered: %d/200",
+                battery_adc_raw,
+                battery_sample_valid ? "OK" : "FALLBACK",
+                battery_voltage_mv,
+                battery_percentage / 2, // Convert to percentage (200 = 100%)
+                battery_soc,
+                battery_percentage);
+#if (APP_LOG_LEVEL >= APP_LOG_LEVEL_DEBUG)
+  app_energy_stats_t energy;
+  app_energy_get_stats(&energy);
+  APP_LOG_DEBUG("Energy: %lu uAh, avg %lu nA (uC: cpu %lu, sleep %lu, radio %lu, poll %lu)",
+                (unsigned long)energy.total_uah,
+                (unsigned long)energy.avg_na,
+                (unsigned long)energy.cpu_uc,
+                (unsigned long)energy.sleep_uc,
+                (unsigned long)energy.radio_uc,
+                (unsigned long)energy.poll_uc);
+#endif
+
+  // BatteryVoltage (0x0020): uint8, 100 mV units (e.g., 30 = 3.0V)
+  app_publish_attribute(APP_ATTR_BATTERY_VOLTAGE, battery_voltage_100mv);
+
+  // BatteryPercentageRemaining (0x0021): uint8, 0-200 (200 = 100%)
+  app_publish_attribute(APP_ATTR_BATTERY_PERCENT, battery_percentage);
+}
+
+void app_sensor_set_battery_chemistry(uint8_t chemistry)
+{
+  battery_set_chemistry((battery_chemistry_t)chemistry);
+  // New curve: restart the filter and measure with the next sample
+  battery_percent_ema_valid = false;
+  battery_measured = false;
+}
+
+void app_sensor_note_poll(uint32_t interval_ms)
+{
+  wake_stats.polls++;
+  poll_seen = true;
+  poll_last_tick = sl_sleeptimer_get_tick_count();
+  poll_interval_ms = interval_ms;
+
+#if (APP_WAKE_COALESCE_SLACK_MS > 0)
+  if (!sensor_timer_running || sample_waiting_for_battery) {
+    return;
+  }
+  if (sensor_measurement_pending) {
+    return;
+  }
+
+  if (sensor_waiting_for_poll) {
+    // The deferred sample runs now, on the poll's wake
+    app_sched_cancel(&sensor_poll_fallback_task);
+    sensor_waiting_for_poll = false;
+  } else {
+    if (sensor_update_pending
+        || app_sched_remaining_ms(&sensor_update_task) > APP_WAKE_COALESCE_SLACK_MS) {
+      return;
     }
-#else
-    if (bme280_read_data(&bme_data)) {
-      have_sensor_sample = true;
-      raw_temperature = bme_data.temperature;
-      raw_humidity = (int32_t)bme_data.humidity;
-      raw_pressure = (int32_t)bme_data.pressure;
-#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_BMP280)
-      has_humidity = false;
-#else
-      has_humidity = bme280_has_humidity();
+    // Sample early; the restart below drops the sensor timer's own wake
+    wake_stats.wakes_saved++;
+  }
+
+  wake_stats.coalesced++;
+  app_sensor_apply_timer_interval(sensor_timer_interval_ms);
+  sensor_update_on_poll = true;
+  sensor_update_pending = true;
 #endif
-      has_pressure = true;
-    } else {
-      emberAfCorePrintln("Error: Failed to read BME280/BMP280 data");
+}
+
+void app_sensor_get_wake_stats(app_sensor_wake_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = wake_stats;
+  }
+}
+
+void app_sensor_note_radio_tx(void)
+{
+#if APP_BATTERY_AFTER_TX
+  if (app_sensor_battery_due() && battery_measured) {
+    app_sensor_start_battery(false);
+  }
+#endif
+}
+
+#if (APP_SENSOR_MEDIAN_N > 1)
+static int32_t app_sensor_median(int32_t *values, uint8_t count)
+{
+  // Insertion sort; count is at most APP_SENSOR_MEDIAN_N
+  for (uint8_t i = 1; i < count; i++) {
+    int32_t value = values[i];
+    uint8_t j = i;
+    while (j > 0 && values[j - 1] > value) {
+      values[j] = values[j - 1];
+      j--;
     }
+    values[j] = value;
+  }
+  return values[count / 2];
+}
+
+// Reduce count (>= 1) valid burst reads to their per-channel median.
+static void app_sensor_median_sample(const app_sensor_sample_t *burst,
+                                     uint8_t count,
+                                     app_sensor_sample_t *out)
+{
+  int32_t temperature[APP_SENSOR_MEDIAN_N];
+  int32_t humidity[APP_SENSOR_MEDIAN_N];
+  int32_t pressure[APP_SENSOR_MEDIAN_N];
+
+  for (uint8_t i = 0; i < count; i++) {
+    temperature[i] = burst[i].temperature;
+    humidity[i] = burst[i].humidity;
+    pressure[i] = burst[i].pressure;
+  }
+  *out = burst[0];
+  out->temperature = app_sensor_median(temperature, count);
+  out->humidity = app_sensor_median(humidity, count);
+  out->pressure = app_sensor_median(pressure, count);
+}
 #endif
+
+static bool app_sensor_filter_in_range(const app_sensor_sample_t *sample)
+{
+  if (sample->temperature < APP_FILTER_TEMP_MIN
+      || sample->temperature > APP_FILTER_TEMP_MAX) {
+    return false;
   }
+  if (sample->has_humidity
+      && (sample->humidity < 0 || sample->humidity > APP_FILTER_HUMIDITY_MAX)) {
+    return false;
+  }
+  if (sample->has_pressure
+      && (sample->pressure < APP_FILTER_PRESSURE_MIN
+          || sample->pressure > APP_FILTER_PRESSURE_MAX)) {
+    return false;
+  }
+  return true;
+}
+
+#if APP_SENSOR_DELTA_REJECT
+static bool app_sensor_filter_jump(int32_t previous,
+                                   int32_t current,
+                                   uint32_t step,
+                                   uint32_t rate_per_min,
+                                   uint32_t elapsed_s)
+{
+  int32_t delta = current - previous;
+  uint32_t magnitude = (uint32_t)((delta < 0) ? -delta : delta);
+
+  return magnitude > step + (rate_per_min * elapsed_s) / 60u;
+}
+
+static bool app_sensor_filter_plausible(const app_sensor_sample_t *sample)
+{
+  uint32_t elapsed_s = app_ms_since(filter_last_tick) / 1000u;
+
+  if (elapsed_s > APP_FILTER_MAX_ELAPSED_S) {
+    elapsed_s = APP_FILTER_MAX_ELAPSED_S;
+  }
+  if (app_sensor_filter_jump(filter_last_sample.temperature, sample->temperature,
+                             APP_FILTER_TEMP_STEP, APP_FILTER_TEMP_RATE, elapsed_s)) {
+    return false;
+  }
+  if (sample->has_humidity && filter_last_sample.has_humidity
+      && app_sensor_filter_jump(filter_last_sample.humidity, sample->humidity,
+                                APP_FILTER_HUMIDITY_STEP, APP_FILTER_HUMIDITY_RATE,
+                                elapsed_s)) {
+    return false;
+  }
+  if (sample->has_pressure && filter_last_sample.has_pressure
+      && app_sensor_filter_jump(filter_last_sample.pressure, sample->pressure,
+                                APP_FILTER_PRESSURE_STEP, APP_FILTER_PRESSURE_RATE,
+                                elapsed_s)) {
+    return false;
+  }
+  return true;
+}
+#endif
 
-  if (!have_sensor_sample && APP_DEBUG_FAKE_SENSOR_VALUES) {
-    app_update_fake_sensor_data(now_ms);
+// Range and delta check of a valid sample; false drops it from publishing.
+static bool app_sensor_filter_accept(const app_sensor_sample_t *sample)
+{
+  filter_stats.samples++;
+
+  // Out-of-range values are bus or sensor faults, never a real change
+  if (!app_sensor_filter_in_range(sample)) {
+    filter_stats.rejected_range++;
+    APP_LOG_WARN("Warning: sensor sample out of range (T=%ld)", (long)sample->temperature);
+    return false;
+  }
+
+#if APP_SENSOR_DELTA_REJECT
+  if (filter_have_last && !app_sensor_filter_plausible(sample)) {
+    if (++filter_reject_run <= APP_SENSOR_REJECT_MAX) {
+      filter_stats.rejected_delta++;
+      APP_LOG_WARN("Warning: sensor sample rejected as outlier (%u in a row)",
+                   (unsigned)filter_reject_run);
+      return false;
+    }
+    filter_stats.forced_accepts++;
+    APP_LOG_WARN("Warning: accepting sensor step change after %u rejections",
+                 (unsigned)(filter_reject_run - 1u));
+  }
+#endif
+
+  filter_reject_run = 0;
+  filter_have_last = true;
+  filter_last_sample = *sample;
+  filter_last_tick = sl_sleeptimer_get_tick_count();
+  return true;
+}
+
+// Publish one sample (or the debug fallback) plus battery state to ZCL.
+static void app_sensor_publish(const app_sensor_sample_t *sample)
+{
+  if (battery_for_sample && !app_sensor_collect_battery()) {
+    // app_sensor_process() publishes it on the ADC completion event
+    deferred_sample = *sample;
+    sample_waiting_for_battery = true;
+    return;
+  }
+
+  app_sensor_sample_t filtered = *sample;
+  bool sample_rejected = false;
+
+  if (filtered.valid && !app_sensor_filter_accept(&filtered)) {
+    // Published like a failed read: values keep their last accepted state
+    filtered.valid = false;
+    sample_rejected = true;
+  }
+  sample = &filtered;
+
+  bool has_humidity = sample->has_humidity;
+  bool has_pressure = sample->has_pressure;
+  bool have_sensor_sample = sample->valid;
+  int32_t raw_temperature = sample->temperature;   // 0.01 C
+  int32_t raw_humidity = sample->humidity;         // 0.01 %RH
+  int32_t raw_pressure = sample->pressure;         // Pa
+
+#if APP_DEBUG_I2C_STATS
+  if (sensor_ready) {
+    app_log_i2c_stats();
+  }
+#endif
+
+  if (!have_sensor_sample && !sample_rejected && APP_DEBUG_FAKE_SENSOR_VALUES) {
+    app_update_fake_sensor_data();
     raw_temperature = fake_sensor_data.temperature;
     raw_humidity = fake_sensor_data.humidity;
     raw_pressure = fake_sensor_data.pressure;
       has_humidity = (APP_PROFILE_HAS_HUMIDITY != 0);
       has_pressure = (APP_PROFILE_HAS_PRESSURE != 0);
     have_sensor_sample = true;
-    emberAfCorePrintln("Sensor: using debug fallback values (minute drift)");
+    APP_LOG_DEBUG("Sensor: using debug fallback values (minute drift)");
   }
 
   if (have_sensor_sample) {
     if (has_humidity && has_pressure) {
-      emberAfCorePrintln("Sensor read (raw): T=%d.%02d C, RH=%d.%02d %%, P=%ld Pa",
-                         (int)(raw_temperature / 100),
-                         (int)(raw_temperature % 100),
-                         (int)(raw_humidity / 100),
-                         (int)(raw_humidity % 100),
-                         (long)raw_pressure);
+      APP_LOG_DEBUG("Sensor read (raw): T=%d.%02d C, RH=%d.%02d %%, P=%ld Pa",
+                    (int)(raw_temperature / 100),
+                    (int)(raw_temperature % 100),
+                    (int)(raw_humidity / 100),
+                    (int)(raw_humidity % 100),
+                    (long)raw_pressure);
     } else if (has_humidity) {
-      emberAfCorePrintln("Sensor read (raw): T=%d.%02d C, RH=%d.%02d %%, P=--",
-                         (int)(raw_temperature / 100),
-                         (int)(raw_temperature % 100),
-                         (int)(raw_humidity / 100),
-                         (int)(raw_humidity % 100));
+      APP_LOG_DEBUG("Sensor read (raw): T=%d.%02d C, RH=%d.%02d %%, P=--",
+                    (int)(raw_temperature / 100),
+                    (int)(raw_temperature % 100),
+                    (int)(raw_humidity / 100),
+                    (int)(raw_humidity % 100));
     } else if (has_pressure) {
-      emberAfCorePrintln("Sensor read (raw): T=%d.%02d C, RH=--, P=%ld Pa",
-                         (int)(raw_temperature / 100),
-                         (int)(raw_temperature % 100),
-                         (long)raw_pressure);
+      APP_LOG_DEBUG("Sensor read (raw): T=%d.%02d C, RH=--, P=%ld Pa",
+                    (int)(raw_temperature / 100),
+                    (int)(raw_temperature % 100),
+                    (long)raw_pressure);
     } else {
-      emberAfCorePrintln("Sensor read (raw): T=%d.%02d C, RH=--, P=--",
-                         (int)(raw_temperature / 100),
-                         (int)(raw_temperature % 100));
+      APP_LOG_DEBUG("Sensor read (raw): T=%d.%02d C, RH=--, P=--",
+                    (int)(raw_temperature / 100),
+                    (int)(raw_temperature % 100));
     }
   }
 
@@ -377,149 +1418,253 @@ void app_sensor_update(void)
 
   if (have_sensor_sample) {
     if (has_humidity && has_pressure) {
-      emberAfCorePrintln("Sensor read (calibrated): T=%d.%02d C, RH=%d.%02d %%, P=%ld Pa",
-                         (int)(temp_calibrated / 100),
-                         (int)(temp_calibrated % 100),
-                         (int)(humidity_calibrated / 100),
-                         (int)(humidity_calibrated % 100),
-                         (long)pressure_calibrated);
+      APP_LOG_DEBUG("Sensor read (calibrated): T=%d.%02d C, RH=%d.%02d %%, P=%ld Pa",
+                    (int)(temp_calibrated / 100),
+                    (int)(temp_calibrated % 100),
+                    (int)(humidity_calibrated / 100),
+                    (int)(humidity_calibrated % 100),
+                    (long)pressure_calibrated);
     } else if (has_humidity) {
-      emberAfCorePrintln("Sensor read (calibrated): T=%d.%02d C, RH=%d.%02d %%, P=--",
-                         (int)(temp_calibrated / 100),
-                         (int)(temp_calibrated % 100),
-                         (int)(humidity_calibrated / 100),
-                         (int)(humidity_calibrated % 100));
+      APP_LOG_DEBUG("Sensor read (calibrated): T=%d.%02d C, RH=%d.%02d %%, P=--",
+                    (int)(temp_calibrated / 100),
+                    (int)(temp_calibrated % 100),
+                    (int)(humidity_calibrated / 100),
+                    (int)(humidity_calibrated % 100));
     } else if (has_pressure) {
-      emberAfCorePrintln("Sensor read (calibrated): T=%d.%02d C, RH=--, P=%ld Pa",
-                         (int)(temp_calibrated / 100),
-                         (int)(temp_calibrated % 100),
-                         (long)pressure_calibrated);
+      APP_LOG_DEBUG("Sensor read (calibrated): T=%d.%02d C, RH=--, P=%ld Pa",
+                    (int)(temp_calibrated / 100),
+                    (int)(temp_calibrated % 100),
+                    (long)pressure_calibrated);
     } else {
-      emberAfCorePrintln("Sensor read (calibrated): T=%d.%02d C, RH=--, P=--",
-                         (int)(temp_calibrated / 100),
-                         (int)(temp_calibrated % 100));
+      APP_LOG_DEBUG("Sensor read (calibrated): T=%d.%02d C, RH=--, P=--",
+                    (int)(temp_calibrated / 100),
+                    (int)(temp_calibrated % 100));
     }
   }
 
+  uint32_t written_before = publish_stats.written;
+  uint32_t skipped_before = publish_stats.skipped;
+
   if (have_sensor_sample) {
-    // Update Temperature Measurement cluster (0x0402)
-    // MeasuredValue is int16, in 0.01°C units
-    int16_t temp_value = (int16_t)temp_calibrated;
-    status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
-                                         ZCL_TEMP_MEASUREMENT_CLUSTER_ID,
-                                         ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID,
-                                         (uint8_t *)&temp_value,
-                                         ZCL_INT16S_ATTRIBUTE_TYPE);
-    if (status != EMBER_ZCL_STATUS_SUCCESS) {
-      emberAfCorePrintln("Error: Failed to update temperature attribute (0x%x)", status);
-    } else {
-      app_notify_reporting(SENSOR_ENDPOINT,
-                           ZCL_TEMP_MEASUREMENT_CLUSTER_ID,
-                           ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID,
-                           ZCL_INT16S_ATTRIBUTE_TYPE,
-                           (uint8_t *)&temp_value);
-    }
+    battery_temperature = temp_calibrated;
+
+    // Temperature Measurement (0x0402): int16, 0.01 C
+    app_publish_attribute(APP_ATTR_TEMPERATURE, (int16_t)temp_calibrated);
 
     if (has_humidity) {
-      // Update Relative Humidity Measurement cluster (0x0405)
-      // MeasuredValue is uint16, in 0.01%RH units
-      uint16_t humidity_value = (uint16_t)humidity_calibrated;
-      status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
-                                           ZCL_HUMIDITY_MEASUREMENT_CLUSTER_ID,
-                                           ZCL_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID,
-                                           (uint8_t *)&humidity_value,
-                                           ZCL_INT16U_ATTRIBUTE_TYPE);
-      if (status != EMBER_ZCL_STATUS_SUCCESS) {
-        emberAfCorePrintln("Error: Failed to update humidity attribute (0x%x)", status);
-      } else {
-        app_notify_reporting(SENSOR_ENDPOINT,
-                             ZCL_HUMIDITY_MEASUREMENT_CLUSTER_ID,
-                             ZCL_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID,
-                             ZCL_INT16U_ATTRIBUTE_TYPE,
-                             (uint8_t *)&humidity_value);
-      }
+      // Relative Humidity Measurement (0x0405): uint16, 0.01 %RH
+      app_publish_attribute(APP_ATTR_HUMIDITY, (uint16_t)humidity_calibrated);
     } else {
-      emberAfCorePrintln("Humidity not supported by selected profile");
+      APP_LOG_INFO("Humidity not supported by selected profile");
     }
 
     if (has_pressure) {
-      // Update Pressure Measurement cluster (0x0403)
-      // MeasuredValue is int16, in kPa units (divide Pa by 1000)
-      int16_t pressure_value = (int16_t)(pressure_calibrated / 1000);
-      status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
-                                           ZCL_PRESSURE_MEASUREMENT_CLUSTER_ID,
-                                           ZCL_PRESSURE_MEASURED_VALUE_ATTRIBUTE_ID,
-                                           (uint8_t *)&pressure_value,
-                                           ZCL_INT16S_ATTRIBUTE_TYPE);
-      if (status != EMBER_ZCL_STATUS_SUCCESS) {
-        emberAfCorePrintln("Error: Failed to update pressure attribute (0x%x)", status);
-      } else {
-        app_notify_reporting(SENSOR_ENDPOINT,
-                             ZCL_PRESSURE_MEASUREMENT_CLUSTER_ID,
-                             ZCL_PRESSURE_MEASURED_VALUE_ATTRIBUTE_ID,
-                             ZCL_INT16S_ATTRIBUTE_TYPE,
-                             (uint8_t *)&pressure_value);
-      }
+      // Pressure Measurement (0x0403): int16, kPa (divide Pa by 1000)
+      app_publish_attribute(APP_ATTR_PRESSURE, (int16_t)(pressure_calibrated / 1000));
     }
   }
 
   if (battery_ready) {
-    // Update Power Configuration cluster (0x0001)
-    // Read battery voltage and percentage
-    uint16_t battery_voltage_mv = battery_read_voltage_mv();
-    uint8_t battery_voltage_100mv = (uint8_t)(battery_voltage_mv / 100);
-    uint8_t battery_percentage = battery_calculate_percentage(battery_voltage_mv);
-    uint16_t battery_adc_raw = battery_get_last_raw_adc();
-    bool battery_sample_valid = battery_last_measurement_valid();
-
-    emberAfCorePrintln("Battery: adc=%d %s, %d mV (%d %%), raw: %d/200",
-                       battery_adc_raw,
-                       battery_sample_valid ? "OK" : "FALLBACK",
-                       battery_voltage_mv,
-                       battery_percentage / 2, // Convert to percentage (200 = 100%)
-                       battery_percentage);
-
-    // Update BatteryVoltage attribute (0x0020)
-    // uint8, in 100mV units (e.g., 30 = 3.0V)
-    status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
-                                         ZCL_POWER_CONFIG_CLUSTER_ID,
-                                         ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID,
-                                         (uint8_t *)&battery_voltage_100mv,
-                                         ZCL_INT8U_ATTRIBUTE_TYPE);
-    if (status != EMBER_ZCL_STATUS_SUCCESS) {
-      emberAfCorePrintln("Error: Failed to update battery voltage attribute (0x%x)", status);
-    } else {
-      app_notify_reporting(SENSOR_ENDPOINT,
-                           ZCL_POWER_CONFIG_CLUSTER_ID,
-                           ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID,
-                           ZCL_INT8U_ATTRIBUTE_TYPE,
-                           (uint8_t *)&battery_voltage_100mv);
-    }
-
-    // Update BatteryPercentageRemaining attribute (0x0021)
-    // uint8, 0-200 range (0.5% resolution, 200 = 100%)
-    status = emberAfWriteServerAttribute(SENSOR_ENDPOINT,
-                                         ZCL_POWER_CONFIG_CLUSTER_ID,
-                                         ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
-                                         (uint8_t *)&battery_percentage,
-                                         ZCL_INT8U_ATTRIBUTE_TYPE);
-    if (status != EMBER_ZCL_STATUS_SUCCESS) {
-      emberAfCorePrintln("Error: Failed to update battery percentage attribute (0x%x)", status);
-    } else {
-      app_notify_reporting(SENSOR_ENDPOINT,
-                           ZCL_POWER_CONFIG_CLUSTER_ID,
-                           ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
-                           ZCL_INT8U_ATTRIBUTE_TYPE,
-                           (uint8_t *)&battery_percentage);
-    }
+    // Power Configuration cluster (0x0001), on the battery schedule only
+    app_sensor_publish_battery();
   } else {
-    emberAfCorePrintln("Battery monitor not initialized");
+    APP_LOG_DEBUG("Battery monitor not initialized");
   }
 
+  app_flush_reports();
+
+  // Report frames leave on the reporting plugin's tick, after this sample
+  APP_LOG_DEBUG("Attributes: %lu written, %lu within deadband (total %lu/%lu, %lu report frames sent, %lu suppressed)",
+                (unsigned long)(publish_stats.written - written_before),
+                (unsigned long)(publish_stats.skipped - skipped_before),
+                (unsigned long)publish_stats.written,
+                (unsigned long)publish_stats.skipped,
+                (unsigned long)publish_stats.report_frames,
+                (unsigned long)publish_stats.reports_suppressed);
+  APP_LOG_DEBUG("Wakes: %lu sensor timer, %lu poll, %lu sample(s) on poll (%lu saved, %lu deferred, %lu fallback)",
+                (unsigned long)wake_stats.timer_wakes,
+                (unsigned long)wake_stats.polls,
+                (unsigned long)wake_stats.coalesced,
+                (unsigned long)wake_stats.wakes_saved,
+                (unsigned long)wake_stats.deferred,
+                (unsigned long)wake_stats.poll_missed);
+#if (APP_LOG_LEVEL >= APP_LOG_LEVEL_DEBUG)
+  app_sched_stats_t sched;
+  app_sched_get_stats(&sched);
+  APP_LOG_DEBUG("Sched: %lu timer wake(s), %lu task(s) run, %lu wake(s) saved by slack",
+                (unsigned long)sched.timer_wakes,
+                (unsigned long)sched.tasks_run,
+                (unsigned long)sched.wakes_saved);
+#endif
+
+  app_sensor_adapt_interval(sample);
+
   // Trigger attribute reporting (if configured by coordinator)
   // The reporting mechanism will automatically send reports if bound
-  sensor_last_update_ms = now_ms;
-  emberAfCorePrintln("Sensor/battery attribute update complete");
+  sensor_updated = true;
+  sensor_last_update_tick = sl_sleeptimer_get_tick_count();
+  APP_LOG_DEBUG("Sensor/battery attribute update complete");
+}
+
+#if (APP_SENSOR_PROFILE != APP_SENSOR_PROFILE_SHT31)
+static bool app_sensor_fetch_bme280(app_sensor_sample_t *sample)
+{
+  bme280_data_t bme_data;
+
+  if (!bme280_fetch_data(&bme_data)) {
+    return false;
+  }
+  sample->valid = true;
+  sample->temperature = bme_data.temperature;
+  sample->humidity = (int32_t)bme_data.humidity;
+  sample->pressure = (int32_t)bme_data.pressure;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_BMP280)
+  sample->has_humidity = false;
+#else
+  sample->has_humidity = bme280_has_humidity();
+#endif
+  sample->has_pressure = true;
+  return true;
+}
+#endif
+
+void app_sensor_update(void)
+{
+  app_sensor_sample_t sample = { 0 };
+
+  if (sensor_measurement_pending) {
+    APP_LOG_DEBUG("Sensor measurement already in progress");
+    return;
+  }
+
+  if (sample_waiting_for_battery) {
+    APP_LOG_DEBUG("Battery measurement still in progress");
+    return;
+  }
+
+#if APP_DEBUG_I2C_STATS
+  hal_i2c_reset_stats();
+#endif
+
+  if (app_sensor_battery_due_for_sample()) {
+    app_sensor_start_battery(true);
+  }
+
+  // Conversion runs while the MCU sleeps; app_sensor_process() publishes
+  // the result once the conversion timer expires.
+  if (sensor_ready) {
+#if (APP_SENSOR_MEDIAN_N > 1)
+    sensor_burst_count = 0;
+    sensor_burst_reads = 0;
+#endif
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+    if (sht31_start_measurement()) {
+      sensor_measurement_pending = true;
+      return;
+    }
+    APP_LOG_ERROR("Error: Failed to start SHT31 measurement");
+#else
+    if (bme280_start_measurement()) {
+      sensor_measurement_pending = true;
+      return;
+    }
+    APP_LOG_ERROR("Error: Failed to start BME280/BMP280 measurement");
+#endif
+  }
+
+  app_sensor_publish(&sample);
+}
+
+#if (APP_SENSOR_MEDIAN_N > 1)
+// Start the next conversion of a median burst
+static bool app_sensor_start_burst_read(void)
+{
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  // Periodic mode has one new sample per period, so a burst would only
+  // repeat it.
+  return !sht31_is_periodic() && !sensor_reconfigure_pending && sht31_start_measurement();
+#else
+  return bme280_start_measurement();
+#endif
+}
+#endif
+
+static void app_sensor_finish_measurement(void)
+{
+  app_sensor_sample_t sample = { 0 };
+
+  sensor_measurement_pending = false;
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  sht31_data_t sht_data;
+
+  if (sht31_fetch_data(&sht_data)) {
+    sample.valid = true;
+    sample.has_humidity = true;
+    sample.has_pressure = false;
+    sample.temperature = sht_data.temperature;
+    sample.humidity = (int32_t)sht_data.humidity;
+  } else {
+    APP_LOG_ERROR("Error: Failed to read SHT31 data");
+  }
+#else
+  if (!app_sensor_fetch_bme280(&sample)) {
+    APP_LOG_ERROR("Error: Failed to read BME280/BMP280 data");
+  }
+#endif
+
+#if (APP_SENSOR_MEDIAN_N > 1)
+  // Burst: start the next conversion and sleep again until
+  // APP_SENSOR_MEDIAN_N reads are in.
+  if (sample.valid) {
+    sensor_burst[sensor_burst_count++] = sample;
+  }
+  sensor_burst_reads++;
+  if (sensor_burst_reads < APP_SENSOR_MEDIAN_N && app_sensor_start_burst_read()) {
+    filter_stats.burst_reads++;
+    sensor_measurement_pending = true;
+    return;
+  }
+  if (sensor_burst_count > 0) {
+    app_sensor_median_sample(sensor_burst, sensor_burst_count, &sample);
+  }
+#endif
+
+  app_sensor_publish(&sample);
+
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  if (sensor_reconfigure_pending) {
+    sensor_reconfigure_pending = false;
+    app_sensor_configure_sht31();
+  }
+#endif
+}
+
+bool app_sensor_set_sht31_mode(uint8_t mode)
+{
+#if (APP_SENSOR_PROFILE == APP_SENSOR_PROFILE_SHT31)
+  sht31_repeatability_t repeatability =
+    (sht31_repeatability_t)(mode & APP_SHT31_MODE_REPEATABILITY_MASK);
+  bool clock_stretch = (mode & APP_SHT31_MODE_CLOCK_STRETCH) != 0u;
+
+  if (!sensor_ready || !sht31_set_measurement_mode(repeatability, clock_stretch)) {
+    return false;
+  }
+  APP_LOG_INFO("SHT31 mode: repeatability=%d stretch=%d conversion<=%lu ms",
+               (int)repeatability,
+               clock_stretch ? 1 : 0,
+               (unsigned long)sht31_get_conversion_time_ms());
+
+  // Repeatability changes the single-shot vs periodic energy balance
+  if (sensor_measurement_pending) {
+    sensor_reconfigure_pending = true;
+  } else {
+    app_sensor_configure_sht31();
+  }
+  return true;
+#else
+  (void)mode;
+  return false;
+#endif
 }
 
 bool app_sensor_is_ready(void)
@@ -532,7 +1677,21 @@ bool app_sensor_is_timer_running(void)
   return sensor_timer_running;
 }
 
-uint32_t app_sensor_get_last_update_ms(void)
+uint32_t app_sensor_get_update_age_ms(void)
 {
-  return sensor_last_update_ms;
+  return sensor_updated ? app_ms_since(sensor_last_update_tick) : 0u;
+}
+
+void app_sensor_get_publish_stats(app_sensor_publish_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = publish_stats;
+  }
+}
+
+void app_sensor_get_filter_stats(app_sensor_filter_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = filter_stats;
+  }
 }
@@ -36,6 +36,9 @@ bool app_sensor_init(void);
  *
  * This function should be called from the main event loop or
  * registered with the Zigbee event system.
+ *
+ * SHT31: only starts the conversion; attributes are written from
+ * app_sensor_process() once the conversion timer expires.
  */
 void app_sensor_update(void);
 
@@ -66,11 +69,22 @@ void app_sensor_stop_periodic_updates(void);
  */
 void app_sensor_set_interval(uint32_t interval_ms);
 
+/**
+ * @brief Apply SHT31 repeatability / clock-stretching mode
+ *
+ * Only meaningful for the SHT31 profile; takes effect from the next
+ * measurement.
+ *
+ * @param mode APP_SHT31_MODE_* encoding (see app_config.h)
+ * @return true if applied, false on other profiles or driver error
+ */
+bool app_sensor_set_sht31_mode(uint8_t mode);
+
 /**
  * @brief Process deferred sensor timer work in main context.
  *
- * Called from the main loop. Executes pending periodic sensor updates
- * scheduled by sleeptimer callback (which runs in interrupt context).
+ * Called from the main loop after app_sched_process(). Executes pending
+ * periodic sensor updates flagged by the sensor timer task or a poll.
  */
 void app_sensor_process(void);
 
@@ -89,10 +103,143 @@ bool app_sensor_is_ready(void);
 bool app_sensor_is_timer_running(void);
 
 /**
- * @brief Get uptime timestamp (ms) of last successful sensor/battery update.
+ * @brief Get the time since the last completed sensor/battery update.
+ *
+ * @return Milliseconds since app_sensor_update() last completed, or 0 if it
+ *         has not completed since app_sensor_init().
+ */
+uint32_t app_sensor_get_update_age_ms(void);
+
+/**
+ * @brief Configure the adaptive sampling interval
+ *
+ * While temperature, humidity and pressure are stable the timer period grows
+ * by aggressiveness/8 per sample up to max_seconds; a fast change drops it to
+ * min_seconds. The configured interval is the starting point.
+ *
+ * @param min_seconds Shortest period
+ * @param max_seconds Longest period (ignored call if below min_seconds)
+ * @param aggressiveness 0 = fixed interval, 1..8 growth step
+ */
+void app_sensor_set_adaptive_interval(uint16_t min_seconds,
+                                      uint16_t max_seconds,
+                                      uint8_t aggressiveness);
+
+/**
+ * @brief Current sensor timer period
  *
- * @return Milliseconds since boot when app_sensor_update() last completed.
+ * @return Milliseconds between samples, after adaptation
+ */
+uint32_t app_sensor_get_interval_ms(void);
+
+/**
+ * @brief Select the battery chemistry for BatteryPercentageRemaining
+ *
+ * Restarts the percentage filter and measures with the next sample.
+ *
+ * @param chemistry battery_chemistry_t value (0 alkaline, 1 NiMH, 2 lithium)
+ */
+void app_sensor_set_battery_chemistry(uint8_t chemistry);
+
+/**
+ * @brief Notify that an end-device data poll completed
+ *
+ * Main context (poll-completed callback). A sample due within
+ * APP_WAKE_COALESCE_SLACK_MS is taken on this wake and the sensor timer is
+ * re-phased to the poll.
+ *
+ * @param interval_ms Current poll interval, used to predict the next poll
+ */
+void app_sensor_note_poll(uint32_t interval_ms);
+
+/**
+ * @brief Sensor/poll wake counters since boot
+ */
+typedef struct {
+  uint32_t timer_wakes;  // Sensor timer expiries
+  uint32_t polls;        // Data polls completed
+  uint32_t coalesced;    // Samples taken on a poll wake
+  uint32_t wakes_saved;  // ... that pulled the sample forward (timer wake dropped)
+  uint32_t deferred;     // Timer expiries held for a poll within the slack
+  uint32_t poll_missed;  // Deferred samples taken by the fallback timer
+} app_sensor_wake_stats_t;
+
+/**
+ * @brief Snapshot the sensor/poll wake counters
+ * @param stats Output
+ */
+void app_sensor_get_wake_stats(app_sensor_wake_stats_t *stats);
+
+/**
+ * @brief Notify that a frame was transmitted
+ *
+ * With APP_BATTERY_AFTER_TX, a due battery measurement starts here so it
+ * sees the battery right after the TX load; the result is published from
+ * app_sensor_process().
+ */
+void app_sensor_note_radio_tx(void);
+
+/**
+ * @brief Attribute write counters of the deadband shadow cache
+ */
+typedef struct {
+  uint32_t written;        // ZCL writes + reporting notifications issued
+  uint32_t skipped;        // Values within the deadband of the last written one
+  uint32_t report_frames;  // Report Attributes frames sent from the sensor endpoint
+  uint32_t reports_suppressed;  // Standard reports dropped for the bundle (APP_REPORT_BUNDLE)
+} app_sensor_publish_stats_t;
+
+/**
+ * @brief Snapshot the attribute write counters since boot
+ * @param stats Output
+ */
+void app_sensor_get_publish_stats(app_sensor_publish_stats_t *stats);
+
+/**
+ * @brief Check whether an outgoing frame is a standard report the bundle replaces
+ *
+ * Called before every APS send. With APP_REPORT_BUNDLE, Report Attributes
+ * frames of the measured clusters are dropped; always false otherwise.
+ *
+ * @param source_endpoint APS source endpoint
+ * @param cluster_id APS cluster
+ * @param message ZCL frame
+ * @param msg_len ZCL frame length
+ * @return true to drop the frame
+ */
+bool app_sensor_suppress_report(uint8_t source_endpoint,
+                                uint16_t cluster_id,
+                                const uint8_t *message,
+                                uint16_t msg_len);
+
+/**
+ * @brief Count a sent frame if it is a report from the sensor endpoint
+ *
+ * Called once per APS message when the stack has finished with it.
+ *
+ * @param source_endpoint APS source endpoint
+ * @param message ZCL frame
+ * @param msg_len ZCL frame length
+ */
+void app_sensor_note_message_sent(uint8_t source_endpoint,
+                                  const uint8_t *message,
+                                  uint16_t msg_len);
+
+/**
+ * @brief Sample filter counters (median burst, range and outlier rejection)
+ */
+typedef struct {
+  uint32_t samples;         // Valid samples checked by the filter
+  uint32_t burst_reads;     // Extra sensor reads for median bursts
+  uint32_t rejected_range;  // Outside the sensor output range
+  uint32_t rejected_delta;  // Implausible jump from the last accepted sample
+  uint32_t forced_accepts;  // Jumps accepted after APP_SENSOR_REJECT_MAX in a row
+} app_sensor_filter_stats_t;
+
+/**
+ * @brief Snapshot the sample filter counters since boot
+ * @param stats Output
  */
-uint32_t app_sensor_get_last_update_ms(void);
+void app_sensor_get_filter_stats(app_sensor_filter_stats_t *stats);
 
 #endif // APP_SENSOR_H
@@ -3,17 +3,33 @@
  * @brief Battery voltage measurement for EFR32MG1P
  *
  * Measures battery voltage using internal ADC and VDD channel.
- * Configured for 2xAAA battery pack (nominal 3.0V).
+ * Configured for 2xAAA battery pack (nominal 3.0V); state of charge comes
+ * from per-chemistry discharge curves, cross-checked against a coulomb
+ * count when the application provides one. The four conversions of
+ * a measurement are chained from the ADC interrupt; the ADC is clocked only
+ * while a measurement runs.
  */
 
 #include "battery.h"
 #include "em_adc.h"
 #include "em_cmu.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "sl_component_catalog.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+#include <stddef.h>
+
+// Pack voltage used until the first good measurement (2x 1.5V nominal)
+#define BATTERY_VOLTAGE_NOMINAL_MV  3000
 
-// Battery voltage thresholds for 2xAAA alkaline (in mV)
-#define BATTERY_VOLTAGE_FULL_MV     3200  // 2x 1.6V fresh alkaline
-#define BATTERY_VOLTAGE_NOMINAL_MV  3000  // 2x 1.5V nominal
-#define BATTERY_VOLTAGE_EMPTY_MV    1800  // 2x 0.9V depleted
+// Cells in series (2xAAA)
+#define BATTERY_CELLS               2
+
+// Cold compensation: applied below the reference, clamped at the limit (0.01 C)
+#define BATTERY_TEMP_REFERENCE      2000
+#define BATTERY_TEMP_COMP_LIMIT     (-2000)
 
 // ADC reference voltage in mV defaults.
 #define ADC_REF_VOLTAGE_1V25_MV     1250
@@ -25,8 +41,62 @@
 // ADC sanity limits to reject obvious bad reads.
 #define BATTERY_MIN_VALID_MV        1200
 #define BATTERY_MAX_VALID_MV        3600
-#define BATTERY_ADC_WAIT_MAX_CYCLES 1000000u
 
+// Largest disagreement (0-200 scale) between the voltage curve and the
+// coulomb count before the count is re-anchored to the curve
+#ifndef BATTERY_COULOMB_TOLERANCE
+#define BATTERY_COULOMB_TOLERANCE   20
+#endif
+
+// Conversions averaged per measurement
+#define BATTERY_ADC_SAMPLES         4u
+
+// Deadline for the whole measurement (4 conversions take ~1.1 ms at 1 MHz)
+#ifndef BATTERY_ADC_TIMEOUT_MS
+#define BATTERY_ADC_TIMEOUT_MS      10u
+#endif
+
+// State-of-charge curve point: per-cell voltage under light load, 0-200 scale
+typedef struct {
+  uint16_t cell_mv;
+  uint8_t percent;
+} battery_soc_point_t;
+
+typedef struct {
+  const battery_soc_point_t *points;  // Descending voltage
+  uint8_t count;
+  uint16_t cold_uv_per_c;             // Per-cell sag per degree below reference
+  uint16_t capacity_mah;              // Nominal AAA capacity at sensor loads
+} battery_soc_curve_t;
+
+// Alkaline: sloped curve, most capacity between 1.45 and 1.15 V
+static const battery_soc_point_t soc_alkaline[] = {
+  { 1580, 200 }, { 1500, 180 }, { 1420, 140 }, { 1350, 100 }, { 1290, 70 },
+  { 1230, 40 }, { 1160, 20 }, { 1080, 8 }, { 1000, 2 }, { 900, 0 },
+};
+
+// NiMH: flat plateau around 1.2-1.25 V, sharp knee at the end
+static const battery_soc_point_t soc_nimh[] = {
+  { 1400, 200 }, { 1330, 190 }, { 1280, 170 }, { 1250, 140 }, { 1220, 100 },
+  { 1200, 70 }, { 1170, 40 }, { 1130, 20 }, { 1080, 8 }, { 1000, 0 },
+};
+
+// Lithium primary: flat near 1.5-1.6 V almost to the end
+static const battery_soc_point_t soc_lithium[] = {
+  { 1750, 200 }, { 1650, 190 }, { 1550, 150 }, { 1500, 100 }, { 1450, 60 },
+  { 1400, 30 }, { 1300, 10 }, { 1200, 3 }, { 1000, 0 },
+};
+
+#define SOC_CURVE(points, cold_uv, mah) { points, (uint8_t)(sizeof(points) / sizeof(points[0])), cold_uv, mah }
+
+// Indexed by battery_chemistry_t
+static const battery_soc_curve_t soc_curves[BATTERY_CHEMISTRY_COUNT] = {
+  SOC_CURVE(soc_alkaline, 2500, 1000),
+  SOC_CURVE(soc_nimh, 1000, 800),
+  SOC_CURVE(soc_lithium, 1000, 1200),
+};
+
+static battery_chemistry_t battery_chemistry = BATTERY_CHEMISTRY_ALKALINE;
 static bool battery_adc_ready = false;
 static uint16_t battery_last_raw_adc = 0;
 static bool battery_last_valid = false;
@@ -34,12 +104,35 @@ static uint16_t battery_last_good_mv = BATTERY_VOLTAGE_NOMINAL_MV;
 static uint16_t battery_ref_mv = ADC_REF_VOLTAGE_1V25_MV;
 static uint8_t battery_scale_factor = AVDD_SCALE_FACTOR;
 
-/**
- * @brief Initialize battery voltage measurement
- */
-bool battery_init(void)
+// Coulomb-count cross-check: charge used since boot, and the point where the
+// count was last aligned with the voltage curve
+static bool coulomb_known = false;
+static uint32_t coulomb_used_uah = 0;
+static bool coulomb_anchored = false;
+static uint8_t coulomb_anchor_percent = 0;
+static uint32_t coulomb_anchor_uah = 0;
+static uint32_t coulomb_reanchors = 0;
+
+// Measurement state shared with ADC0_IRQHandler and the deadline timer
+static bool measurement_active = false;
+static volatile bool measurement_done = false;
+static volatile bool measurement_failed = false;
+static volatile uint8_t sample_count = 0;
+static volatile uint32_t sample_sum = 0;
+static volatile uint32_t conversion_count = 0;
+static sl_sleeptimer_timer_handle_t deadline_timer;
+
+#if defined(_ADC_SINGLECTRL_REF_5V)
+// On some MG1 boards AVDD measurement saturates with 1.25V ref.
+// Prefer 5V ref when available to keep measurement in range.
+#define BATTERY_ADC_REFERENCE adcRef5V
+#else
+#define BATTERY_ADC_REFERENCE adcRef1V25
+#endif
+
+// Clock the ADC and configure it for one AVDD conversion per start
+static void adc_power_up(void)
 {
-  // Enable ADC clock
   CMU_ClockEnable(cmuClock_ADC0, true);
 
   // Initialize ADC for single conversion
@@ -50,56 +143,143 @@ bool battery_init(void)
 
   // Configure for single-ended mode
   ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
-  // On some MG1 boards AVDD measurement saturates with 1.25V ref.
-  // Prefer 5V ref when available to keep measurement in range.
+  initSingle.reference = BATTERY_ADC_REFERENCE;
+  initSingle.posSel = adcPosSelAVDD;        // VDD measurement (AVDD channel)
+  initSingle.resolution = adcRes12Bit;      // 12-bit resolution
+  initSingle.acqTime = adcAcqTime256;       // Longer acquisition for accuracy
+  ADC_InitSingle(ADC0, &initSingle);
+
+  ADC_IntClear(ADC0, ADC_IF_SINGLE);
+  ADC_IntEnable(ADC0, ADC_IEN_SINGLE);
+  NVIC_ClearPendingIRQ(ADC0_IRQn);
+  NVIC_EnableIRQ(ADC0_IRQn);
+}
+
+// Return the ADC to reset state and gate its clock (interrupt context safe)
+static void adc_power_down(void)
+{
+  NVIC_DisableIRQ(ADC0_IRQn);
+  ADC_IntDisable(ADC0, ADC_IEN_SINGLE);
+  ADC_Reset(ADC0);
+  CMU_ClockEnable(cmuClock_ADC0, false);
+  NVIC_ClearPendingIRQ(ADC0_IRQn);
+}
+
+// End of measurement, from the ADC or deadline interrupt
+static void finish_measurement(bool failed)
+{
+  adc_power_down();
+  measurement_failed = failed;
+  measurement_done = true;
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+}
+
+void ADC0_IRQHandler(void)
+{
+  ADC_IntClear(ADC0, ADC_IF_SINGLE);
+  if (measurement_done) {
+    return;
+  }
+
+  sample_sum += ADC_DataSingleGet(ADC0) & 0x0FFFu;
+  sample_count++;
+  conversion_count++;
+  if (sample_count < BATTERY_ADC_SAMPLES) {
+    ADC_Start(ADC0, adcStartSingle);
+    return;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (!measurement_done) {
+    (void)sl_sleeptimer_stop_timer(&deadline_timer);
+    finish_measurement(false);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+static void deadline_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (!measurement_done) {
+    finish_measurement(true);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/**
+ * @brief Initialize battery voltage measurement
+ */
+bool battery_init(void)
+{
+  // The ADC itself stays unclocked until a measurement starts
 #if defined(_ADC_SINGLECTRL_REF_5V)
-  initSingle.reference = adcRef5V;
   battery_ref_mv = ADC_REF_VOLTAGE_5V_MV;
   battery_scale_factor = 1;
 #else
-  initSingle.reference = adcRef1V25;        // 1.25V internal reference
-  battery_ref_mv = ADC_REF_VOLTAGE_1V25_MV;
+  battery_ref_mv = ADC_REF_VOLTAGE_1V25_MV;   // 1.25V internal reference
   battery_scale_factor = AVDD_SCALE_FACTOR;
 #endif
-  initSingle.posSel = adcPosSelAVDD;        // VDD measurement (AVDD channel)
-  initSingle.resolution = adcRes12Bit;      // 12-bit resolution
-  initSingle.acqTime = adcAcqTime256;       // Longer acquisition for accuracy
-  ADC_InitSingle(ADC0, &initSingle);
 
   battery_adc_ready = true;
   return true;
 }
 
-/**
- * @brief Read battery voltage in millivolts
- */
-uint16_t battery_read_voltage_mv(void)
+bool battery_start_measurement(void)
+{
+  if (!battery_adc_ready || measurement_active) {
+    return false;
+  }
+
+  measurement_done = false;
+  measurement_failed = false;
+  sample_count = 0;
+  sample_sum = 0;
+
+  if (sl_sleeptimer_start_timer_ms(&deadline_timer,
+                                   BATTERY_ADC_TIMEOUT_MS,
+                                   deadline_timer_callback,
+                                   NULL,
+                                   0,
+                                   0) != SL_STATUS_OK) {
+    return false;
+  }
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  // HFPERCLK, and with it the ADC, stops in EM2
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+  measurement_active = true;
+  adc_power_up();
+  ADC_Start(ADC0, adcStartSingle);
+  return true;
+}
+
+bool battery_measurement_ready(void)
+{
+  return measurement_active && measurement_done;
+}
+
+uint16_t battery_fetch_voltage_mv(void)
 {
-  if (!battery_adc_ready) {
+  if (!battery_measurement_ready()) {
     battery_last_valid = false;
     return battery_last_good_mv;
   }
+  measurement_active = false;
 
-  // Average several samples and wait on conversion-complete flag
-  // to avoid stale zero reads on some MG1 boards.
-  uint32_t sum = 0;
-  const uint8_t samples = 4;
-  for (uint8_t i = 0; i < samples; i++) {
-    ADC_IntClear(ADC0, ADC_IF_SINGLE);
-    ADC_Start(ADC0, adcStartSingle);
-    uint32_t wait_cycles = BATTERY_ADC_WAIT_MAX_CYCLES;
-    while ((ADC_IntGet(ADC0) & ADC_IF_SINGLE) == 0u && wait_cycles > 0u) {
-      // wait
-      wait_cycles--;
-    }
-    if (wait_cycles == 0u) {
-      battery_last_valid = false;
-      return battery_last_good_mv;
-    }
-    sum += ADC_DataSingleGet(ADC0) & 0x0FFFu;
+  if (measurement_failed) {
+    battery_last_valid = false;
+    return battery_last_good_mv;
   }
 
-  uint32_t adc_value = sum / samples;
+  uint32_t adc_value = sample_sum / BATTERY_ADC_SAMPLES;
   battery_last_raw_adc = (uint16_t)adc_value;
 
   // Calculate voltage in mV
@@ -116,50 +296,117 @@ uint16_t battery_read_voltage_mv(void)
   return battery_last_good_mv;
 }
 
-/**
- * @brief Read battery voltage in 100mV units (for Zigbee attribute)
- */
-uint8_t battery_read_voltage_100mv(void)
+uint16_t battery_get_last_raw_adc(void)
+{
+  return battery_last_raw_adc;
+}
+
+bool battery_last_measurement_valid(void)
+{
+  return battery_last_valid;
+}
+
+uint32_t battery_get_conversion_count(void)
 {
-  uint16_t voltage_mv = battery_read_voltage_mv();
+  return conversion_count;
+}
 
-  // Convert to 100mV units (e.g., 3000mV -> 30)
-  uint8_t voltage_100mv = (uint8_t)(voltage_mv / 100);
+void battery_set_chemistry(battery_chemistry_t chemistry)
+{
+  battery_chemistry = (chemistry < BATTERY_CHEMISTRY_COUNT) ? chemistry : BATTERY_CHEMISTRY_ALKALINE;
+  // Other curve and capacity: align the count again on the next estimate
+  coulomb_anchored = false;
+}
 
-  return voltage_100mv;
+uint16_t battery_get_capacity_mah(void)
+{
+  return soc_curves[battery_chemistry].capacity_mah;
 }
 
-uint16_t battery_get_last_raw_adc(void)
+void battery_set_charge_used_uah(uint32_t used_uah)
 {
-  return battery_last_raw_adc;
+  coulomb_used_uah = used_uah;
+  coulomb_known = true;
 }
 
-bool battery_last_measurement_valid(void)
+uint32_t battery_get_coulomb_reanchor_count(void)
 {
-  return battery_last_valid;
+  return coulomb_reanchors;
+}
+
+battery_chemistry_t battery_get_chemistry(void)
+{
+  return battery_chemistry;
+}
+
+/**
+ * Piecewise-linear lookup in the per-cell curve of the selected chemistry,
+ * after cold compensation. Returns 0-200 value (0.5% resolution per Zigbee spec).
+ */
+static uint8_t battery_voltage_percentage(uint16_t voltage_mv, int32_t temperature)
+{
+  const battery_soc_curve_t *curve = &soc_curves[battery_chemistry];
+  int32_t cell_mv = (int32_t)voltage_mv / BATTERY_CELLS;
+
+  // Cold cells sag: read them as they would at the reference temperature
+  if (temperature != BATTERY_TEMPERATURE_UNKNOWN && temperature < BATTERY_TEMP_REFERENCE) {
+    if (temperature < BATTERY_TEMP_COMP_LIMIT) {
+      temperature = BATTERY_TEMP_COMP_LIMIT;
+    }
+    cell_mv += ((BATTERY_TEMP_REFERENCE - temperature) * curve->cold_uv_per_c) / 100000;
+  }
+
+  // Clamp to valid range
+  if (cell_mv >= curve->points[0].cell_mv) {
+    return curve->points[0].percent;
+  }
+  for (uint8_t i = 1; i < curve->count; i++) {
+    const battery_soc_point_t *hi = &curve->points[i - 1];
+    const battery_soc_point_t *lo = &curve->points[i];
+    if (cell_mv >= lo->cell_mv) {
+      // Linear interpolation between the two surrounding points
+      return (uint8_t)(lo->percent
+                       + ((cell_mv - lo->cell_mv) * (hi->percent - lo->percent))
+                       / (hi->cell_mv - lo->cell_mv));
+    }
+  }
+  return curve->points[curve->count - 1].percent;
 }
 
 /**
  * @brief Calculate battery percentage remaining
  *
- * Uses linear interpolation between empty and full voltage.
- * Returns 0-200 value (0.5% resolution per Zigbee spec).
+ * Voltage curve estimate; with a coulomb count, the count taken from the
+ * last anchor while the two agree.
  */
-uint8_t battery_calculate_percentage(uint16_t voltage_mv)
+uint8_t battery_calculate_percentage(uint16_t voltage_mv, int32_t temperature)
 {
-  // Clamp to valid range
-  if (voltage_mv >= BATTERY_VOLTAGE_FULL_MV) {
-    return 200; // 100%
+  uint8_t percent = battery_voltage_percentage(voltage_mv, temperature);
+
+  if (!coulomb_known) {
+    return percent;
   }
-  if (voltage_mv <= BATTERY_VOLTAGE_EMPTY_MV) {
-    return 0; // 0%
+  if (!coulomb_anchored) {
+    coulomb_anchor_percent = percent;
+    coulomb_anchor_uah = coulomb_used_uah;
+    coulomb_anchored = true;
+    return percent;
   }
 
-  // Linear interpolation between empty and full
-  // percentage = (current - empty) / (full - empty) * 200
-  uint32_t voltage_range = BATTERY_VOLTAGE_FULL_MV - BATTERY_VOLTAGE_EMPTY_MV;
-  uint32_t voltage_above_empty = voltage_mv - BATTERY_VOLTAGE_EMPTY_MV;
-  uint32_t percentage = (voltage_above_empty * 200) / voltage_range;
+  // Charge drawn since the anchor, on the 0-200 scale of the pack capacity
+  uint32_t capacity_uah = (uint32_t)soc_curves[battery_chemistry].capacity_mah * 1000u;
+  uint32_t used = coulomb_used_uah - coulomb_anchor_uah;
+  uint32_t drawn = (uint32_t)(((uint64_t)used * 200u) / capacity_uah);
+  uint8_t counted = (drawn >= coulomb_anchor_percent) ? 0u
+                    : (uint8_t)(coulomb_anchor_percent - drawn);
 
-  return (uint8_t)percentage;
+  int32_t diff = (int32_t)percent - (int32_t)counted;
+  if (diff > BATTERY_COULOMB_TOLERANCE || diff < -BATTERY_COULOMB_TOLERANCE) {
+    // Model drift or a curve that does not fit the cells: trust the voltage
+    coulomb_anchor_percent = percent;
+    coulomb_anchor_uah = coulomb_used_uah;
+    coulomb_reanchors++;
+    return percent;
+  }
+  return counted;
 }
@@ -12,33 +12,53 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/**
+ * @brief Cell chemistry of the 2-cell pack (selects the state-of-charge curve)
+ */
+typedef enum {
+  BATTERY_CHEMISTRY_ALKALINE = 0,
+  BATTERY_CHEMISTRY_NIMH = 1,
+  BATTERY_CHEMISTRY_LITHIUM = 2,  // 1.5 V lithium primary (Li-FeS2)
+  BATTERY_CHEMISTRY_COUNT
+} battery_chemistry_t;
+
+// Pass as temperature when no measurement is available
+#define BATTERY_TEMPERATURE_UNKNOWN INT32_MIN
+
 /**
  * @brief Initialize battery voltage measurement
  *
- * Initializes the ADC for measuring VDD (supply voltage).
+ * Prepares measuring VDD (supply voltage). The ADC stays unclocked until a
+ * measurement starts and is shut down again when it completes.
  *
  * @return true if initialization successful, false otherwise
  */
 bool battery_init(void);
 
 /**
- * @brief Read battery voltage
+ * @brief Start an interrupt-driven measurement
  *
- * Measures the current battery voltage using internal ADC.
+ * Returns immediately. The ADC is clocked and converts from its interrupt
+ * until battery_measurement_ready(); EM1 is held meanwhile when the power
+ * manager is present.
  *
- * @return Battery voltage in millivolts (mV), or 0 on error
+ * @return true if started, false if not initialized or already running
  */
-uint16_t battery_read_voltage_mv(void);
+bool battery_start_measurement(void);
 
 /**
- * @brief Read battery voltage in 100mV units
- *
- * Measures battery voltage and returns it in 100mV units
- * as required by Zigbee Power Configuration Cluster.
+ * @brief Check whether a started measurement has finished
+ * @return true when battery_fetch_voltage_mv() can be called
+ */
+bool battery_measurement_ready(void);
+
+/**
+ * @brief Collect the result of the started measurement
  *
- * @return Battery voltage in 100mV units (e.g., 30 = 3.0V), or 0 on error
+ * @return Battery voltage in millivolts (mV); the last good value when the
+ *         measurement failed or is not ready (see battery_last_measurement_valid)
  */
-uint8_t battery_read_voltage_100mv(void);
+uint16_t battery_fetch_voltage_mv(void);
 
 /**
  * @brief Get last averaged raw ADC sample used for battery conversion.
@@ -54,20 +74,63 @@ uint16_t battery_get_last_raw_adc(void);
  */
 bool battery_last_measurement_valid(void);
 
+/**
+ * @brief ADC conversions run since boot (energy accounting)
+ * @return Conversion count
+ */
+uint32_t battery_get_conversion_count(void);
+
+/**
+ * @brief Select the state-of-charge curve
+ * @param chemistry Pack chemistry (out-of-range values select alkaline)
+ */
+void battery_set_chemistry(battery_chemistry_t chemistry);
+
+/**
+ * @brief Currently selected chemistry
+ */
+battery_chemistry_t battery_get_chemistry(void);
+
+/**
+ * @brief Nominal capacity of the pack for the selected chemistry
+ * @return Capacity in mAh
+ */
+uint16_t battery_get_capacity_mah(void);
+
+/**
+ * @brief Report the charge drawn since boot (coulomb count)
+ *
+ * Enables the cross-check in battery_calculate_percentage().
+ *
+ * @param used_uah Charge used since boot in uAh
+ */
+void battery_set_charge_used_uah(uint32_t used_uah);
+
+/**
+ * @brief Times the coulomb count disagreed with the voltage curve and was
+ *        re-aligned to it
+ */
+uint32_t battery_get_coulomb_reanchor_count(void);
+
 /**
  * @brief Calculate battery percentage remaining
  *
- * Calculates battery percentage based on voltage curve for 2xAAA batteries.
- * Uses 0-200 scale with 0.5% resolution as per Zigbee spec.
+ * Interpolates the per-cell discharge curve of the selected chemistry
+ * (piecewise linear, 2 cells in series). Below 20 C the voltage is first
+ * raised by the chemistry's cold sag coefficient, so a cold pack is not
+ * reported as empty. Uses 0-200 scale with 0.5% resolution as per Zigbee spec.
  *
- * Voltage thresholds for 2xAAA (alkaline):
- * - Full: 3.2V (2x 1.6V fresh)
- * - Nominal: 3.0V (2x 1.5V)
- * - Empty: 1.8V (2x 0.9V depleted)
+ * Once battery_set_charge_used_uah() has been called, the first estimate
+ * anchors the coulomb count. Later calls return the anchor minus the charge
+ * drawn since then, as long as it stays within BATTERY_COULOMB_TOLERANCE of
+ * the voltage curve; otherwise the curve value is returned and becomes the
+ * new anchor. This keeps the flat parts of the NiMH and lithium curves from
+ * moving the estimate on a few mV of noise.
  *
  * @param voltage_mv Battery voltage in millivolts
+ * @param temperature Pack temperature in 0.01 C, or BATTERY_TEMPERATURE_UNKNOWN
  * @return Battery percentage (0-200, where 200 = 100%, 100 = 50%, 0 = 0%)
  */
-uint8_t battery_calculate_percentage(uint16_t voltage_mv);
+uint8_t battery_calculate_percentage(uint16_t voltage_mv, int32_t temperature);
 
 #endif // BATTERY_H
@@ -7,14 +7,85 @@
 
 #include "bme280_min.h"
 #include "hal_i2c.h"
+#include "sensor_cache.h"
 #include "bme280_board_config.h"
+#include "sl_sleeptimer.h"
 #include <string.h>
 
+// Use forced mode (one conversion per read) instead of continuous normal mode.
+#ifndef BME280_USE_FORCED_MODE
+#define BME280_USE_FORCED_MODE 1
+#endif
+
+// Oversampling settings (BME280_OSRS_* encoding)
+#ifndef BME280_OSRS_T
+#define BME280_OSRS_T BME280_OSRS_X1
+#endif
+#ifndef BME280_OSRS_P
+#define BME280_OSRS_P BME280_OSRS_X1
+#endif
+#ifndef BME280_OSRS_H
+#define BME280_OSRS_H BME280_OSRS_X1
+#endif
+
+// Re-read the calibration on the first sample after a warm boot and refresh
+// the cache if it differs. Set to 0 to trust the chip-ID check alone.
+#ifndef BME280_CACHE_VERIFY
+#define BME280_CACHE_VERIFY 1
+#endif
+
+// Consecutive failed samples on cached calibration before the warm-boot
+// record is dropped. A chip-ID mismatch drops it at once.
+#ifndef BME280_CACHE_MAX_FAILURES
+#define BME280_CACHE_MAX_FAILURES 3
+#endif
+
+// Extra 1 ms status polls if the chip is still converting after t_meas,max.
+#define BME280_FORCED_MAX_EXTRA_POLLS 3
+
+// Datasheet typical currents (uA) used by the energy estimate.
+#define BME280_IDD_TEMPERATURE_UA   350u
+#define BME280_IDD_PRESSURE_UA      714u
+#define BME280_IDD_HUMIDITY_UA      340u
+#define BME280_IDD_SLEEP_NA         100u
+#define BME280_IDD_STANDBY_NA       200u
+#define BME280_NORMAL_STANDBY_MS    1000u
+
+#define BME280_CTRL_MEAS(mode) \
+  ((uint8_t)((BME280_OSRS_T << 5) | (BME280_OSRS_P << 2) | (mode)))
+
+// Raw calibration block: 26 bytes at 0x88 followed by 7 bytes at 0xE1
+#define BME280_CALIB_00_LEN   26u
+#define BME280_CALIB_26_LEN   7u
+#define BME280_CALIB_RAW_LEN  (BME280_CALIB_00_LEN + BME280_CALIB_26_LEN)
+
+// Soft reset to NVM copy complete (datasheet t_startup 2 ms)
+#define BME280_RESET_TIME_MS  2u
+
+// Warm-boot record in sensor_cache
+typedef struct {
+  uint8_t chip_id;
+  uint8_t addr;
+  uint8_t calib[BME280_CALIB_RAW_LEN];
+} bme280_cache_t;
+
 static bme280_calib_data_t calib_data;
 static bool sensor_initialized = false;
+// Calibration came from sensor_cache and has not been re-read from this chip
+static bool calib_from_cache = false;
+static uint8_t cache_failures = 0;
 static bool sensor_has_humidity = false;
 static uint8_t sensor_chip_id = 0;
 
+// Non-blocking conversion state; conversion_done is set from the sleeptimer IRQ.
+static bool conversion_active = false;
+#if BME280_USE_FORCED_MODE
+static sl_sleeptimer_timer_handle_t conversion_timer;
+static volatile bool conversion_done = false;
+static uint8_t conversion_extra_polls = 0;
+static bool conversion_failed = false;
+#endif
+
 // Helper function to read register
 static bool read_register(uint8_t reg, uint8_t *data, uint16_t len)
 {
@@ -28,15 +99,157 @@ static bool write_register(uint8_t reg, uint8_t value)
   return hal_i2c_write(BME280_I2C_ADDR, data, 2);
 }
 
-// Read calibration data from sensor
-static bool read_calibration_data(bool include_humidity)
+#if (BME280_COMPENSATION_KERNEL < 0) || (BME280_COMPENSATION_KERNEL >= BME280_KERNEL_COUNT)
+#error "Invalid BME280_COMPENSATION_KERNEL"
+#endif
+
+// Build every kernel, not only the selected one (host tests)
+#ifndef BME280_BUILD_ALL_KERNELS
+#define BME280_BUILD_ALL_KERNELS 0
+#endif
+
+#define KERNEL_INT64_USED ((BME280_COMPENSATION_KERNEL == BME280_KERNEL_INT64) || BME280_BUILD_ALL_KERNELS)
+#define KERNEL_INT32_USED ((BME280_COMPENSATION_KERNEL == BME280_KERNEL_INT32) || BME280_BUILD_ALL_KERNELS)
+#define KERNEL_FLOAT_USED ((BME280_COMPENSATION_KERNEL == BME280_KERNEL_FLOAT) || BME280_BUILD_ALL_KERNELS)
+
+// Coefficients derived once from the calibration block: widened, pre-shifted
+// (or pre-scaled by powers of two for float) and listed in the order the
+// kernels consume them. Results are bit-identical to the datasheet formulas.
+typedef struct {
+  int32_t t_fine;
+
+  // Temperature
+  int32_t t1_x2;        // dig_T1 << 1
+  int32_t t2;
+  int32_t t1;
+  int32_t t3;
+
+#if KERNEL_INT64_USED
+  // Pressure, int64
+  int64_t p6;
+  int64_t p5_s17;       // dig_P5 << 17
+  int64_t p4_s35;       // dig_P4 << 35
+  int64_t p3;
+  int64_t p2_s12;       // dig_P2 << 12
+  int64_t p1;
+  int64_t p9;
+  int64_t p8;
+  int64_t p7_s4;        // dig_P7 << 4
+#endif
+
+#if KERNEL_INT32_USED
+  // Pressure, int32
+  int32_t p6_32;
+  int32_t p5_x2;        // dig_P5 * 2
+  int32_t p4_s16;       // dig_P4 << 16
+  int32_t p3_32;
+  int32_t p2_32;
+  int32_t p1_32;
+  int32_t p9_32;
+  int32_t p8_32;
+  int32_t p7_32;
+#endif
+
+#if KERNEL_FLOAT_USED
+  // Pressure, float
+  float p6_f;           // dig_P6 / 2^15
+  float p5_f;           // dig_P5 * 2
+  float p4_f;           // dig_P4 * 2^16
+  float p3_f;           // dig_P3 / 2^19
+  float p2_f;
+  float p1_f;
+  float p9_f;           // dig_P9 / 2^31
+  float p8_f;           // dig_P8 / 2^15
+  float p7_f;
+
+  // Humidity, float
+  float h4_f;           // dig_H4 * 64
+  float h5_f;           // dig_H5 / 2^14
+  float h2_f;           // dig_H2 / 2^16
+  float h6_f;           // dig_H6 / 2^26
+  float h3_f;           // dig_H3 / 2^26
+  float h1_f;           // dig_H1 / 2^19
+#endif
+
+#if (BME280_COMPENSATION_KERNEL != BME280_KERNEL_FLOAT) || BME280_BUILD_ALL_KERNELS
+  // Humidity, int32
+  int32_t h4_s20;       // dig_H4 << 20
+  int32_t h5;
+  int32_t h6;
+  int32_t h3;
+  int32_t h2;
+  int32_t h1;
+#endif
+} bme280_derived_t;
+
+static bme280_derived_t derived;
+
+static void derive_coefficients(const bme280_calib_data_t *calib, bme280_derived_t *d)
 {
-  uint8_t calib[32];
+  memset(d, 0, sizeof(*d));
+
+  d->t1_x2 = (int32_t)calib->dig_T1 << 1;
+  d->t2 = calib->dig_T2;
+  d->t1 = calib->dig_T1;
+  d->t3 = calib->dig_T3;
+
+#if KERNEL_INT64_USED
+  d->p6 = calib->dig_P6;
+  d->p5_s17 = (int64_t)calib->dig_P5 * 131072;
+  d->p4_s35 = (int64_t)calib->dig_P4 * 34359738368;
+  d->p3 = calib->dig_P3;
+  d->p2_s12 = (int64_t)calib->dig_P2 * 4096;
+  d->p1 = calib->dig_P1;
+  d->p9 = calib->dig_P9;
+  d->p8 = calib->dig_P8;
+  d->p7_s4 = (int64_t)calib->dig_P7 * 16;
+#endif
+
+#if KERNEL_INT32_USED
+  d->p6_32 = calib->dig_P6;
+  d->p5_x2 = (int32_t)calib->dig_P5 * 2;
+  d->p4_s16 = (int32_t)calib->dig_P4 * 65536;
+  d->p3_32 = calib->dig_P3;
+  d->p2_32 = calib->dig_P2;
+  d->p1_32 = calib->dig_P1;
+  d->p9_32 = calib->dig_P9;
+  d->p8_32 = calib->dig_P8;
+  d->p7_32 = calib->dig_P7;
+#endif
+
+#if KERNEL_FLOAT_USED
+  d->p6_f = (float)calib->dig_P6 * (1.0f / 32768.0f);
+  d->p5_f = (float)calib->dig_P5 * 2.0f;
+  d->p4_f = (float)calib->dig_P4 * 65536.0f;
+  d->p3_f = (float)calib->dig_P3 * (1.0f / 524288.0f);
+  d->p2_f = (float)calib->dig_P2;
+  d->p1_f = (float)calib->dig_P1;
+  d->p9_f = (float)calib->dig_P9 * (1.0f / 2147483648.0f);
+  d->p8_f = (float)calib->dig_P8 * (1.0f / 32768.0f);
+  d->p7_f = (float)calib->dig_P7;
+
+  d->h4_f = (float)calib->dig_H4 * 64.0f;
+  d->h5_f = (float)calib->dig_H5 * (1.0f / 16384.0f);
+  d->h2_f = (float)calib->dig_H2 * (1.0f / 65536.0f);
+  d->h6_f = (float)calib->dig_H6 * (1.0f / 67108864.0f);
+  d->h3_f = (float)calib->dig_H3 * (1.0f / 67108864.0f);
+  d->h1_f = (float)calib->dig_H1 * (1.0f / 524288.0f);
+#endif
+
+#if (BME280_COMPENSATION_KERNEL != BME280_KERNEL_FLOAT) || BME280_BUILD_ALL_KERNELS
+  d->h4_s20 = (int32_t)calib->dig_H4 * 1048576;
+  d->h5 = calib->dig_H5;
+  d->h6 = calib->dig_H6;
+  d->h3 = calib->dig_H3;
+  d->h2 = calib->dig_H2;
+  d->h1 = calib->dig_H1;
+#endif
+}
 
-  // Read calibration data 0x88-0xA1 (26 bytes)
-  if (!read_register(BME280_REG_CALIB_00, calib, 26)) {
-    return false;
-  }
+// Parse the raw calibration block (0x88..0xA1 then 0xE1..0xE7)
+static void parse_calibration_data(const uint8_t *raw, bool include_humidity)
+{
+  const uint8_t *calib = raw;
 
   calib_data.dig_T1 = (uint16_t)(calib[1] << 8) | calib[0];
   calib_data.dig_T2 = (int16_t)(calib[3] << 8) | calib[2];
@@ -55,11 +268,7 @@ static bool read_calibration_data(bool include_humidity)
   if (include_humidity) {
     calib_data.dig_H1 = calib[25];
 
-    // Read calibration data 0xE1-0xE7 (7 bytes)
-    if (!read_register(BME280_REG_CALIB_26, calib, 7)) {
-      return false;
-    }
-
+    calib = &raw[BME280_CALIB_00_LEN];
     calib_data.dig_H2 = (int16_t)(calib[1] << 8) | calib[0];
     calib_data.dig_H3 = calib[2];
     calib_data.dig_H4 = (int16_t)(calib[3] << 4) | (calib[4] & 0x0F);
@@ -74,76 +283,251 @@ static bool read_calibration_data(bool include_humidity)
     calib_data.dig_H6 = 0;
   }
 
-  return true;
+  derive_coefficients(&calib_data, &derived);
 }
 
-// Compensate temperature (returns value in 0.01 degrees Celsius)
-static int32_t compensate_temperature(int32_t adc_T)
+// Read the raw calibration block from the sensor (humidity part zeroed on BMP280)
+static bool read_calibration_raw(uint8_t *raw, bool include_humidity)
 {
-  int32_t var1, var2, T;
-
-  var1 = ((((adc_T >> 3) - ((int32_t)calib_data.dig_T1 << 1))) *
-          ((int32_t)calib_data.dig_T2)) >> 11;
-  var2 = (((((adc_T >> 4) - ((int32_t)calib_data.dig_T1)) *
-            ((adc_T >> 4) - ((int32_t)calib_data.dig_T1))) >> 12) *
-          ((int32_t)calib_data.dig_T3)) >> 14;
+  memset(raw, 0, BME280_CALIB_RAW_LEN);
 
-  calib_data.t_fine = var1 + var2;
-  T = (calib_data.t_fine * 5 + 128) >> 8;
+  // Read calibration data 0x88-0xA1 (26 bytes)
+  if (!read_register(BME280_REG_CALIB_00, raw, BME280_CALIB_00_LEN)) {
+    return false;
+  }
 
-  return T;  // Temperature in 0.01 degrees Celsius
+  // Read calibration data 0xE1-0xE7 (7 bytes)
+  if (include_humidity
+      && !read_register(BME280_REG_CALIB_26, &raw[BME280_CALIB_00_LEN], BME280_CALIB_26_LEN)) {
+    return false;
+  }
+  return true;
 }
 
-// Compensate pressure (returns value in Pa)
-static uint32_t compensate_pressure(int32_t adc_P)
+// Compensate temperature (returns value in 0.01 degrees Celsius)
+static int32_t compensate_temperature(bme280_derived_t *d, int32_t adc_T)
 {
-  int64_t var1, var2, p;
+  int32_t dt = (adc_T >> 4) - d->t1;
+  int32_t var1 = (((adc_T >> 3) - d->t1_x2) * d->t2) >> 11;
+  int32_t var2 = (((dt * dt) >> 12) * d->t3) >> 14;
 
-  var1 = ((int64_t)calib_data.t_fine) - 128000;
-  var2 = var1 * var1 * (int64_t)calib_data.dig_P6;
-  var2 = var2 + ((var1 * (int64_t)calib_data.dig_P5) << 17);
-  var2 = var2 + (((int64_t)calib_data.dig_P4) << 35);
-  var1 = ((var1 * var1 * (int64_t)calib_data.dig_P3) >> 8) +
-         ((var1 * (int64_t)calib_data.dig_P2) << 12);
-  var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calib_data.dig_P1) >> 33;
+  d->t_fine = var1 + var2;
+  return (d->t_fine * 5 + 128) >> 8;
+}
 
+#if KERNEL_INT64_USED
+// Compensate pressure, 64-bit integer (returns value in Pa)
+static uint32_t compensate_pressure_int64(const bme280_derived_t *d, int32_t adc_P)
+{
+  int64_t var1 = (int64_t)d->t_fine - 128000;
+  int64_t var1_sq = var1 * var1;
+  int64_t var2 = (var1_sq * d->p6) + (var1 * d->p5_s17) + d->p4_s35;
+
+  var1 = ((var1_sq * d->p3) >> 8) + (var1 * d->p2_s12);
+  var1 = (((((int64_t)1) << 47) + var1) * d->p1) >> 33;
   if (var1 == 0) {
     return 0;  // Avoid division by zero
   }
 
-  p = 1048576 - adc_P;
+  int64_t p = 1048576 - adc_P;
   p = (((p << 31) - var2) * 3125) / var1;
-  var1 = (((int64_t)calib_data.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-  var2 = (((int64_t)calib_data.dig_P8) * p) >> 19;
-  p = ((p + var1 + var2) >> 8) + (((int64_t)calib_data.dig_P7) << 4);
+  int64_t p_s13 = p >> 13;
+  var1 = (d->p9 * p_s13 * p_s13) >> 25;
+  var2 = (d->p8 * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + d->p7_s4;
 
   return (uint32_t)(p >> 8);  // Pressure in Pa (256th of Pa -> Pa)
 }
+#endif
+
+#if KERNEL_INT32_USED
+// Compensate pressure, 32-bit integer (BMP280 datasheet 8.2, returns Pa)
+static uint32_t compensate_pressure_int32(const bme280_derived_t *d, int32_t adc_P)
+{
+  int32_t var1 = (d->t_fine >> 1) - (int32_t)64000;
+  int32_t var1_sq = (var1 >> 2) * (var1 >> 2);
+  int32_t var2 = ((var1_sq >> 11) * d->p6_32) + (var1 * d->p5_x2);
+
+  var2 = (var2 >> 2) + d->p4_s16;
+  var1 = (((d->p3_32 * (var1_sq >> 13)) >> 3) + ((d->p2_32 * var1) >> 1)) >> 18;
+  var1 = ((32768 + var1) * d->p1_32) >> 15;
+  if (var1 == 0) {
+    return 0;  // Avoid division by zero
+  }
+
+  uint32_t p = (((uint32_t)(((int32_t)1048576) - adc_P) - (uint32_t)(var2 >> 12))) * 3125u;
+  if (p < 0x80000000u) {
+    p = (p << 1) / ((uint32_t)var1);
+  } else {
+    p = (p / (uint32_t)var1) * 2u;
+  }
+  var1 = (d->p9_32 * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+  var2 = (((int32_t)(p >> 2)) * d->p8_32) >> 13;
+
+  return (uint32_t)((int32_t)p + ((var1 + var2 + d->p7_32) >> 4));
+}
+#endif
 
-// Compensate humidity (returns value in 0.01 %RH)
-static uint32_t compensate_humidity(int32_t adc_H)
+#if KERNEL_FLOAT_USED
+// Compensate pressure, single precision (BME280 datasheet 8.1, returns Pa)
+static uint32_t compensate_pressure_float(const bme280_derived_t *d, int32_t adc_P)
 {
-  int32_t v_x1_u32r;
+  float var1 = ((float)d->t_fine * 0.5f) - 64000.0f;
+  float var2 = var1 * var1 * d->p6_f;
+
+  var2 = var2 + (var1 * d->p5_f);
+  var2 = (var2 * 0.25f) + d->p4_f;
+  var1 = ((d->p3_f * var1 * var1) + (d->p2_f * var1)) * (1.0f / 524288.0f);
+  var1 = (1.0f + (var1 * (1.0f / 32768.0f))) * d->p1_f;
+  if (var1 == 0.0f) {
+    return 0;  // Avoid division by zero
+  }
+
+  float p = 1048576.0f - (float)adc_P;
+  p = (p - (var2 * (1.0f / 4096.0f))) * 6250.0f / var1;
+  var1 = d->p9_f * p * p;
+  var2 = p * d->p8_f;
+  p = p + ((var1 + var2 + d->p7_f) * (1.0f / 16.0f));
+
+  return (p > 0.0f) ? (uint32_t)(p + 0.5f) : 0u;
+}
 
-  v_x1_u32r = (calib_data.t_fine - ((int32_t)76800));
-  v_x1_u32r = (((((adc_H << 14) - (((int32_t)calib_data.dig_H4) << 20) -
-                  (((int32_t)calib_data.dig_H5) * v_x1_u32r)) +
-                 ((int32_t)16384)) >> 15) *
-               (((((((v_x1_u32r * ((int32_t)calib_data.dig_H6)) >> 10) *
-                    (((v_x1_u32r * ((int32_t)calib_data.dig_H3)) >> 11) +
-                     ((int32_t)32768))) >> 10) +
-                   ((int32_t)2097152)) *
-                  ((int32_t)calib_data.dig_H2) + 8192) >> 14));
+// Compensate humidity, single precision (returns value in 0.01 %RH)
+static uint32_t compensate_humidity_float(const bme280_derived_t *d, int32_t adc_H)
+{
+  float var_h = (float)d->t_fine - 76800.0f;
+
+  var_h = ((float)adc_H - (d->h4_f + (d->h5_f * var_h)))
+          * (d->h2_f * (1.0f + (d->h6_f * var_h * (1.0f + (d->h3_f * var_h)))));
+  var_h = var_h * (1.0f - (d->h1_f * var_h));
+
+  if (var_h > 100.0f) {
+    var_h = 100.0f;
+  } else if (var_h < 0.0f) {
+    var_h = 0.0f;
+  }
+  return (uint32_t)((var_h * 100.0f) + 0.5f);
+}
+#endif
 
-  v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) *
-                             ((int32_t)calib_data.dig_H1)) >> 4));
+#if (BME280_COMPENSATION_KERNEL != BME280_KERNEL_FLOAT) || BME280_BUILD_ALL_KERNELS
+// Compensate humidity, 32-bit integer (returns value in 0.01 %RH)
+static uint32_t compensate_humidity_int32(const bme280_derived_t *d, int32_t adc_H)
+{
+  int32_t v = d->t_fine - (int32_t)76800;
+  int32_t x = (((adc_H << 14) - d->h4_s20 - (d->h5 * v)) + (int32_t)16384) >> 15;
+  int32_t y = ((((((v * d->h6) >> 10) * (((v * d->h3) >> 11) + (int32_t)32768)) >> 10)
+                + (int32_t)2097152) * d->h2 + 8192) >> 14;
 
-  v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
-  v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
+  v = x * y;
+  v = v - (((((v >> 15) * (v >> 15)) >> 7) * d->h1) >> 4);
+  v = (v < 0) ? 0 : v;
+  v = (v > 419430400) ? 419430400 : v;
 
-  uint32_t h = (uint32_t)(v_x1_u32r >> 12);
+  uint32_t h = (uint32_t)(v >> 12);
   return (h * 100) >> 10;  // Convert to 0.01 %RH
 }
+#endif
+
+// Kernel selected at build time
+static uint32_t compensate_pressure(const bme280_derived_t *d, int32_t adc_P)
+{
+#if (BME280_COMPENSATION_KERNEL == BME280_KERNEL_INT32)
+  return compensate_pressure_int32(d, adc_P);
+#elif (BME280_COMPENSATION_KERNEL == BME280_KERNEL_FLOAT)
+  return compensate_pressure_float(d, adc_P);
+#else
+  return compensate_pressure_int64(d, adc_P);
+#endif
+}
+
+static uint32_t compensate_humidity(const bme280_derived_t *d, int32_t adc_H)
+{
+#if (BME280_COMPENSATION_KERNEL == BME280_KERNEL_FLOAT)
+  return compensate_humidity_float(d, adc_H);
+#else
+  return compensate_humidity_int32(d, adc_H);
+#endif
+}
+
+// Number of samples averaged for an osrs_x setting (0 when skipped)
+static uint32_t oversampling_count(uint8_t osrs)
+{
+  if (osrs == BME280_OSRS_SKIP) {
+    return 0;
+  }
+  if (osrs > BME280_OSRS_X16) {
+    osrs = BME280_OSRS_X16;
+  }
+  return 1u << (osrs - 1u);
+}
+
+uint32_t bme280_get_measurement_time_us(void)
+{
+  uint32_t os_t = oversampling_count(BME280_OSRS_T);
+  uint32_t os_p = oversampling_count(BME280_OSRS_P);
+  uint32_t os_h = sensor_has_humidity ? oversampling_count(BME280_OSRS_H) : 0;
+  uint32_t t_us = 1250u + (2300u * os_t);
+
+  if (os_p != 0) {
+    t_us += (2300u * os_p) + 575u;
+  }
+  if (os_h != 0) {
+    t_us += (2300u * os_h) + 575u;
+  }
+  return t_us;
+}
+
+void bme280_estimate_energy(uint32_t interval_ms, bme280_energy_estimate_t *estimate)
+{
+  if (estimate == NULL) {
+    return;
+  }
+
+  uint32_t os_t = oversampling_count(BME280_OSRS_T);
+  uint32_t os_p = oversampling_count(BME280_OSRS_P);
+  uint32_t os_h = sensor_has_humidity ? oversampling_count(BME280_OSRS_H) : 0;
+  uint32_t t_meas_us = bme280_get_measurement_time_us();
+
+  // Charge of one conversion: uA * us = pC, divide by 1000 for nC.
+  // Start-up phase (1.25 ms) is charged at the temperature current.
+  uint32_t conv_nc = (BME280_IDD_TEMPERATURE_UA * (1250u + (2300u * os_t))) / 1000u;
+  if (os_p != 0) {
+    conv_nc += (BME280_IDD_PRESSURE_UA * ((2300u * os_p) + 575u)) / 1000u;
+  }
+  if (os_h != 0) {
+    conv_nc += (BME280_IDD_HUMIDITY_UA * ((2300u * os_h) + 575u)) / 1000u;
+  }
+
+  // Forced: one conversion per interval, sleep current for the rest.
+  // nA * ms = pC, divide by 1000 for nC.
+  estimate->forced_nc = conv_nc + (BME280_IDD_SLEEP_NA * interval_ms) / 1000u;
+
+  // Normal: back-to-back cycles of t_meas + t_standby for the whole interval.
+  uint32_t cycle_us = t_meas_us + (BME280_NORMAL_STANDBY_MS * 1000u);
+  uint32_t cycles = (uint32_t)(((uint64_t)interval_ms * 1000u + cycle_us - 1u) / cycle_us);
+  estimate->normal_nc = (cycles * conv_nc) + (BME280_IDD_STANDBY_NA * interval_ms) / 1000u;
+}
+
+#if BME280_USE_FORCED_MODE
+static void conversion_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  conversion_done = true;
+}
+
+static bool arm_conversion_timer(uint32_t wait_ms)
+{
+  conversion_done = false;
+  return sl_sleeptimer_start_timer_ms(&conversion_timer,
+                                      wait_ms,
+                                      conversion_timer_callback,
+                                      NULL,
+                                      0,
+                                      0) == SL_STATUS_OK;
+}
+#endif
 
 bool bme280_reset(void)
 {
@@ -154,6 +538,14 @@ bool bme280_init(void)
 {
   uint8_t chip_id;
 
+#if BME280_USE_FORCED_MODE
+  if (conversion_active) {
+    (void)sl_sleeptimer_stop_timer(&conversion_timer);
+  }
+#endif
+  conversion_active = false;
+  sensor_initialized = false;
+
   // Initialize I2C
   if (!hal_i2c_init()) {
     return false;
@@ -173,55 +565,191 @@ bool bme280_init(void)
     return false;  // Unknown chip ID
   }
 
-  // Soft reset
-  if (!bme280_reset()) {
-    return false;
-  }
+  // Warm boot: the chip ID read above is the only probe. The sensor keeps
+  // its own state across an MCU reset, so put it back to sleep (CONFIG and
+  // CTRL_HUM writes are ignored in normal mode) instead of a soft reset.
+  bme280_cache_t cache;
+  cache_failures = 0;
+  calib_from_cache = sensor_cache_load(SENSOR_CACHE_KEY_BME280, &cache, sizeof(cache))
+                     && cache.chip_id == chip_id
+                     && cache.addr == BME280_I2C_ADDR;
+  if (calib_from_cache) {
+    parse_calibration_data(cache.calib, sensor_has_humidity);
+    if (!write_register(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS(BME280_MODE_SLEEP))) {
+      return false;
+    }
+  } else {
+    // Soft reset
+    if (!bme280_reset()) {
+      return false;
+    }
 
-  // Wait for reset to complete (typical 2ms)
-  for (volatile int i = 0; i < 100000; i++);
+    // Wait for reset to complete
+    sl_sleeptimer_delay_millisecond(BME280_RESET_TIME_MS);
 
-  // Read calibration data
-  if (!read_calibration_data(sensor_has_humidity)) {
-    return false;
+    // Read calibration data
+    cache.chip_id = chip_id;
+    cache.addr = BME280_I2C_ADDR;
+    if (!read_calibration_raw(cache.calib, sensor_has_humidity)) {
+      return false;
+    }
+    parse_calibration_data(cache.calib, sensor_has_humidity);
+    (void)sensor_cache_store(SENSOR_CACHE_KEY_BME280, &cache, sizeof(cache));
   }
 
   // Configure sensor
-  // Humidity oversampling x1 (BME280 only)
+  // Humidity oversampling (BME280 only). CTRL_HUM only takes effect after
+  // the next CTRL_MEAS write, so it must be written first.
   if (sensor_has_humidity) {
-    if (!write_register(BME280_REG_CTRL_HUM, 0x01)) {
+    if (!write_register(BME280_REG_CTRL_HUM, BME280_OSRS_H)) {
       return false;
     }
   }
 
-  // Temperature oversampling x1, Pressure oversampling x1, Normal mode
-  if (!write_register(BME280_REG_CTRL_MEAS, 0x27)) {
+  // Standby time 1000ms (normal mode only), filter off.
+  // CONFIG writes are ignored in normal mode, so set it while still asleep.
+  if (!write_register(BME280_REG_CONFIG, 0xA0)) {
     return false;
   }
 
-  // Standby time 1000ms, filter off
-  if (!write_register(BME280_REG_CONFIG, 0xA0)) {
+#if BME280_USE_FORCED_MODE
+  // Stay in sleep mode; each bme280_start_measurement() triggers one conversion.
+  if (!write_register(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS(BME280_MODE_SLEEP))) {
     return false;
   }
+#else
+  if (!write_register(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS(BME280_MODE_NORMAL))) {
+    return false;
+  }
+#endif
 
   sensor_initialized = true;
   return true;
 }
 
-bool bme280_read_data(bme280_data_t *data)
+#if BME280_CACHE_VERIFY
+// Lazy half of the warm-boot check: re-read the calibration once, after the
+// boot path, and replace the cached copy if the module was swapped for
+// another chip of the same type.
+static void verify_cached_calibration(void)
+{
+  bme280_cache_t cache;
+
+  if (!read_calibration_raw(cache.calib, sensor_has_humidity)) {
+    return;  // Retried on the next sample
+  }
+  calib_from_cache = false;
+
+  cache.chip_id = sensor_chip_id;
+  cache.addr = BME280_I2C_ADDR;
+  parse_calibration_data(cache.calib, sensor_has_humidity);
+  (void)sensor_cache_store(SENSOR_CACHE_KEY_BME280, &cache, sizeof(cache));
+}
+#endif
+
+// A sample failed. One transient bus error says nothing about the cached
+// detection; a different chip ID on the bus, or failures that keep coming,
+// do. Either way the next boot takes the full probe path.
+static void note_sample_failure(void)
+{
+  uint8_t chip_id = 0;
+
+  if (!calib_from_cache) {
+    return;
+  }
+  if (read_register(BME280_REG_ID, &chip_id, 1) && chip_id != sensor_chip_id) {
+    sensor_cache_invalidate(SENSOR_CACHE_KEY_BME280);
+    calib_from_cache = false;
+    return;
+  }
+  if (++cache_failures >= BME280_CACHE_MAX_FAILURES) {
+    sensor_cache_invalidate(SENSOR_CACHE_KEY_BME280);
+    calib_from_cache = false;
+  }
+}
+
+bool bme280_start_measurement(void)
+{
+  if (!sensor_initialized || conversion_active) {
+    return false;
+  }
+
+#if BME280_USE_FORCED_MODE
+  if (!write_register(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS(BME280_MODE_FORCED))) {
+    note_sample_failure();
+    return false;
+  }
+  conversion_extra_polls = 0;
+  conversion_failed = false;
+  if (!arm_conversion_timer((bme280_get_measurement_time_us() + 999u) / 1000u)) {
+    return false;
+  }
+#endif
+  conversion_active = true;
+  return true;
+}
+
+bool bme280_measurement_ready(void)
+{
+  if (!conversion_active) {
+    return false;
+  }
+
+#if BME280_USE_FORCED_MODE
+  uint8_t status = 0;
+
+  if (!conversion_done) {
+    return false;
+  }
+  // t_meas,max is up: a chip still converting gets a few more 1 ms waits.
+  // A failed status read or an overrun is left for bme280_fetch_data().
+  conversion_failed = !read_register(BME280_REG_STATUS, &status, 1);
+  if (!conversion_failed && (status & BME280_STATUS_MEASURING) != 0) {
+    if (conversion_extra_polls < BME280_FORCED_MAX_EXTRA_POLLS
+        && arm_conversion_timer(1u)) {
+      conversion_extra_polls++;
+      return false;
+    }
+    conversion_failed = true;
+  }
+#endif
+  return true;
+}
+
+bool bme280_fetch_data(bme280_data_t *data)
 {
   uint8_t raw_data[8];
   int32_t adc_T, adc_P, adc_H;
 
-  if (!sensor_initialized || data == NULL) {
+  if (data == NULL || !conversion_active) {
+    return false;
+  }
+  conversion_active = false;
+
+#if BME280_USE_FORCED_MODE
+  if (!conversion_done) {
+    (void)sl_sleeptimer_stop_timer(&conversion_timer);
     return false;
   }
+  if (conversion_failed) {
+    note_sample_failure();
+    return false;
+  }
+#endif
 
   // Read data registers (BMP280 = 6 bytes, BME280 = 8 bytes)
   uint16_t read_len = sensor_has_humidity ? 8 : 6;
   if (!read_register(BME280_REG_PRESS_MSB, raw_data, read_len)) {
+    note_sample_failure();
     return false;
   }
+  cache_failures = 0;
+
+#if BME280_CACHE_VERIFY
+  if (calib_from_cache) {
+    verify_cached_calibration();
+  }
+#endif
 
   // Extract raw ADC values
   adc_P = (int32_t)((((uint32_t)raw_data[0]) << 12) |
@@ -239,9 +767,9 @@ bool bme280_read_data(bme280_data_t *data)
   }
 
   // Compensate values
-  data->temperature = compensate_temperature(adc_T);
-  data->pressure = compensate_pressure(adc_P);
-  data->humidity = sensor_has_humidity ? compensate_humidity(adc_H) : 0xFFFF;
+  data->temperature = compensate_temperature(&derived, adc_T);
+  data->pressure = compensate_pressure(&derived, adc_P);
+  data->humidity = sensor_has_humidity ? compensate_humidity(&derived, adc_H) : 0xFFFF;
 
   return true;
 }
@@ -23,10 +23,36 @@
 #define BME280_REG_CALIB_00     0x88
 #define BME280_REG_CALIB_26     0xE1
 
+// CTRL_MEAS mode field
+#define BME280_MODE_SLEEP       0x00
+#define BME280_MODE_FORCED      0x01
+#define BME280_MODE_NORMAL      0x03
+
+// STATUS register bits
+#define BME280_STATUS_MEASURING 0x08
+
+// Oversampling field encoding (osrs_t / osrs_p / osrs_h)
+#define BME280_OSRS_SKIP        0x00
+#define BME280_OSRS_X1          0x01
+#define BME280_OSRS_X2          0x02
+#define BME280_OSRS_X4          0x03
+#define BME280_OSRS_X8          0x04
+#define BME280_OSRS_X16         0x05
+
 // BME280 / BMP280 chip IDs
 #define BME280_CHIP_ID          0x60
 #define BMP280_CHIP_ID          0x58
 
+// Compensation kernels (BME280_COMPENSATION_KERNEL)
+#define BME280_KERNEL_INT64     0  // Bosch 64-bit integer pressure (reference)
+#define BME280_KERNEL_INT32     1  // Bosch 32-bit integer pressure
+#define BME280_KERNEL_FLOAT     2  // Single-precision FPU pressure and humidity
+#define BME280_KERNEL_COUNT     3
+
+#ifndef BME280_COMPENSATION_KERNEL
+#define BME280_COMPENSATION_KERNEL BME280_KERNEL_INT64
+#endif
+
 // Compensation parameters structure
 typedef struct {
   uint16_t dig_T1;
@@ -57,18 +83,54 @@ typedef struct {
   uint32_t humidity;    // Humidity in 0.01 %RH
 } bme280_data_t;
 
+// Estimated sensor charge for one reporting interval, per operating mode
+typedef struct {
+  uint32_t forced_nc;   // One forced conversion, sleep mode in between (nC)
+  uint32_t normal_nc;   // Continuous normal mode with 1000 ms standby (nC)
+} bme280_energy_estimate_t;
+
 /**
  * @brief Initialize BME280 sensor
+ *
+ * A cold boot soft-resets the chip, reads the calibration block and caches
+ * it with the chip ID in NVM (sensor_cache). A warm boot with a matching
+ * cache only reads the chip ID; the calibration is re-read once on the
+ * first sample (BME280_CACHE_VERIFY). While the cached copy is in use, the
+ * record is dropped on a chip-ID mismatch or after BME280_CACHE_MAX_FAILURES
+ * failed samples in a row; a single transient failure keeps it.
+ *
  * @return true if successful, false otherwise
  */
 bool bme280_init(void);
 
 /**
- * @brief Read sensor data (temperature, pressure, humidity)
+ * @brief Start one conversion and arm the conversion timer
+ *
+ * In forced mode (default) this writes CTRL_MEAS and returns; the MCU may
+ * sleep for t_meas,max until bme280_measurement_ready(). The chip returns
+ * to sleep mode on its own once the conversion is done. In normal mode the
+ * latest result is fetched right away.
+ *
+ * @return true if the conversion was started
+ */
+bool bme280_start_measurement(void);
+
+/**
+ * @brief Check whether a started conversion has completed (main context)
+ *
+ * Once the timer expires the status register is read; a chip still
+ * converting re-arms a 1 ms wait (at most 3 times) and reports not ready.
+ *
+ * @return true when bme280_fetch_data() can be called
+ */
+bool bme280_measurement_ready(void);
+
+/**
+ * @brief Read and compensate the result of the started conversion
  * @param data Pointer to structure to store measurements
- * @return true if successful, false otherwise
+ * @return true on success, false on I2C error, overrun or no started conversion
  */
-bool bme280_read_data(bme280_data_t *data);
+bool bme280_fetch_data(bme280_data_t *data);
 
 /**
  * @brief Returns true if the detected sensor provides humidity.
@@ -80,6 +142,27 @@ bool bme280_has_humidity(void);
  */
 uint8_t bme280_get_chip_id(void);
 
+/**
+ * @brief Maximum conversion time for the configured oversampling settings.
+ *
+ * t_meas,max from the BME280 datasheet (section 9.1):
+ * 1.25 ms + 2.3 ms * osrs_t + (2.3 ms * osrs_p + 0.575 ms)
+ *         + (2.3 ms * osrs_h + 0.575 ms).
+ *
+ * @return Conversion time in microseconds
+ */
+uint32_t bme280_get_measurement_time_us(void);
+
+/**
+ * @brief Estimate sensor charge per sample for forced vs normal mode.
+ *
+ * Uses datasheet typical currents and the configured oversampling.
+ *
+ * @param interval_ms Time between application reads
+ * @param estimate Output estimate
+ */
+void bme280_estimate_energy(uint32_t interval_ms, bme280_energy_estimate_t *estimate);
+
 /**
  * @brief Perform soft reset of the sensor
  * @return true if successful, false otherwise
@@ -1,7 +1,9 @@
 #include "hal/eeprom.h"
+#include "hal_eeprom.h"
 #include "em_gpio.h"
 #include "sl_sleeptimer.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define SPI_FLASH_SIZE_BYTES (256u * 1024u)
@@ -19,6 +21,8 @@
 #define FLASH_PORT_EN gpioPortF
 #define FLASH_PIN_EN 3
 
+static hal_eeprom_op_counts_t flash_ops;
+
 static void flash_gpio_init(void)
 {
   static bool configured = false;
@@ -121,6 +125,7 @@ static void flash_read(uint32_t address, uint8_t *data, uint16_t len)
     data[i] = flash_bb_transfer(0x00);
   }
   flash_cs_high();
+  flash_ops.read_bytes += len;
 }
 
 static bool flash_page_program(uint32_t address, const uint8_t *data, uint16_t len)
@@ -135,6 +140,7 @@ static bool flash_page_program(uint32_t address, const uint8_t *data, uint16_t l
     (void)flash_bb_transfer(data[i]);
   }
   flash_cs_high();
+  flash_ops.page_programs++;
   return flash_wait_ready(5000);
 }
 
@@ -147,6 +153,7 @@ static bool flash_sector_erase(uint32_t address)
   (void)flash_bb_transfer((uint8_t)(address >> 8));
   (void)flash_bb_transfer((uint8_t)(address));
   flash_cs_high();
+  flash_ops.sector_erases++;
   return flash_wait_ready(5000);
 }
 
@@ -222,3 +229,11 @@ const HalEepromInformationType *halEepromInfo(void)
 {
   return &halEepromInfoData;
 }
+
+void hal_eeprom_get_op_counts(hal_eeprom_op_counts_t *counts)
+{
+  if (counts == NULL) {
+    return;
+  }
+  *counts = flash_ops;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file hal_eeprom.h
+ * @brief External SPI flash behind the stack's EEPROM HAL (hal/eeprom.h)
+ *
+ * The halEeprom* entry points are declared in include/hal/eeprom.h, which
+ * also owns the HAL_EEPROM_H guard. This header adds the driver's own extras.
+ */
+
+#ifndef HAL_EEPROM_DRIVER_H
+#define HAL_EEPROM_DRIVER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Flash operations since boot (energy accounting)
+ */
+typedef struct {
+  uint32_t read_bytes;     // Bytes read
+  uint32_t page_programs;  // Page program commands (one per page touched)
+  uint32_t sector_erases;  // 4 KB sector erase commands
+} hal_eeprom_op_counts_t;
+
+/**
+ * @brief Snapshot the operation counters
+ * @param counts Output
+ */
+void hal_eeprom_get_op_counts(hal_eeprom_op_counts_t *counts);
+
+#endif // HAL_EEPROM_DRIVER_H
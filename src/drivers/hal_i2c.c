@@ -15,42 +15,493 @@
 #include "em_i2c.h"
 #include "em_cmu.h"
 #include "em_gpio.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "sl_sleeptimer.h"
+#include <stddef.h>
+
+// Receive multi-byte reads through LDMA instead of one interrupt per byte
+#ifndef HAL_I2C_USE_LDMA
+#define HAL_I2C_USE_LDMA 1
+#endif
+
+// Shortest read worth the DMA setup cost; shorter reads use I2C_Transfer()
+#ifndef HAL_I2C_LDMA_MIN_RX_LEN
+#define HAL_I2C_LDMA_MIN_RX_LEN 4u
+#endif
+#if HAL_I2C_LDMA_MIN_RX_LEN < 2
+#error "HAL_I2C_LDMA_MIN_RX_LEN must be at least 2 (last byte is read by the CPU)"
+#endif
+
+// Transfer counters and DWT cycle accounting for hal_i2c_get_stats()
+#ifndef HAL_I2C_STATS
+#define HAL_I2C_STATS 1
+#endif
+
+#if HAL_I2C_USE_LDMA
+#include "dmadrv.h"
+#endif
 
 // Determine which I2C instance to use
 #ifdef CUSTOM_BOARD_TRADFRI
   // TRÅDFRI config directly defines peripheral
   #define I2C_PERIPHERAL    BME280_I2C_PERIPHERAL
   #define I2C_CLOCK         BME280_I2C_CLOCK
+  #define I2C_IRQN          BME280_I2C_IRQN
+  #define I2C_IRQ_HANDLER   BME280_I2C_IRQ_HANDLER
+  #define I2C_DMA_SIGNAL    BME280_I2C_DMA_SIGNAL
 #else
   // BRD4151A config uses instance number
   #if BME280_I2C_INSTANCE == 0
     #define I2C_PERIPHERAL    I2C0
     #define I2C_CLOCK         cmuClock_I2C0
+    #define I2C_IRQN          I2C0_IRQn
+    #define I2C_IRQ_HANDLER   I2C0_IRQHandler
+    #define I2C_DMA_SIGNAL    dmadrvPeripheralSignal_I2C0_RXDATAV
   #elif BME280_I2C_INSTANCE == 1
     #define I2C_PERIPHERAL    I2C1
     #define I2C_CLOCK         cmuClock_I2C1
+    #define I2C_IRQN          I2C1_IRQn
+    #define I2C_IRQ_HANDLER   I2C1_IRQHandler
+    #define I2C_DMA_SIGNAL    dmadrvPeripheralSignal_I2C1_RXDATAV
   #else
     #error "Invalid I2C instance"
   #endif
 #endif
 
+// Interrupt sources consumed by the EMLIB I2C_Transfer() state machine
+#define I2C_IEN_TRANSFER  (I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_RXDATAV \
+                           | I2C_IEN_MSTOP | I2C_IEN_ARBLOST | I2C_IEN_BUSERR)
+
+// SCL pulses clocked out by hal_i2c_recover_bus() (one full byte + ACK)
+#define I2C_RECOVERY_CLOCKS 9u
+
 static bool i2c_initialized = false;
+// Set by a failed transfer that may have left the bus or peripheral stuck
+static volatile bool recovery_pending = false;
+static hal_i2c_error_stats_t error_stats;
+static volatile uint32_t transfer_count = 0;
 
-bool hal_i2c_init(void)
+// Transfer queue: head is the active transfer, protected by CORE atomic sections
+static hal_i2c_transfer_t *queue_head = NULL;
+static hal_i2c_transfer_t *queue_tail = NULL;
+static I2C_TransferSeq_TypeDef active_seq;
+static sl_sleeptimer_timer_handle_t timeout_timer;
+
+static void timeout_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+#if HAL_I2C_STATS
+static hal_i2c_stats_t stats;
+
+static inline uint32_t stats_cycles_now(void)
 {
-  if (i2c_initialized) {
+  return DWT->CYCCNT;
+}
+
+static inline void stats_add_isr(uint32_t start_cycles)
+{
+  stats.isr_count++;
+  stats.isr_cycles += DWT->CYCCNT - start_cycles;
+}
+#else
+static inline uint32_t stats_cycles_now(void)
+{
+  return 0;
+}
+
+static inline void stats_add_isr(uint32_t start_cycles)
+{
+  (void)start_cycles;
+}
+#endif
+
+#if HAL_I2C_USE_LDMA
+// Register-read state machine used instead of I2C_Transfer() for long reads.
+// The address/register phases are interrupt driven; the data bytes are
+// drained from RXDATA by LDMA with AUTOACK, and only the final byte (which
+// must be NACKed) is taken by the CPU.
+typedef enum {
+  DMA_STATE_IDLE = 0,
+  DMA_STATE_ADDR_WRITE,  // START + address|W sent, waiting for ACK
+  DMA_STATE_TX_DATA,     // Write byte sent, waiting for ACK
+  DMA_STATE_ADDR_READ,   // (Repeated) START + address|R sent, waiting for ACK
+  DMA_STATE_RX_DMA,      // LDMA receiving all but the last byte
+  DMA_STATE_RX_LAST,     // Waiting for the last byte to NACK it
+  DMA_STATE_WAIT_STOP,   // STOP issued, waiting for MSTOP
+} dma_state_t;
+
+#define I2C_IEN_DMA_PHASE  (I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_MSTOP \
+                            | I2C_IEN_ARBLOST | I2C_IEN_BUSERR)
+
+static unsigned int dma_channel;
+static bool dma_ready = false;
+static bool active_uses_dma = false;
+static dma_state_t dma_state = DMA_STATE_IDLE;
+static uint16_t dma_tx_index;
+static hal_i2c_status_t dma_result;
+
+static bool dma_rx_done_callback(unsigned int channel, unsigned int sequenceNo, void *userParam);
+
+// Flush the peripheral and send START + address|W (or |R for read-only
+// transfers). Call with interrupts masked.
+static void dma_start_locked(hal_i2c_transfer_t *transfer)
+{
+  if (I2C_PERIPHERAL->STATE & I2C_STATE_BUSY) {
+    I2C_PERIPHERAL->CMD = I2C_CMD_ABORT;
+  }
+  I2C_PERIPHERAL->CMD = I2C_CMD_CLEARPC | I2C_CMD_CLEARTX;
+  while (I2C_PERIPHERAL->STATUS & I2C_STATUS_RXDATAV) {
+    (void)I2C_PERIPHERAL->RXDATA;
+  }
+  I2C_PERIPHERAL->CTRL &= ~I2C_CTRL_AUTOACK;
+  I2C_IntClear(I2C_PERIPHERAL, _I2C_IFC_MASK);
+
+  dma_tx_index = 0;
+  dma_result = HAL_I2C_STATUS_OK;
+  I2C_PERIPHERAL->CMD = I2C_CMD_START;
+  if (transfer->tx_len > 0) {
+    dma_state = DMA_STATE_ADDR_WRITE;
+    I2C_PERIPHERAL->TXDATA = (uint32_t)(transfer->addr << 1);
+  } else {
+    dma_state = DMA_STATE_ADDR_READ;
+    I2C_PERIPHERAL->TXDATA = (uint32_t)(transfer->addr << 1) | 1u;
+  }
+  I2C_IntEnable(I2C_PERIPHERAL, I2C_IEN_DMA_PHASE);
+}
+
+// Stop any in-flight LDMA receive and release AUTOACK. Call with interrupts
+// masked.
+static void dma_abort_locked(void)
+{
+  if (dma_state == DMA_STATE_RX_DMA) {
+    (void)DMADRV_StopTransfer(dma_channel);
+  }
+  I2C_PERIPHERAL->CTRL &= ~I2C_CTRL_AUTOACK;
+  dma_state = DMA_STATE_IDLE;
+}
+
+// Advance the register-read state machine from the I2C interrupt. Call with
+// interrupts masked. Returns true when the transfer has finished, with the
+// result in dma_result.
+static bool dma_step_locked(hal_i2c_transfer_t *transfer)
+{
+  uint32_t pending = I2C_IntGetEnabled(I2C_PERIPHERAL);
+  I2C_IntClear(I2C_PERIPHERAL, pending);
+
+  if (pending & (I2C_IF_ARBLOST | I2C_IF_BUSERR)) {
+    I2C_PERIPHERAL->CMD = I2C_CMD_ABORT;
+    dma_abort_locked();
+    dma_result = (pending & I2C_IF_ARBLOST) ? HAL_I2C_STATUS_ARB_LOST
+                                            : HAL_I2C_STATUS_BUS_ERROR;
     return true;
   }
 
-  // Enable clocks
-  CMU_ClockEnable(cmuClock_HFPER, true);
-  CMU_ClockEnable(I2C_CLOCK, true);
-  CMU_ClockEnable(cmuClock_GPIO, true);
+  switch (dma_state) {
+    case DMA_STATE_ADDR_WRITE:
+    case DMA_STATE_TX_DATA:
+    case DMA_STATE_ADDR_READ:
+      if (pending & I2C_IF_NACK) {
+        I2C_PERIPHERAL->CMD = I2C_CMD_STOP;
+        dma_result = HAL_I2C_STATUS_NACK;
+        dma_state = DMA_STATE_WAIT_STOP;
+        break;
+      }
+      if (!(pending & I2C_IF_ACK)) {
+        break;
+      }
+      if (dma_state != DMA_STATE_ADDR_READ) {
+        if (dma_tx_index < transfer->tx_len) {
+          I2C_PERIPHERAL->TXDATA = transfer->tx_data[dma_tx_index++];
+          dma_state = DMA_STATE_TX_DATA;
+        } else {
+          I2C_PERIPHERAL->CMD = I2C_CMD_START;
+          I2C_PERIPHERAL->TXDATA = (uint32_t)(transfer->addr << 1) | 1u;
+          dma_state = DMA_STATE_ADDR_READ;
+        }
+        break;
+      }
+      // Address|R acknowledged: hand all but the last byte to LDMA. The
+      // hardware ACKs each of them; the last one is NACKed by the CPU.
+      I2C_PERIPHERAL->CTRL |= I2C_CTRL_AUTOACK;
+      dma_state = DMA_STATE_RX_DMA;
+      if (DMADRV_PeripheralMemory(dma_channel,
+                                  I2C_DMA_SIGNAL,
+                                  transfer->rx_data,
+                                  (void *)&I2C_PERIPHERAL->RXDATA,
+                                  true,
+                                  (int)(transfer->rx_len - 1u),
+                                  dmadrvDataSize1,
+                                  dma_rx_done_callback,
+                                  NULL) != ECODE_EMDRV_DMADRV_OK) {
+        I2C_PERIPHERAL->CMD = I2C_CMD_ABORT;
+        I2C_PERIPHERAL->CTRL &= ~I2C_CTRL_AUTOACK;
+        dma_state = DMA_STATE_IDLE;
+        dma_result = HAL_I2C_STATUS_BUS_ERROR;
+        return true;
+      }
+      break;
 
-  // Configure GPIO pins
-  GPIO_PinModeSet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN, gpioModeWiredAndPullUp, 1);
-  GPIO_PinModeSet(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN, gpioModeWiredAndPullUp, 1);
+    case DMA_STATE_RX_LAST:
+      if (I2C_PERIPHERAL->STATUS & I2C_STATUS_RXDATAV) {
+        I2C_IntDisable(I2C_PERIPHERAL, I2C_IEN_RXDATAV);
+        transfer->rx_data[transfer->rx_len - 1u] = (uint8_t)I2C_PERIPHERAL->RXDATA;
+        I2C_PERIPHERAL->CMD = I2C_CMD_NACK;
+        I2C_PERIPHERAL->CMD = I2C_CMD_STOP;
+        dma_state = DMA_STATE_WAIT_STOP;
+      }
+      break;
+
+    case DMA_STATE_WAIT_STOP:
+      if (pending & I2C_IF_MSTOP) {
+        dma_state = DMA_STATE_IDLE;
+        return true;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+// LDMA completion (LDMA IRQ): all but the last byte are in the buffer.
+// AUTOACK must be dropped before the last byte's ACK slot, which is at least
+// 9 SCL periods after the byte that completed the DMA.
+static bool dma_rx_done_callback(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+  (void)channel;
+  (void)sequenceNo;
+  (void)userParam;
+  uint32_t start_cycles = stats_cycles_now();
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (dma_state == DMA_STATE_RX_DMA) {
+    I2C_PERIPHERAL->CTRL &= ~I2C_CTRL_AUTOACK;
+    dma_state = DMA_STATE_RX_LAST;
+    // Fires immediately if the last byte already arrived
+    I2C_IntEnable(I2C_PERIPHERAL, I2C_IEN_RXDATAV);
+  }
+  stats_add_isr(start_cycles);
+  CORE_EXIT_ATOMIC();
+  return true;
+}
+#endif // HAL_I2C_USE_LDMA
+
+static hal_i2c_status_t status_from_return(I2C_TransferReturn_TypeDef ret)
+{
+  switch (ret) {
+    case i2cTransferDone:
+      return HAL_I2C_STATUS_OK;
+    case i2cTransferNack:
+      return HAL_I2C_STATUS_NACK;
+    case i2cTransferArbLost:
+      return HAL_I2C_STATUS_ARB_LOST;
+    default:
+      return HAL_I2C_STATUS_BUS_ERROR;
+  }
+}
+
+// Start the transfer at the queue head. Call with interrupts masked.
+// Returns false if it completed (failed) immediately.
+static bool start_head_locked(void)
+{
+  hal_i2c_transfer_t *transfer = queue_head;
+  uint32_t timeout_ms = (transfer->timeout_ms != 0) ? transfer->timeout_ms
+                                                     : HAL_I2C_DEFAULT_TIMEOUT_MS;
+
+#if HAL_I2C_USE_LDMA
+  active_uses_dma = dma_ready && transfer->rx_len >= HAL_I2C_LDMA_MIN_RX_LEN;
+  if (active_uses_dma) {
+#if HAL_I2C_STATS
+    stats.dma_transfers++;
+#endif
+    (void)sl_sleeptimer_restart_timer_ms(&timeout_timer,
+                                         timeout_ms,
+                                         timeout_timer_callback,
+                                         NULL,
+                                         0,
+                                         0);
+    dma_start_locked(transfer);
+    return true;
+  }
+#endif
+
+  active_seq.addr = (uint16_t)(transfer->addr << 1);
+  if (transfer->tx_len > 0 && transfer->rx_len > 0) {
+    active_seq.flags = I2C_FLAG_WRITE_READ;
+    active_seq.buf[0].data = (uint8_t *)transfer->tx_data;
+    active_seq.buf[0].len = transfer->tx_len;
+    active_seq.buf[1].data = transfer->rx_data;
+    active_seq.buf[1].len = transfer->rx_len;
+  } else if (transfer->rx_len > 0) {
+    active_seq.flags = I2C_FLAG_READ;
+    active_seq.buf[0].data = transfer->rx_data;
+    active_seq.buf[0].len = transfer->rx_len;
+  } else {
+    active_seq.flags = I2C_FLAG_WRITE;
+    active_seq.buf[0].data = (uint8_t *)transfer->tx_data;
+    active_seq.buf[0].len = transfer->tx_len;
+  }
+
+  I2C_TransferReturn_TypeDef ret = I2C_TransferInit(I2C_PERIPHERAL, &active_seq);
+  if (ret != i2cTransferInProgress) {
+    transfer->status = status_from_return(ret);
+    return false;
+  }
+
+  (void)sl_sleeptimer_restart_timer_ms(&timeout_timer,
+                                       timeout_ms,
+                                       timeout_timer_callback,
+                                       NULL,
+                                       0,
+                                       0);
+  I2C_IntEnable(I2C_PERIPHERAL, I2C_IEN_TRANSFER);
+  return true;
+}
+
+// Count a retired transfer by its status; errors that can leave the bus
+// stuck schedule a recovery. Call with interrupts masked.
+static void count_completion_locked(const hal_i2c_transfer_t *transfer)
+{
+  switch (transfer->status) {
+    case HAL_I2C_STATUS_NACK:
+      error_stats.nack++;
+      break;
+    case HAL_I2C_STATUS_ARB_LOST:
+      error_stats.arb_lost++;
+      recovery_pending = true;
+      break;
+    case HAL_I2C_STATUS_BUS_ERROR:
+      error_stats.bus_error++;
+      recovery_pending = true;
+      break;
+    case HAL_I2C_STATUS_TIMEOUT:
+      error_stats.timeout++;
+      recovery_pending = true;
+      break;
+    default:
+      break;
+  }
+  transfer_count++;
+#if HAL_I2C_STATS
+  stats.transfers++;
+  stats.bytes += (uint32_t)transfer->tx_len + transfer->rx_len;
+  if (transfer->status != HAL_I2C_STATUS_OK) {
+    stats.errors++;
+  }
+#endif
+}
+
+// Retire the active transfer with the given status and start the next one.
+// Queued transfers that fail to start are retired and counted the same way.
+// Ignored if 'active' is no longer the queue head (the I2C and timeout
+// interrupts may race to complete the same transfer).
+static void complete_active(hal_i2c_transfer_t *active, hal_i2c_status_t status)
+{
+  hal_i2c_transfer_t *done_list = NULL;
+  hal_i2c_transfer_t **done_tail = &done_list;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (active == NULL || queue_head != active) {
+    CORE_EXIT_ATOMIC();
+    return;
+  }
+
+  I2C_IntDisable(I2C_PERIPHERAL, I2C_IEN_TRANSFER);
+  I2C_IntClear(I2C_PERIPHERAL, _I2C_IFC_MASK);
+  NVIC_ClearPendingIRQ(I2C_IRQN);
+  (void)sl_sleeptimer_stop_timer(&timeout_timer);
+#if HAL_I2C_USE_LDMA
+  if (active_uses_dma) {
+    dma_abort_locked();
+    active_uses_dma = false;
+  }
+#endif
+
+  queue_head->status = status;
+  for (;;) {
+    // Move the finished head to the local completion list
+    hal_i2c_transfer_t *finished = queue_head;
+    count_completion_locked(finished);
+    queue_head = finished->next;
+    if (queue_head == NULL) {
+      queue_tail = NULL;
+    }
+    finished->next = NULL;
+    *done_tail = finished;
+    done_tail = &finished->next;
+
+    if (queue_head == NULL || start_head_locked()) {
+      break;
+    }
+  }
+  CORE_EXIT_ATOMIC();
+
+  // Report completions outside the atomic section; callbacks may resubmit.
+  while (done_list != NULL) {
+    hal_i2c_transfer_t *transfer = done_list;
+    done_list = transfer->next;
+    transfer->next = NULL;
+    transfer->busy = false;
+    if (transfer->callback != NULL) {
+      transfer->callback(transfer, transfer->status);
+    }
+  }
+}
 
+static void timeout_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  // Stop the state machine and release the bus before failing the transfer.
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  hal_i2c_transfer_t *active = queue_head;
+  if (active != NULL) {
+    I2C_PERIPHERAL->CMD = I2C_CMD_ABORT;
+  }
+  CORE_EXIT_ATOMIC();
+
+  complete_active(active, HAL_I2C_STATUS_TIMEOUT);
+}
+
+void I2C_IRQ_HANDLER(void)
+{
+  I2C_TransferReturn_TypeDef ret = i2cTransferInProgress;
+  hal_i2c_status_t status = HAL_I2C_STATUS_OK;
+  uint32_t start_cycles = stats_cycles_now();
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  hal_i2c_transfer_t *active = queue_head;
+  if (active == NULL) {
+    I2C_IntClear(I2C_PERIPHERAL, _I2C_IFC_MASK);
+#if HAL_I2C_USE_LDMA
+  } else if (active_uses_dma) {
+    if (dma_step_locked(active)) {
+      ret = i2cTransferDone;
+      status = dma_result;
+    }
+#endif
+  } else {
+    ret = I2C_Transfer(I2C_PERIPHERAL);
+    status = status_from_return(ret);
+  }
+  CORE_EXIT_ATOMIC();
+
+  if (ret != i2cTransferInProgress) {
+    complete_active(active, status);
+  }
+  stats_add_isr(start_cycles);
+}
+
+// Route the pins to the peripheral and (re)initialize it with the transfer
+// interrupts disabled. Pins must already be open-drain outputs driving high.
+static void configure_peripheral(void)
+{
   // Route I2C pins
   I2C_PERIPHERAL->ROUTEPEN = I2C_ROUTEPEN_SDAPEN | I2C_ROUTEPEN_SCLPEN;
   I2C_PERIPHERAL->ROUTELOC0 = (I2C_PERIPHERAL->ROUTELOC0 & ~(_I2C_ROUTELOC0_SDALOC_MASK | _I2C_ROUTELOC0_SCLLOC_MASK));
@@ -75,65 +526,265 @@ bool hal_i2c_init(void)
 
   I2C_Init(I2C_PERIPHERAL, &i2cInit);
 
+  // The peripheral starts with the bus state unknown; take it to idle
+  if (I2C_PERIPHERAL->STATE & I2C_STATE_BUSY) {
+    I2C_PERIPHERAL->CMD = I2C_CMD_ABORT;
+  }
+
+  // Transfers are driven from the I2C interrupt
+  I2C_IntDisable(I2C_PERIPHERAL, I2C_IEN_TRANSFER);
+  I2C_IntClear(I2C_PERIPHERAL, _I2C_IFC_MASK);
+  NVIC_ClearPendingIRQ(I2C_IRQN);
+}
+
+bool hal_i2c_init(void)
+{
+  if (i2c_initialized) {
+    return true;
+  }
+
+  // Enable clocks
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(I2C_CLOCK, true);
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  // Configure GPIO pins
+  GPIO_PinModeSet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN, gpioModeWiredAndPullUp, 1);
+  GPIO_PinModeSet(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN, gpioModeWiredAndPullUp, 1);
+
+  // A reset in the middle of a read can leave the slave driving SDA
+  if (GPIO_PinInGet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN) == 0) {
+    recovery_pending = true;
+  }
+
+  configure_peripheral();
+  NVIC_EnableIRQ(I2C_IRQN);
+
+#if HAL_I2C_USE_LDMA
+  // Fall back to the interrupt-per-byte path if no LDMA channel is free
+  Ecode_t ecode = DMADRV_Init();
+  if (ecode == ECODE_EMDRV_DMADRV_OK || ecode == ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED) {
+    dma_ready = (DMADRV_AllocateChannel(&dma_channel, NULL) == ECODE_EMDRV_DMADRV_OK);
+  }
+#endif
+
+#if HAL_I2C_STATS
+  // Cycle counter for ISR accounting
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
   i2c_initialized = true;
   return true;
 }
 
-bool hal_i2c_write(uint8_t addr, const uint8_t *data, uint16_t len)
+// Wait at least one sleeptimer tick (~31 us): a slow but valid SCL half period
+static void recovery_delay(void)
 {
-  I2C_TransferSeq_TypeDef seq;
-  I2C_TransferReturn_TypeDef ret;
+  uint32_t start = sl_sleeptimer_get_tick_count();
+  while ((uint32_t)(sl_sleeptimer_get_tick_count() - start) < 2u) {
+  }
+}
 
-  seq.addr = addr << 1;
-  seq.flags = I2C_FLAG_WRITE;
-  seq.buf[0].data = (uint8_t *)data;
-  seq.buf[0].len = len;
+bool hal_i2c_recover_bus(void)
+{
+  if (!i2c_initialized || !hal_i2c_is_idle()) {
+    return false;
+  }
+  recovery_pending = false;
 
-  ret = I2C_TransferInit(I2C_PERIPHERAL, &seq);
+  // Take the pins away from the peripheral (still open-drain, driving high)
+  I2C_Enable(I2C_PERIPHERAL, false);
+  I2C_PERIPHERAL->ROUTEPEN = 0;
+  GPIO_PinOutSet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN);
+  GPIO_PinOutSet(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN);
+  recovery_delay();
 
-  while (ret == i2cTransferInProgress) {
-    ret = I2C_Transfer(I2C_PERIPHERAL);
+  // A slave in the middle of a read shifts out one bit per clock and lets go
+  // of SDA at the latest after the remaining bits and the ACK slot.
+  for (uint32_t i = 0; i < I2C_RECOVERY_CLOCKS; i++) {
+    if (GPIO_PinInGet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN) != 0) {
+      break;
+    }
+    GPIO_PinOutClear(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN);
+    recovery_delay();
+    GPIO_PinOutSet(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN);
+    recovery_delay();
   }
 
-  return (ret == i2cTransferDone);
+  // STOP: SDA rises while SCL is high
+  GPIO_PinOutClear(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN);
+  recovery_delay();
+  GPIO_PinOutClear(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN);
+  recovery_delay();
+  GPIO_PinOutSet(BME280_I2C_SCL_PORT, BME280_I2C_SCL_PIN);
+  recovery_delay();
+  GPIO_PinOutSet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN);
+  recovery_delay();
+
+  bool released = (GPIO_PinInGet(BME280_I2C_SDA_PORT, BME280_I2C_SDA_PIN) != 0);
+
+  I2C_Reset(I2C_PERIPHERAL);
+  configure_peripheral();
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  error_stats.recoveries++;
+  if (!released) {
+    error_stats.recovery_failed++;
+  }
+  CORE_EXIT_ATOMIC();
+  return released;
 }
 
-bool hal_i2c_read(uint8_t addr, uint8_t *data, uint16_t len)
+bool hal_i2c_submit(hal_i2c_transfer_t *transfer)
 {
-  I2C_TransferSeq_TypeDef seq;
-  I2C_TransferReturn_TypeDef ret;
+  if (!i2c_initialized || transfer == NULL || transfer->busy) {
+    return false;
+  }
 
-  seq.addr = addr << 1;
-  seq.flags = I2C_FLAG_READ;
-  seq.buf[0].data = data;
-  seq.buf[0].len = len;
+  // Deferred from the failed transfer; callbacks resubmitting from interrupt
+  // context leave it to the next thread-context submit.
+  if (recovery_pending && !CORE_InIrqContext() && hal_i2c_is_idle()) {
+    (void)hal_i2c_recover_bus();
+  }
+  if ((transfer->tx_len > 0 && transfer->tx_data == NULL)
+      || (transfer->rx_len > 0 && transfer->rx_data == NULL)
+      || (transfer->tx_len == 0 && transfer->rx_len == 0)) {
+    return false;
+  }
 
-  ret = I2C_TransferInit(I2C_PERIPHERAL, &seq);
+  transfer->next = NULL;
+  transfer->busy = true;
+  transfer->status = HAL_I2C_STATUS_OK;
 
-  while (ret == i2cTransferInProgress) {
-    ret = I2C_Transfer(I2C_PERIPHERAL);
+  bool started = true;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (queue_tail != NULL) {
+    queue_tail->next = transfer;
+    queue_tail = transfer;
+  } else {
+    queue_head = transfer;
+    queue_tail = transfer;
+    started = start_head_locked();
   }
+  CORE_EXIT_ATOMIC();
 
-  return (ret == i2cTransferDone);
+  if (!started) {
+    // Failed before any bus activity; report like any other completion.
+    complete_active(transfer, transfer->status);
+  }
+  return true;
 }
 
-bool hal_i2c_write_read(uint8_t addr, uint8_t reg_addr, uint8_t *data, uint16_t len)
+bool hal_i2c_is_idle(void)
 {
-  I2C_TransferSeq_TypeDef seq;
-  I2C_TransferReturn_TypeDef ret;
+  return queue_head == NULL;
+}
 
-  seq.addr = addr << 1;
-  seq.flags = I2C_FLAG_WRITE_READ;
-  seq.buf[0].data = &reg_addr;
-  seq.buf[0].len = 1;
-  seq.buf[1].data = data;
-  seq.buf[1].len = len;
+hal_i2c_status_t hal_i2c_transfer_blocking(hal_i2c_transfer_t *transfer)
+{
+#if HAL_I2C_STATS
+  uint32_t start_ticks = sl_sleeptimer_get_tick_count();
+#endif
 
-  ret = I2C_TransferInit(I2C_PERIPHERAL, &seq);
+  if (!hal_i2c_submit(transfer)) {
+    return HAL_I2C_STATUS_BUS_ERROR;
+  }
 
-  while (ret == i2cTransferInProgress) {
-    ret = I2C_Transfer(I2C_PERIPHERAL);
+  // Sleep in EM1 until the completion interrupt. The critical section sets
+  // PRIMASK, and WFI with PRIMASK set still wakes on a pending IRQ, which
+  // then runs once the section ends. An atomic section would not do: it
+  // raises BASEPRI, which masks the I2C, LDMA and sleeptimer IRQs from
+  // waking the core at all.
+  while (transfer->busy) {
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_CRITICAL();
+    if (transfer->busy) {
+      EMU_EnterEM1();
+    }
+    CORE_EXIT_CRITICAL();
+  }
+
+#if HAL_I2C_STATS
+  stats.wait_ticks += sl_sleeptimer_get_tick_count() - start_ticks;
+#endif
+  return transfer->status;
+}
+
+void hal_i2c_get_stats(hal_i2c_stats_t *out)
+{
+  if (out == NULL) {
+    return;
   }
+#if HAL_I2C_STATS
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = stats;
+  CORE_EXIT_ATOMIC();
+#else
+  *out = (hal_i2c_stats_t){ 0 };
+#endif
+}
+
+void hal_i2c_get_error_stats(hal_i2c_error_stats_t *out)
+{
+  if (out == NULL) {
+    return;
+  }
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = error_stats;
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t hal_i2c_get_transfer_count(void)
+{
+  return transfer_count;
+}
+
+void hal_i2c_reset_stats(void)
+{
+#if HAL_I2C_STATS
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  stats = (hal_i2c_stats_t){ 0 };
+  CORE_EXIT_ATOMIC();
+#endif
+}
+
+bool hal_i2c_write(uint8_t addr, const uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .tx_data = data,
+    .tx_len = len,
+  };
+
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
+}
+
+bool hal_i2c_read(uint8_t addr, uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .rx_data = data,
+    .rx_len = len,
+  };
+
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
+}
+
+bool hal_i2c_write_read(uint8_t addr, uint8_t reg_addr, uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .tx_data = &reg_addr,
+    .tx_len = 1,
+    .rx_data = data,
+    .rx_len = len,
+  };
 
-  return (ret == i2cTransferDone);
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
 }
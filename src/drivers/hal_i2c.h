@@ -2,7 +2,15 @@
  * @file hal_i2c.h
  * @brief I2C Hardware Abstraction Layer for Silicon Labs EFR32
  *
- * Provides simple I2C read/write functions using Silicon Labs EMLIB.
+ * Provides interrupt-driven I2C transfers using Silicon Labs EMLIB.
+ * Transfers are queued and completed from the I2C interrupt; the blocking
+ * helpers wait for completion in EM1. Reads of HAL_I2C_LDMA_MIN_RX_LEN bytes
+ * or more are received by LDMA so the core is not woken per byte.
+ *
+ * Every transfer has a deadline. A timeout, bus error or lost arbitration
+ * (single-master bus: a slave holding SDA) marks the bus for recovery, which
+ * runs before the next transfer from thread context: up to 9 SCL pulses
+ * until SDA is released, a STOP condition, and a peripheral re-init.
  */
 
 #ifndef HAL_I2C_H
@@ -11,12 +19,154 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Default per-transfer deadline when hal_i2c_transfer_t.timeout_ms is 0
+#ifndef HAL_I2C_DEFAULT_TIMEOUT_MS
+#define HAL_I2C_DEFAULT_TIMEOUT_MS 50u
+#endif
+
+/**
+ * @brief Completion status of an I2C transfer
+ */
+typedef enum {
+  HAL_I2C_STATUS_OK = 0,
+  HAL_I2C_STATUS_NACK,       // Address or data byte not acknowledged
+  HAL_I2C_STATUS_BUS_ERROR,  // Misplaced START/STOP or driver fault
+  HAL_I2C_STATUS_TIMEOUT,    // Transfer did not finish before its deadline
+  HAL_I2C_STATUS_ARB_LOST,   // Arbitration lost (SDA held low by a slave)
+} hal_i2c_status_t;
+
+typedef struct hal_i2c_transfer hal_i2c_transfer_t;
+
+/**
+ * @brief Transfer completion callback
+ *
+ * Runs in interrupt context (I2C or sleeptimer IRQ). The transfer is no
+ * longer owned by the driver when this is called and may be resubmitted.
+ */
+typedef void (*hal_i2c_callback_t)(hal_i2c_transfer_t *transfer, hal_i2c_status_t status);
+
+/**
+ * @brief Asynchronous I2C transfer descriptor
+ *
+ * The write phase (tx) runs first, followed by a repeated-start read phase
+ * (rx) when both are present. The descriptor and its buffers must stay valid
+ * until completion.
+ */
+struct hal_i2c_transfer {
+  uint8_t addr;                // 7-bit device address
+  const uint8_t *tx_data;      // Bytes to write (NULL if none)
+  uint16_t tx_len;
+  uint8_t *rx_data;            // Receive buffer (NULL if none)
+  uint16_t rx_len;
+  uint32_t timeout_ms;         // 0 = HAL_I2C_DEFAULT_TIMEOUT_MS
+  hal_i2c_callback_t callback; // Optional, interrupt context
+  void *user_data;
+
+  // Driver-owned state
+  hal_i2c_transfer_t *next;
+  volatile bool busy;
+  volatile hal_i2c_status_t status;
+};
+
+/**
+ * @brief Driver activity counters (see hal_i2c_get_stats)
+ */
+typedef struct {
+  uint32_t transfers;      // Completed transfers (any status)
+  uint32_t dma_transfers;  // Transfers received through LDMA
+  uint32_t errors;         // Transfers that did not complete OK
+  uint32_t bytes;          // Payload bytes written + read
+  uint32_t isr_count;      // I2C and LDMA completion interrupts taken
+  uint32_t isr_cycles;     // Core cycles spent in those interrupts
+  uint32_t wait_ticks;     // Sleeptimer ticks spent in blocking calls
+} hal_i2c_stats_t;
+
+/**
+ * @brief Failure counters since boot (not cleared by hal_i2c_reset_stats)
+ */
+typedef struct {
+  uint32_t nack;             // HAL_I2C_STATUS_NACK completions
+  uint32_t arb_lost;         // HAL_I2C_STATUS_ARB_LOST completions
+  uint32_t bus_error;        // HAL_I2C_STATUS_BUS_ERROR completions
+  uint32_t timeout;          // HAL_I2C_STATUS_TIMEOUT completions
+  uint32_t recoveries;       // Bus recovery sequences run
+  uint32_t recovery_failed;  // Recoveries that left SDA held low
+} hal_i2c_error_stats_t;
+
 /**
  * @brief Initialize I2C peripheral
  * @return true if successful, false otherwise
  */
 bool hal_i2c_init(void);
 
+/**
+ * @brief Queue an asynchronous transfer
+ *
+ * Starts immediately when the bus is idle, otherwise runs after the
+ * transfers already queued. Completion is reported through the callback
+ * and the descriptor's busy/status fields.
+ *
+ * @param transfer Transfer descriptor (must not already be queued)
+ * @return true if queued, false on invalid descriptor or uninitialized bus
+ */
+bool hal_i2c_submit(hal_i2c_transfer_t *transfer);
+
+/**
+ * @brief Check whether any transfer is active or queued
+ * @return true when the queue is empty
+ */
+bool hal_i2c_is_idle(void);
+
+/**
+ * @brief Run a transfer and wait for it in EM1
+ * @param transfer Transfer descriptor (callback is optional)
+ * @return Completion status
+ */
+hal_i2c_status_t hal_i2c_transfer_blocking(hal_i2c_transfer_t *transfer);
+
+/**
+ * @brief Snapshot the activity counters
+ *
+ * isr_cycles is the CPU-active time attributable to I2C; wait_ticks is the
+ * wall time callers spent blocked (mostly in EM1).
+ *
+ * @param stats Output snapshot (zeroed when HAL_I2C_STATS is 0)
+ */
+void hal_i2c_get_stats(hal_i2c_stats_t *stats);
+
+/**
+ * @brief Reset the activity counters
+ */
+void hal_i2c_reset_stats(void);
+
+/**
+ * @brief Snapshot the failure counters
+ * @param stats Output snapshot
+ */
+void hal_i2c_get_error_stats(hal_i2c_error_stats_t *stats);
+
+/**
+ * @brief Transfers completed since boot, failed ones included
+ *
+ * Never reset and independent of HAL_I2C_STATS (energy accounting).
+ *
+ * @return Transfer count
+ */
+uint32_t hal_i2c_get_transfer_count(void);
+
+/**
+ * @brief Free a stuck bus and re-initialize the peripheral
+ *
+ * Takes SCL/SDA as GPIO, clocks SCL (at most 9 pulses) until the slave
+ * releases SDA, issues a STOP and re-initializes the I2C peripheral. Runs
+ * automatically before the next transfer after a timeout, bus error or lost
+ * arbitration. Busy-waits for up to about 1.5 ms; thread context only.
+ *
+ * @return true if SDA is released, false if still held low or the bus is
+ *         busy with queued transfers
+ */
+bool hal_i2c_recover_bus(void);
+
 /**
  * @brief Write data to I2C device
  * @param addr 7-bit I2C device address
@@ -0,0 +1,123 @@
+/**
+ * @file sensor_cache.c
+ * @brief NVM3 cache for sensor detection and calibration data
+ */
+
+#include "sensor_cache.h"
+#include <string.h>
+
+#if SENSOR_CACHE_ENABLE
+
+#include "nvm3_default.h"
+
+// Bump when a driver changes the layout of its payload
+#define SENSOR_CACHE_VERSION 1u
+
+typedef struct {
+  uint8_t version;
+  uint8_t len;
+  uint16_t crc;
+  uint8_t payload[SENSOR_CACHE_MAX_LEN];
+} sensor_cache_record_t;
+
+#define RECORD_HEADER_LEN (sizeof(sensor_cache_record_t) - SENSOR_CACHE_MAX_LEN)
+
+// CRC-16/CCITT-FALSE over version, length and payload
+static uint16_t record_crc(const sensor_cache_record_t *record)
+{
+  uint16_t crc = 0xFFFFu;
+  uint8_t header[2] = { record->version, record->len };
+
+  for (uint16_t i = 0; i < (uint16_t)(sizeof(header) + record->len); i++) {
+    uint8_t byte = (i < sizeof(header)) ? header[i] : record->payload[i - sizeof(header)];
+    crc ^= (uint16_t)byte << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static bool read_record(uint32_t key, sensor_cache_record_t *record, uint16_t len)
+{
+  uint32_t type;
+  size_t stored_len;
+
+  if (len > SENSOR_CACHE_MAX_LEN) {
+    return false;
+  }
+  if (nvm3_getObjectInfo(nvm3_defaultHandle, key, &type, &stored_len) != ECODE_NVM3_OK
+      || type != NVM3_OBJECTTYPE_DATA
+      || stored_len != RECORD_HEADER_LEN + len) {
+    return false;
+  }
+  if (nvm3_readData(nvm3_defaultHandle, key, record, stored_len) != ECODE_NVM3_OK) {
+    return false;
+  }
+  return record->version == SENSOR_CACHE_VERSION
+         && record->len == len
+         && record->crc == record_crc(record);
+}
+
+bool sensor_cache_load(uint32_t key, void *data, uint16_t len)
+{
+  sensor_cache_record_t record;
+
+  if (data == NULL || !read_record(key, &record, len)) {
+    return false;
+  }
+  memcpy(data, record.payload, len);
+  return true;
+}
+
+bool sensor_cache_store(uint32_t key, const void *data, uint16_t len)
+{
+  sensor_cache_record_t record;
+
+  if (data == NULL || len > SENSOR_CACHE_MAX_LEN) {
+    return false;
+  }
+
+  // Avoid a flash write when nothing changed (the usual warm-boot case)
+  if (read_record(key, &record, len) && memcmp(record.payload, data, len) == 0) {
+    return true;
+  }
+
+  memset(&record, 0, sizeof(record));
+  record.version = SENSOR_CACHE_VERSION;
+  record.len = (uint8_t)len;
+  memcpy(record.payload, data, len);
+  record.crc = record_crc(&record);
+
+  return nvm3_writeData(nvm3_defaultHandle, key, &record, RECORD_HEADER_LEN + len) == ECODE_NVM3_OK;
+}
+
+void sensor_cache_invalidate(uint32_t key)
+{
+  (void)nvm3_deleteObject(nvm3_defaultHandle, key);
+}
+
+#else // !SENSOR_CACHE_ENABLE
+
+bool sensor_cache_load(uint32_t key, void *data, uint16_t len)
+{
+  (void)key;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+bool sensor_cache_store(uint32_t key, const void *data, uint16_t len)
+{
+  (void)key;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+void sensor_cache_invalidate(uint32_t key)
+{
+  (void)key;
+}
+
+#endif // SENSOR_CACHE_ENABLE
@@ -0,0 +1,53 @@
+/**
+ * @file sensor_cache.h
+ * @brief NVM3 cache for sensor detection and calibration data
+ *
+ * Drivers store what they learned at a cold boot (chip, I2C address,
+ * calibration block) so a warm boot can skip probing and calibration reads
+ * and only confirm the chip with a single register read. Records carry a
+ * CRC-16 and a format version; a record that does not match is ignored.
+ */
+
+#ifndef SENSOR_CACHE_H
+#define SENSOR_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Set to 0 to always probe and read calibration at boot
+#ifndef SENSOR_CACHE_ENABLE
+#define SENSOR_CACHE_ENABLE 1
+#endif
+
+// NVM3 keys, in the application range of the default instance
+#define SENSOR_CACHE_KEY_BME280   0x0A280u
+#define SENSOR_CACHE_KEY_SHT31    0x0A031u
+
+// Largest payload a record can hold
+#define SENSOR_CACHE_MAX_LEN      48u
+
+/**
+ * @brief Load a cached record
+ * @param key SENSOR_CACHE_KEY_*
+ * @param data Output buffer
+ * @param len Expected payload length
+ * @return true if a record of this length with a valid CRC was found
+ */
+bool sensor_cache_load(uint32_t key, void *data, uint16_t len);
+
+/**
+ * @brief Store a record (skipped when NVM3 already holds the same payload)
+ * @param key SENSOR_CACHE_KEY_*
+ * @param data Payload
+ * @param len Payload length (at most SENSOR_CACHE_MAX_LEN)
+ * @return true if NVM3 holds the payload afterwards
+ */
+bool sensor_cache_store(uint32_t key, const void *data, uint16_t len);
+
+/**
+ * @brief Drop a record so the next boot takes the full probe path
+ * @param key SENSOR_CACHE_KEY_*
+ */
+void sensor_cache_invalidate(uint32_t key);
+
+#endif // SENSOR_CACHE_H
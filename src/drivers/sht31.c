@@ -5,7 +5,9 @@
 
 #include "sht31.h"
 #include "hal_i2c.h"
+#include "sensor_cache.h"
 #include "sl_sleeptimer.h"
+#include "sl_status.h"
 #include <string.h>
 
 #define SHT31_ADDR_PRIMARY   0x44
@@ -13,10 +15,80 @@
 
 #define SHT31_CMD_SOFT_RESET_MSB 0x30
 #define SHT31_CMD_SOFT_RESET_LSB 0xA2
-#define SHT31_CMD_MEASURE_HPM_MSB 0x24
-#define SHT31_CMD_MEASURE_HPM_LSB 0x00
+#define SHT31_CMD_FETCH_DATA      0xE000u
+#define SHT31_CMD_BREAK           0x3093u
+#define SHT31_CMD_READ_STATUS     0xF32Du
+
+// Soft reset time (datasheet t_SR max 1.5 ms), rounded up
+#define SHT31_RESET_TIME_MS       2u
+
+// Single-shot vs periodic selection (see sht31_set_sample_interval)
+#ifndef SHT31_ACQUISITION_MODE
+#define SHT31_ACQUISITION_MODE SHT31_ACQ_AUTO
+#endif
+
+// Boot-time repeatability; changed at runtime with sht31_set_measurement_mode()
+#ifndef SHT31_REPEATABILITY
+#define SHT31_REPEATABILITY SHT31_REPEATABILITY_HIGH
+#endif
+
+// Datasheet typical values used by the energy estimate.
+#define SHT31_IDD_MEASURE_UA        600u
+#define SHT31_IDD_IDLE_NA           200u    // Single-shot idle
+#define SHT31_IDD_PERIODIC_IDLE_NA  45000u  // Idle between periodic conversions
+// Extra MCU wake a single-shot conversion costs (EM2 wake + ~1 ms in EM0).
+// Rough board-level estimate; periodic fetches ride on the sample wake.
+#define SHT31_WAKE_CHARGE_NC        4000u
+
+// Single-shot commands per repeatability (low, medium, high), datasheet table 9
+static const uint16_t single_shot_commands[3] = { 0x2416u, 0x240Bu, 0x2400u };
+static const uint16_t single_shot_stretch_commands[3] = { 0x2C10u, 0x2C0Du, 0x2C06u };
+
+// Max conversion time per repeatability (4.5 / 6.5 / 15.5 ms), rounded up
+static const uint8_t conversion_time_ms[3] = { 5u, 7u, 16u };
+
+// Periodic command per [rate][repeatability] (datasheet table 10)
+static const uint16_t periodic_commands[SHT31_RATE_COUNT][3] = {
+  [SHT31_RATE_0_5_MPS] = { 0x202Fu, 0x2024u, 0x2032u },
+  [SHT31_RATE_1_MPS]   = { 0x212Du, 0x2126u, 0x2130u },
+  [SHT31_RATE_2_MPS]   = { 0x222Bu, 0x2220u, 0x2236u },
+  [SHT31_RATE_4_MPS]   = { 0x2329u, 0x2322u, 0x2334u },
+  [SHT31_RATE_10_MPS]  = { 0x272Au, 0x2721u, 0x2737u },
+};
+
+static const uint16_t periodic_period_ms[SHT31_RATE_COUNT] = {
+  [SHT31_RATE_0_5_MPS] = 2000u,
+  [SHT31_RATE_1_MPS]   = 1000u,
+  [SHT31_RATE_2_MPS]   = 500u,
+  [SHT31_RATE_4_MPS]   = 250u,
+  [SHT31_RATE_10_MPS]  = 100u,
+};
+
+// Typical conversion time per repeatability (low, medium, high)
+static const uint16_t measure_time_typ_us[3] = { 2500u, 4500u, 12500u };
+
+// Warm-boot record in sensor_cache
+typedef struct {
+  uint8_t addr;
+} sht31_cache_t;
 
 static uint8_t detected_addr = 0;
+// Address came from sensor_cache and no sample has been read from it yet
+static bool addr_from_cache = false;
+static sht31_repeatability_t repeatability = SHT31_REPEATABILITY;
+static bool clock_stretch = false;
+
+// Periodic acquisition state
+static bool periodic_active = false;
+static sht31_periodic_rate_t periodic_rate = SHT31_RATE_0_5_MPS;
+static uint32_t periodic_last_fetch_tick = 0;
+static bool periodic_have_sample = false;
+static sht31_data_t periodic_last_sample;
+
+// Non-blocking conversion state; conversion_done is set from the sleeptimer IRQ.
+static sl_sleeptimer_timer_handle_t conversion_timer;
+static volatile bool conversion_done = false;
+static bool conversion_active = false;
 
 static uint8_t crc8(const uint8_t *data, uint8_t len)
 {
@@ -30,23 +102,42 @@ static uint8_t crc8(const uint8_t *data, uint8_t len)
   return crc;
 }
 
-static bool try_measure(uint8_t addr, sht31_data_t *data)
+static bool send_command(uint8_t addr, uint16_t command)
+{
+  uint8_t cmd[2] = { (uint8_t)(command >> 8), (uint8_t)(command & 0xFFu) };
+
+  return hal_i2c_write(addr, cmd, sizeof(cmd));
+}
+
+static bool send_measure_command(uint8_t addr)
+{
+  return send_command(addr, clock_stretch ? single_shot_stretch_commands[repeatability]
+                                          : single_shot_commands[repeatability]);
+}
+
+// With clock stretching the sensor holds SCL until the result is ready, so
+// the read is issued straight away and no conversion timer is needed.
+static uint32_t conversion_wait_ms(void)
+{
+  return clock_stretch ? 0u : conversion_time_ms[repeatability];
+}
+
+static bool read_result(uint8_t addr, sht31_data_t *data)
 {
-  uint8_t cmd[2] = { SHT31_CMD_MEASURE_HPM_MSB, SHT31_CMD_MEASURE_HPM_LSB };
   uint8_t rx[6];
   uint16_t raw_t;
   uint16_t raw_h;
   int32_t temp_centi;
   uint32_t hum_centi;
 
-  if (!hal_i2c_write(addr, cmd, sizeof(cmd))) {
-    return false;
-  }
-
-  // High repeatability measurement max conversion time is ~15 ms.
-  sl_sleeptimer_delay_millisecond(20);
-
-  if (!hal_i2c_read(addr, rx, sizeof(rx))) {
+  // Long enough for a read held by clock stretching for a full conversion
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .rx_data = rx,
+    .rx_len = sizeof(rx),
+    .timeout_ms = HAL_I2C_DEFAULT_TIMEOUT_MS + conversion_time_ms[SHT31_REPEATABILITY_HIGH],
+  };
+  if (hal_i2c_transfer_blocking(&transfer) != HAL_I2C_STATUS_OK) {
     return false;
   }
 
@@ -68,38 +159,307 @@ static bool try_measure(uint8_t addr, sht31_data_t *data)
   return true;
 }
 
+// Status register read with CRC check; confirms a sensor answers at addr
+// without starting a conversion.
+static bool read_status(uint8_t addr)
+{
+  uint8_t rx[3];
+
+  if (!send_command(addr, SHT31_CMD_READ_STATUS)
+      || !hal_i2c_read(addr, rx, sizeof(rx))) {
+    return false;
+  }
+  return crc8(rx, 2) == rx[2];
+}
+
+// The first read after a warm boot settles the cached address: drop the
+// record on failure so the next boot probes both addresses again.
+static bool check_cached_addr(bool ok)
+{
+  if (addr_from_cache) {
+    if (!ok) {
+      sensor_cache_invalidate(SENSOR_CACHE_KEY_SHT31);
+    }
+    addr_from_cache = false;
+  }
+  return ok;
+}
+
+// Blocking measurement, used only to probe the addresses at init.
+static bool try_measure(uint8_t addr, sht31_data_t *data)
+{
+  if (!send_measure_command(addr)) {
+    return false;
+  }
+
+  uint32_t wait_ms = conversion_wait_ms();
+  if (wait_ms != 0u) {
+    sl_sleeptimer_delay_millisecond((uint16_t)wait_ms);
+  }
+
+  return read_result(addr, data);
+}
+
+// Read the latest periodic result. The sensor NACKs a fetch when no new
+// conversion finished since the previous one, so within one period the last
+// sample is returned without touching the bus.
+static bool fetch_periodic(sht31_data_t *data)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint32_t period_ms = periodic_period_ms[periodic_rate];
+
+  if (periodic_have_sample
+      && sl_sleeptimer_tick_to_ms(now - periodic_last_fetch_tick) < period_ms) {
+    *data = periodic_last_sample;
+    return true;
+  }
+
+  if (!send_command(detected_addr, SHT31_CMD_FETCH_DATA)
+      || !read_result(detected_addr, data)) {
+    return false;
+  }
+
+  periodic_last_fetch_tick = now;
+  periodic_last_sample = *data;
+  periodic_have_sample = true;
+  return true;
+}
+
+static void stop_periodic(void)
+{
+  if (periodic_active) {
+    (void)send_command(detected_addr, SHT31_CMD_BREAK);
+    // Break takes up to 1 ms before the sensor accepts a new command
+    sl_sleeptimer_delay_millisecond(1);
+    periodic_active = false;
+    periodic_have_sample = false;
+  }
+}
+
+static void conversion_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  conversion_done = true;
+}
+
 bool sht31_init(void)
 {
   uint8_t cmd_reset[2] = { SHT31_CMD_SOFT_RESET_MSB, SHT31_CMD_SOFT_RESET_LSB };
   sht31_data_t sample;
 
   detected_addr = 0;
+  periodic_active = false;
+  periodic_have_sample = false;
+  if (conversion_active) {
+    (void)sl_sleeptimer_stop_timer(&conversion_timer);
+    conversion_active = false;
+  }
   (void)hal_i2c_init();
 
+  // Warm boot: reset and confirm only the cached address, no conversion
+  sht31_cache_t cache;
+  addr_from_cache = false;
+  if (sensor_cache_load(SENSOR_CACHE_KEY_SHT31, &cache, sizeof(cache))
+      && (cache.addr == SHT31_ADDR_PRIMARY || cache.addr == SHT31_ADDR_SECONDARY)) {
+    (void)hal_i2c_write(cache.addr, cmd_reset, sizeof(cmd_reset));
+    sl_sleeptimer_delay_millisecond(SHT31_RESET_TIME_MS);
+    if (read_status(cache.addr)) {
+      detected_addr = cache.addr;
+      addr_from_cache = true;
+      return true;
+    }
+    sensor_cache_invalidate(SENSOR_CACHE_KEY_SHT31);
+  }
+
   // Soft reset may fail if another sensor is on the bus; we still try measurement.
   (void)hal_i2c_write(SHT31_ADDR_PRIMARY, cmd_reset, sizeof(cmd_reset));
   (void)hal_i2c_write(SHT31_ADDR_SECONDARY, cmd_reset, sizeof(cmd_reset));
-  sl_sleeptimer_delay_millisecond(2);
+  sl_sleeptimer_delay_millisecond(SHT31_RESET_TIME_MS);
 
   if (try_measure(SHT31_ADDR_PRIMARY, &sample)) {
     detected_addr = SHT31_ADDR_PRIMARY;
+  } else if (try_measure(SHT31_ADDR_SECONDARY, &sample)) {
+    detected_addr = SHT31_ADDR_SECONDARY;
+  } else {
+    return false;
+  }
+
+  cache.addr = detected_addr;
+  (void)sensor_cache_store(SENSOR_CACHE_KEY_SHT31, &cache, sizeof(cache));
+  return true;
+}
+
+bool sht31_start_measurement(void)
+{
+  if (detected_addr == 0 || conversion_active) {
+    return false;
+  }
+  if (periodic_active) {
+    // Sensor converts on its own; the result is fetched right away.
+    conversion_done = true;
+    conversion_active = true;
     return true;
   }
+  if (!send_measure_command(detected_addr)) {
+    return check_cached_addr(false);
+  }
 
-  if (try_measure(SHT31_ADDR_SECONDARY, &sample)) {
-    detected_addr = SHT31_ADDR_SECONDARY;
+  uint32_t wait_ms = conversion_wait_ms();
+  if (wait_ms == 0u) {
+    conversion_done = true;
+    conversion_active = true;
+    return true;
+  }
+
+  conversion_done = false;
+  if (sl_sleeptimer_start_timer_ms(&conversion_timer,
+                                   wait_ms,
+                                   conversion_timer_callback,
+                                   NULL,
+                                   0,
+                                   0) != SL_STATUS_OK) {
+    return false;
+  }
+  conversion_active = true;
+  return true;
+}
+
+bool sht31_measurement_ready(void)
+{
+  return conversion_active && conversion_done;
+}
+
+bool sht31_fetch_data(sht31_data_t *data)
+{
+  if (data == NULL || !sht31_measurement_ready()) {
+    return false;
+  }
+  conversion_active = false;
+  if (periodic_active) {
+    return check_cached_addr(fetch_periodic(data));
+  }
+  return check_cached_addr(read_result(detected_addr, data));
+}
+
+uint32_t sht31_get_periodic_period_ms(sht31_periodic_rate_t rate)
+{
+  if (rate >= SHT31_RATE_COUNT) {
+    return 0;
+  }
+  return periodic_period_ms[rate];
+}
+
+sht31_periodic_rate_t sht31_select_periodic_rate(uint32_t interval_ms)
+{
+  // Slowest rate that still produces a fresh sample every interval
+  for (uint8_t rate = 0; rate < SHT31_RATE_COUNT; rate++) {
+    if (periodic_period_ms[rate] <= interval_ms) {
+      return (sht31_periodic_rate_t)rate;
+    }
+  }
+  return SHT31_RATE_10_MPS;
+}
+
+void sht31_estimate_energy(uint32_t interval_ms, sht31_energy_estimate_t *estimate)
+{
+  if (estimate == NULL) {
+    return;
+  }
+
+  // Charge of one conversion: uA * us = pC, divide by 1000 for nC.
+  uint32_t conv_nc = (SHT31_IDD_MEASURE_UA * measure_time_typ_us[repeatability]) / 1000u;
+
+  // Single-shot: one conversion plus its own MCU wake, idle current otherwise.
+  // nA * ms = pC, divide by 1000 for nC.
+  estimate->single_shot_nc = conv_nc + SHT31_WAKE_CHARGE_NC
+                             + (uint32_t)(((uint64_t)SHT31_IDD_IDLE_NA * interval_ms) / 1000u);
+
+  // Periodic: conversions at the selected rate for the whole interval.
+  uint32_t period_ms = periodic_period_ms[sht31_select_periodic_rate(interval_ms)];
+  uint32_t conversions = (interval_ms + period_ms - 1u) / period_ms;
+  estimate->periodic_nc = (conversions * conv_nc)
+                          + (uint32_t)(((uint64_t)SHT31_IDD_PERIODIC_IDLE_NA * interval_ms) / 1000u);
+}
+
+bool sht31_set_sample_interval(uint32_t interval_ms)
+{
+  bool want_periodic = false;
+
+  if (detected_addr == 0 || interval_ms == 0) {
+    return false;
+  }
+
+  if (SHT31_ACQUISITION_MODE == SHT31_ACQ_PERIODIC) {
+    want_periodic = true;
+  } else if (SHT31_ACQUISITION_MODE == SHT31_ACQ_AUTO) {
+    sht31_energy_estimate_t estimate;
+    sht31_estimate_energy(interval_ms, &estimate);
+    want_periodic = estimate.periodic_nc < estimate.single_shot_nc;
+  }
+
+  sht31_periodic_rate_t rate = sht31_select_periodic_rate(interval_ms);
+  if (want_periodic == periodic_active && (!want_periodic || rate == periodic_rate)) {
     return true;
   }
 
-  return false;
+  // Let an in-flight single-shot conversion be discarded cleanly
+  if (conversion_active) {
+    (void)sl_sleeptimer_stop_timer(&conversion_timer);
+    conversion_active = false;
+  }
+
+  stop_periodic();
+  if (!want_periodic) {
+    return true;
+  }
+
+  if (!send_command(detected_addr, periodic_commands[rate][repeatability])) {
+    return false;
+  }
+  periodic_active = true;
+  periodic_rate = rate;
+  periodic_have_sample = false;
+  return true;
 }
 
-bool sht31_read_data(sht31_data_t *data)
+bool sht31_set_measurement_mode(sht31_repeatability_t new_repeatability, bool new_clock_stretch)
 {
-  if (data == NULL || detected_addr == 0) {
+  if (new_repeatability > SHT31_REPEATABILITY_HIGH) {
     return false;
   }
-  return try_measure(detected_addr, data);
+  if (new_repeatability == repeatability && new_clock_stretch == clock_stretch) {
+    return true;
+  }
+
+  repeatability = new_repeatability;
+  clock_stretch = new_clock_stretch;
+
+  // A running periodic acquisition keeps its old repeatability until restarted
+  if (periodic_active && detected_addr != 0) {
+    sht31_periodic_rate_t rate = periodic_rate;
+    stop_periodic();
+    if (!send_command(detected_addr, periodic_commands[rate][repeatability])) {
+      return false;
+    }
+    periodic_active = true;
+  }
+  return true;
+}
+
+uint32_t sht31_get_conversion_time_ms(void)
+{
+  return conversion_time_ms[repeatability];
+}
+
+bool sht31_is_periodic(void)
+{
+  return periodic_active;
+}
+
+sht31_periodic_rate_t sht31_get_periodic_rate(void)
+{
+  return periodic_rate;
 }
 
 uint8_t sht31_get_i2c_addr(void)
@@ -9,8 +9,122 @@ typedef struct {
   uint32_t humidity;   // 0.01 %RH
 } sht31_data_t;
 
+typedef enum {
+  SHT31_REPEATABILITY_LOW = 0,
+  SHT31_REPEATABILITY_MEDIUM,
+  SHT31_REPEATABILITY_HIGH,
+} sht31_repeatability_t;
+
+// Periodic acquisition rates (measurements per second)
+typedef enum {
+  SHT31_RATE_0_5_MPS = 0,
+  SHT31_RATE_1_MPS,
+  SHT31_RATE_2_MPS,
+  SHT31_RATE_4_MPS,
+  SHT31_RATE_10_MPS,
+  SHT31_RATE_COUNT,
+} sht31_periodic_rate_t;
+
+// Values for SHT31_ACQUISITION_MODE
+#define SHT31_ACQ_SINGLE_SHOT 0  // Command + conversion wait on every sample
+#define SHT31_ACQ_PERIODIC    1  // Sensor free-runs, samples read with Fetch Data
+#define SHT31_ACQ_AUTO        2  // Whichever the energy estimate favours
+
+/**
+ * @brief Estimated sensor charge per sample interval
+ */
+typedef struct {
+  uint32_t single_shot_nc;  // Single-shot, including the extra MCU wake
+  uint32_t periodic_nc;     // Periodic at the slowest covering rate
+} sht31_energy_estimate_t;
+
+/**
+ * @brief Detect the sensor at 0x44 or 0x45
+ *
+ * The detected address is cached in NVM (sensor_cache). On a warm boot only
+ * the cached address is reset and confirmed with a status read; the record
+ * is dropped if the first sample read from it fails.
+ *
+ * @return true if a sensor answered
+ */
 bool sht31_init(void);
-bool sht31_read_data(sht31_data_t *data);
 uint8_t sht31_get_i2c_addr(void);
 
+/**
+ * @brief Send a single-shot measurement command and arm the conversion timer
+ *
+ * Returns immediately; the MCU may sleep until sht31_measurement_ready().
+ *
+ * @return true if the command was accepted and the timer armed
+ */
+bool sht31_start_measurement(void);
+
+/**
+ * @brief Check whether a started conversion has had time to complete
+ * @return true when sht31_fetch_data() can be called
+ */
+bool sht31_measurement_ready(void);
+
+/**
+ * @brief Read and decode the result of the started conversion
+ * @param data Output sample
+ * @return true on success, false on I2C/CRC error or no ready conversion
+ */
+bool sht31_fetch_data(sht31_data_t *data);
+
+/**
+ * @brief Choose acquisition mode and periodic rate for a sample interval
+ *
+ * Periodic mode runs at the slowest rate whose period fits in the interval.
+ * Switching modes sends Break first. Call after sht31_init().
+ *
+ * @param interval_ms Application sample interval
+ * @return true on success
+ */
+bool sht31_set_sample_interval(uint32_t interval_ms);
+
+/**
+ * @brief Slowest periodic rate that still yields a new sample per interval
+ */
+sht31_periodic_rate_t sht31_select_periodic_rate(uint32_t interval_ms);
+
+/**
+ * @brief Period of a periodic rate in milliseconds (0 if invalid)
+ */
+uint32_t sht31_get_periodic_period_ms(sht31_periodic_rate_t rate);
+
+/**
+ * @brief Estimate sensor charge per interval for single-shot vs periodic
+ * @param interval_ms Sample interval
+ * @param estimate Output estimate
+ */
+void sht31_estimate_energy(uint32_t interval_ms, sht31_energy_estimate_t *estimate);
+
+/**
+ * @brief Select repeatability and clock stretching for later measurements
+ *
+ * Low/medium/high repeatability convert in at most 4.5/6.5/15.5 ms. With
+ * clock stretching the result is read right after the command and the
+ * sensor holds the bus until done (MCU waits in EM1 rather than EM2).
+ * A running periodic acquisition is restarted with the new repeatability.
+ *
+ * @return false on invalid repeatability or I2C error
+ */
+bool sht31_set_measurement_mode(sht31_repeatability_t repeatability, bool clock_stretch);
+
+/**
+ * @brief Max conversion time of the selected repeatability (ms)
+ */
+uint32_t sht31_get_conversion_time_ms(void);
+
+/**
+ * @brief Check whether periodic acquisition is running
+ */
+bool sht31_is_periodic(void);
+
+/**
+ * @brief Current periodic rate (valid when sht31_is_periodic())
+ */
+sht31_periodic_rate_t sht31_get_periodic_rate(void);
+
 #endif // SHT31_H
@@ -0,0 +1,309 @@
+/**
+ * @file hal_i2c_sim.c
+ * @brief hal_i2c.h on the host, backed by the I2C bus simulator
+ */
+
+#include "hal_i2c.h"
+#include "i2c_sim.h"
+#include "sim_clock.h"
+#include "bme280_board_config.h"
+#include "sl_sleeptimer.h"
+#include <stddef.h>
+#include <string.h>
+
+#define SIM_NS_PER_BIT (1000000000u / BME280_I2C_FREQ)
+
+// Bus recovery on target: up to 9 SCL pulses, STOP and re-init, about 1 ms
+#define SIM_RECOVERY_US 1000u
+
+static i2c_sim_device_t *devices = NULL;
+static i2c_sim_stats_t bus_stats;
+static hal_i2c_stats_t hal_stats;
+static hal_i2c_error_stats_t error_stats;
+static uint32_t transfer_count = 0;
+static bool initialized = false;
+static bool recovery_pending = false;
+
+static i2c_sim_device_t *find_device(uint8_t addr)
+{
+  for (i2c_sim_device_t *device = devices; device != NULL; device = device->next) {
+    if (device->addr == addr) {
+      return device;
+    }
+  }
+  return NULL;
+}
+
+void i2c_sim_reset(void)
+{
+  devices = NULL;
+  memset(&bus_stats, 0, sizeof(bus_stats));
+  memset(&hal_stats, 0, sizeof(hal_stats));
+  memset(&error_stats, 0, sizeof(error_stats));
+  transfer_count = 0;
+  initialized = false;
+  recovery_pending = false;
+}
+
+void i2c_sim_attach(i2c_sim_device_t *device)
+{
+  memset(&device->stats, 0, sizeof(device->stats));
+  device->nack_count = 0;
+  device->stretch_count = 0;
+  device->stretch_us = 0;
+  device->next = devices;
+  devices = device;
+}
+
+void i2c_sim_detach(i2c_sim_device_t *device)
+{
+  for (i2c_sim_device_t **link = &devices; *link != NULL; link = &(*link)->next) {
+    if (*link == device) {
+      *link = device->next;
+      device->next = NULL;
+      return;
+    }
+  }
+}
+
+void i2c_sim_inject_nack(i2c_sim_device_t *device, uint32_t count)
+{
+  device->nack_count = count;
+}
+
+void i2c_sim_inject_stretch(i2c_sim_device_t *device, uint32_t count, uint32_t stretch_us)
+{
+  device->stretch_count = count;
+  device->stretch_us = stretch_us;
+}
+
+void i2c_sim_get_stats(i2c_sim_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = bus_stats;
+  }
+}
+
+void i2c_sim_reset_stats(void)
+{
+  memset(&bus_stats, 0, sizeof(bus_stats));
+  for (i2c_sim_device_t *device = devices; device != NULL; device = device->next) {
+    memset(&device->stats, 0, sizeof(device->stats));
+  }
+}
+
+// Hold the bus for some bits (plus stretching) and let time move on
+static void hold_bus(i2c_sim_stats_t *device_stats, uint32_t bits, uint64_t stretch_ns)
+{
+  uint64_t ns = (uint64_t)bits * SIM_NS_PER_BIT + stretch_ns;
+
+  bus_stats.bus_ns += ns;
+  bus_stats.stretch_ns += stretch_ns;
+  if (device_stats != NULL) {
+    device_stats->bus_ns += ns;
+    device_stats->stretch_ns += stretch_ns;
+  }
+  sim_clock_advance_us(ns / 1000u);
+}
+
+static hal_i2c_status_t run_transfer(hal_i2c_transfer_t *transfer)
+{
+  i2c_sim_device_t *device = find_device(transfer->addr);
+  i2c_sim_stats_t *device_stats = (device != NULL) ? &device->stats : NULL;
+  uint32_t timeout_ms = (transfer->timeout_ms != 0u) ? transfer->timeout_ms
+                                                     : HAL_I2C_DEFAULT_TIMEOUT_MS;
+  uint64_t start_ns = bus_stats.bus_ns;
+
+  bus_stats.transactions++;
+  if (device_stats != NULL) {
+    device_stats->transactions++;
+  }
+
+  // START, address + ACK/NACK
+  if (device == NULL || device->nack_count > 0u) {
+    if (device != NULL) {
+      device->nack_count--;
+      device_stats->nacks++;
+    }
+    bus_stats.nacks++;
+    hold_bus(device_stats, 1u + 9u + 1u, 0);
+    return HAL_I2C_STATUS_NACK;
+  }
+  hold_bus(device_stats, 1u + 9u, 0);
+
+  if (transfer->tx_len != 0u) {
+    hold_bus(device_stats, 9u * transfer->tx_len, 0);
+    bus_stats.bytes += transfer->tx_len;
+    device_stats->bytes += transfer->tx_len;
+    if (!device->ops->write(device, transfer->tx_data, transfer->tx_len)) {
+      bus_stats.nacks++;
+      device_stats->nacks++;
+      hold_bus(device_stats, 1u, 0);
+      return HAL_I2C_STATUS_NACK;
+    }
+  }
+
+  if (transfer->rx_len != 0u) {
+    uint32_t stretch_us = 0;
+
+    if (transfer->tx_len != 0u) {
+      hold_bus(device_stats, 1u + 9u, 0);  // Repeated START, address + R
+    }
+    if (!device->ops->read(device, transfer->rx_data, transfer->rx_len, &stretch_us)) {
+      bus_stats.nacks++;
+      device_stats->nacks++;
+      hold_bus(device_stats, 1u, 0);
+      return HAL_I2C_STATUS_NACK;
+    }
+    if (device->stretch_count > 0u) {
+      device->stretch_count--;
+      stretch_us += device->stretch_us;
+    }
+
+    // A stretch past the deadline ends the transfer at the deadline
+    uint64_t deadline_ns = (uint64_t)timeout_ms * 1000000u;
+    uint64_t elapsed_ns = bus_stats.bus_ns - start_ns;
+    if (elapsed_ns + (uint64_t)stretch_us * 1000u > deadline_ns) {
+      bus_stats.timeouts++;
+      device_stats->timeouts++;
+      hold_bus(device_stats, 0, deadline_ns - elapsed_ns);
+      return HAL_I2C_STATUS_TIMEOUT;
+    }
+    hold_bus(device_stats, 9u * transfer->rx_len, (uint64_t)stretch_us * 1000u);
+    bus_stats.bytes += transfer->rx_len;
+    device_stats->bytes += transfer->rx_len;
+  }
+
+  hold_bus(device_stats, 1u, 0);  // STOP
+  return HAL_I2C_STATUS_OK;
+}
+
+bool hal_i2c_init(void)
+{
+  initialized = true;
+  return true;
+}
+
+bool hal_i2c_submit(hal_i2c_transfer_t *transfer)
+{
+  if (!initialized || transfer == NULL || transfer->busy
+      || (transfer->tx_len == 0u && transfer->rx_len == 0u)
+      || (transfer->tx_len != 0u && transfer->tx_data == NULL)
+      || (transfer->rx_len != 0u && transfer->rx_data == NULL)) {
+    return false;
+  }
+
+  if (recovery_pending) {
+    (void)hal_i2c_recover_bus();
+  }
+
+  // The simulated bus is never busy: the transfer runs to completion here,
+  // and the callback runs as it would from the I2C IRQ.
+  transfer->busy = true;
+  hal_i2c_status_t status = run_transfer(transfer);
+
+  transfer_count++;
+  hal_stats.transfers++;
+  hal_stats.bytes += (uint32_t)transfer->tx_len + transfer->rx_len;
+  if (status != HAL_I2C_STATUS_OK) {
+    hal_stats.errors++;
+  }
+  switch (status) {
+    case HAL_I2C_STATUS_NACK:
+      error_stats.nack++;
+      break;
+    case HAL_I2C_STATUS_TIMEOUT:
+      error_stats.timeout++;
+      recovery_pending = true;
+      break;
+    default:
+      break;
+  }
+
+  transfer->status = status;
+  transfer->busy = false;
+  if (transfer->callback != NULL) {
+    transfer->callback(transfer, status);
+  }
+  return true;
+}
+
+bool hal_i2c_is_idle(void)
+{
+  return true;
+}
+
+hal_i2c_status_t hal_i2c_transfer_blocking(hal_i2c_transfer_t *transfer)
+{
+  uint32_t start_ticks = sl_sleeptimer_get_tick_count();
+
+  if (!hal_i2c_submit(transfer)) {
+    return HAL_I2C_STATUS_BUS_ERROR;
+  }
+  hal_stats.wait_ticks += sl_sleeptimer_get_tick_count() - start_ticks;
+  return transfer->status;
+}
+
+void hal_i2c_get_stats(hal_i2c_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = hal_stats;
+  }
+}
+
+void hal_i2c_reset_stats(void)
+{
+  memset(&hal_stats, 0, sizeof(hal_stats));
+}
+
+void hal_i2c_get_error_stats(hal_i2c_error_stats_t *stats)
+{
+  if (stats != NULL) {
+    *stats = error_stats;
+  }
+}
+
+uint32_t hal_i2c_get_transfer_count(void)
+{
+  return transfer_count;
+}
+
+bool hal_i2c_recover_bus(void)
+{
+  recovery_pending = false;
+  error_stats.recoveries++;
+  sim_clock_advance_us(SIM_RECOVERY_US);
+  return true;
+}
+
+bool hal_i2c_write(uint8_t addr, const uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .tx_data = data,
+    .tx_len = len,
+  };
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
+}
+
+bool hal_i2c_read(uint8_t addr, uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .rx_data = data,
+    .rx_len = len,
+  };
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
+}
+
+bool hal_i2c_write_read(uint8_t addr, uint8_t reg_addr, uint8_t *data, uint16_t len)
+{
+  hal_i2c_transfer_t transfer = {
+    .addr = addr,
+    .tx_data = &reg_addr,
+    .tx_len = 1,
+    .rx_data = data,
+    .rx_len = len,
+  };
+  return hal_i2c_transfer_blocking(&transfer) == HAL_I2C_STATUS_OK;
+}
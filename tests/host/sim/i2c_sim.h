@@ -0,0 +1,106 @@
+/**
+ * @file i2c_sim.h
+ * @brief Host I2C bus simulator behind the hal_i2c.h API
+ *
+ * hal_i2c_sim.c implements hal_i2c.h on the host. Each transfer is routed to
+ * the device model registered at its address and completes synchronously.
+ * Bus time is charged to the simulated clock: START, address + ACK, 9 SCL
+ * clocks per byte, repeated START and STOP at BME280_I2C_FREQ, plus any
+ * clock stretching by the device. Transactions, bytes and bus time are
+ * counted for the whole bus and per device, so a test can measure the bus
+ * occupancy of one driver sample.
+ *
+ * Faults: a device can be told to NACK its next transactions or to stretch
+ * the clock on its next reads; device models add their own (see
+ * sim_sht31.h for CRC corruption). A stretch past the transfer's deadline
+ * completes with HAL_I2C_STATUS_TIMEOUT.
+ */
+
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct i2c_sim_device i2c_sim_device_t;
+
+/**
+ * @brief Device model callbacks (called after the address was ACKed)
+ */
+typedef struct {
+  // Write phase. Return false to NACK a data byte.
+  bool (*write)(i2c_sim_device_t *device, const uint8_t *data, uint16_t len);
+  // Read phase. Return false to NACK the read address (no data ready).
+  // *stretch_us is the time SCL is held low before the first data byte.
+  bool (*read)(i2c_sim_device_t *device, uint8_t *data, uint16_t len, uint32_t *stretch_us);
+} i2c_sim_ops_t;
+
+/**
+ * @brief Bus occupancy counters
+ */
+typedef struct {
+  uint32_t transactions;  // Transfers addressed (a write + repeated-START read is one)
+  uint32_t bytes;         // Data bytes written + read, address bytes excluded
+  uint32_t nacks;         // Transfers that ended with a NACK
+  uint32_t timeouts;      // Transfers that ran past their deadline
+  uint64_t bus_ns;        // Time the bus was held, stretching included
+  uint64_t stretch_ns;    // Part of bus_ns spent in clock stretching
+} i2c_sim_stats_t;
+
+struct i2c_sim_device {
+  uint8_t addr;               // 7-bit address
+  const i2c_sim_ops_t *ops;
+  i2c_sim_stats_t stats;      // Transfers addressed to this device
+
+  // Fault injection, consumed per transaction
+  uint32_t nack_count;        // NACK the address of the next N transactions
+  uint32_t stretch_count;     // Add stretch_us to the next N reads
+  uint32_t stretch_us;
+
+  i2c_sim_device_t *next;
+};
+
+/**
+ * @brief Remove every device and clear the bus counters
+ */
+void i2c_sim_reset(void);
+
+/**
+ * @brief Attach a device model (addr and ops must be set)
+ * @param device Model instance, kept until i2c_sim_reset()
+ */
+void i2c_sim_attach(i2c_sim_device_t *device);
+
+/**
+ * @brief Detach a device; its address then NACKs
+ * @param device Model instance
+ */
+void i2c_sim_detach(i2c_sim_device_t *device);
+
+/**
+ * @brief NACK the address of the next transactions to a device
+ * @param device Model instance
+ * @param count Number of transactions
+ */
+void i2c_sim_inject_nack(i2c_sim_device_t *device, uint32_t count);
+
+/**
+ * @brief Stretch the clock on the next reads from a device
+ * @param device Model instance
+ * @param count Number of reads
+ * @param stretch_us Extra time SCL is held per read
+ */
+void i2c_sim_inject_stretch(i2c_sim_device_t *device, uint32_t count, uint32_t stretch_us);
+
+/**
+ * @brief Snapshot the whole-bus counters
+ * @param stats Output
+ */
+void i2c_sim_get_stats(i2c_sim_stats_t *stats);
+
+/**
+ * @brief Clear the whole-bus and per-device counters
+ */
+void i2c_sim_reset_stats(void);
+
+#endif // I2C_SIM_H
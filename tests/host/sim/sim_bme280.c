@@ -0,0 +1,214 @@
+/**
+ * @file sim_bme280.c
+ * @brief BME280 / BMP280 register model for the I2C simulator
+ */
+
+#include "sim_bme280.h"
+#include "sim_clock.h"
+#include <string.h>
+
+#define REG_CALIB_00_LEN  26u
+#define REG_DATA_LEN      8u
+#define RESET_VALUE       0xB6u
+
+static uint32_t oversampling_count(uint8_t osrs)
+{
+  if (osrs == BME280_OSRS_SKIP) {
+    return 0;
+  }
+  if (osrs > BME280_OSRS_X16) {
+    osrs = BME280_OSRS_X16;
+  }
+  return 1u << (osrs - 1u);
+}
+
+// Datasheet 9.1 t_meas,typ: 1 ms + 2 ms per temperature/pressure/humidity
+// sample, 0.5 ms set-up for pressure and humidity
+static uint32_t conversion_time_us(const sim_bme280_t *sim)
+{
+  uint8_t ctrl_meas = sim->regs[BME280_REG_CTRL_MEAS];
+  uint32_t os_t = oversampling_count((uint8_t)(ctrl_meas >> 5));
+  uint32_t os_p = oversampling_count((uint8_t)((ctrl_meas >> 2) & 0x07u));
+  uint32_t os_h = (sim->chip_id == BME280_CHIP_ID)
+                  ? oversampling_count(sim->regs[BME280_REG_CTRL_HUM] & 0x07u) : 0u;
+  uint32_t t_us = 1000u + (2000u * os_t);
+
+  if (os_p != 0u) {
+    t_us += (2000u * os_p) + 500u;
+  }
+  if (os_h != 0u) {
+    t_us += (2000u * os_h) + 500u;
+  }
+  return t_us;
+}
+
+static void latch_data(sim_bme280_t *sim)
+{
+  uint8_t *data = &sim->regs[BME280_REG_PRESS_MSB];
+
+  data[0] = (uint8_t)(sim->adc_P >> 12);
+  data[1] = (uint8_t)(sim->adc_P >> 4);
+  data[2] = (uint8_t)((sim->adc_P & 0x0F) << 4);
+  data[3] = (uint8_t)(sim->adc_T >> 12);
+  data[4] = (uint8_t)(sim->adc_T >> 4);
+  data[5] = (uint8_t)((sim->adc_T & 0x0F) << 4);
+  if (sim->chip_id == BME280_CHIP_ID) {
+    data[6] = (uint8_t)(sim->adc_H >> 8);
+    data[7] = (uint8_t)sim->adc_H;
+  } else {
+    data[6] = 0;
+    data[7] = 0;
+  }
+}
+
+// Finish a conversion whose time is up
+static void update(sim_bme280_t *sim)
+{
+  if (sim->converting && sim_clock_now_us() >= sim->conversion_end_us) {
+    sim->converting = false;
+    latch_data(sim);
+    // Forced mode: back to sleep
+    sim->regs[BME280_REG_CTRL_MEAS] &= (uint8_t)~0x03u;
+  }
+  sim->regs[BME280_REG_STATUS] = sim->converting ? BME280_STATUS_MEASURING : 0u;
+}
+
+static void power_on_registers(sim_bme280_t *sim)
+{
+  // Calibration and ID are NVM-backed; the control registers reset
+  sim->regs[BME280_REG_CTRL_HUM] = 0;
+  sim->regs[BME280_REG_STATUS] = 0;
+  sim->regs[BME280_REG_CTRL_MEAS] = 0;
+  sim->regs[BME280_REG_CONFIG] = 0;
+  // Data registers read 0x80000 (skipped) until the first conversion
+  memset(&sim->regs[BME280_REG_PRESS_MSB], 0, REG_DATA_LEN);
+  sim->regs[BME280_REG_PRESS_MSB] = 0x80;
+  sim->regs[BME280_REG_PRESS_MSB + 3u] = 0x80;
+  sim->regs[BME280_REG_PRESS_MSB + 6u] = 0x80;
+  sim->converting = false;
+}
+
+static void write_reg(sim_bme280_t *sim, uint8_t reg, uint8_t value)
+{
+  switch (reg) {
+    case BME280_REG_RESET:
+      if (value == RESET_VALUE) {
+        power_on_registers(sim);
+        sim->resets++;
+      }
+      break;
+    case BME280_REG_CTRL_HUM:
+      if (sim->chip_id == BME280_CHIP_ID) {
+        sim->regs[reg] = value & 0x07u;
+      }
+      break;
+    case BME280_REG_CONFIG:
+      // Ignored in normal mode (datasheet 5.4.6)
+      if ((sim->regs[BME280_REG_CTRL_MEAS] & 0x03u) != BME280_MODE_NORMAL) {
+        sim->regs[reg] = value;
+      }
+      break;
+    case BME280_REG_CTRL_MEAS:
+      sim->regs[reg] = value;
+      if ((value & 0x03u) == BME280_MODE_FORCED || (value & 0x03u) == 0x02u) {
+        sim->converting = true;
+        sim->conversion_end_us = sim_clock_now_us() + conversion_time_us(sim)
+                                 + sim->extra_conversion_us;
+        sim->conversions++;
+      } else if ((value & 0x03u) == BME280_MODE_NORMAL) {
+        sim->converting = false;
+        latch_data(sim);
+      }
+      break;
+    default:
+      // Read-only
+      break;
+  }
+}
+
+static bool bme280_write(i2c_sim_device_t *device, const uint8_t *data, uint16_t len)
+{
+  sim_bme280_t *sim = (sim_bme280_t *)device;
+
+  update(sim);
+  // A lone byte sets the read pointer; pairs are register/value writes
+  sim->reg_ptr = data[0];
+  for (uint16_t i = 0; i + 1u < len; i += 2u) {
+    write_reg(sim, data[i], data[i + 1u]);
+  }
+  update(sim);
+  return true;
+}
+
+static bool bme280_read(i2c_sim_device_t *device, uint8_t *data, uint16_t len, uint32_t *stretch_us)
+{
+  sim_bme280_t *sim = (sim_bme280_t *)device;
+
+  *stretch_us = 0;
+  update(sim);
+  if ((sim->regs[BME280_REG_CTRL_MEAS] & 0x03u) == BME280_MODE_NORMAL) {
+    latch_data(sim);
+  }
+  for (uint16_t i = 0; i < len; i++) {
+    data[i] = sim->regs[sim->reg_ptr];
+    sim->reg_ptr++;
+  }
+  return true;
+}
+
+static const i2c_sim_ops_t bme280_ops = {
+  .write = bme280_write,
+  .read = bme280_read,
+};
+
+static void put_u16(uint8_t *reg, uint16_t value)
+{
+  reg[0] = (uint8_t)value;
+  reg[1] = (uint8_t)(value >> 8);
+}
+
+void sim_bme280_init(sim_bme280_t *sim, uint8_t addr, uint8_t chip_id,
+                     const bme280_calib_data_t *calib)
+{
+  uint8_t *reg;
+
+  memset(sim, 0, sizeof(*sim));
+  sim->device.addr = addr;
+  sim->device.ops = &bme280_ops;
+  sim->chip_id = chip_id;
+  sim->regs[BME280_REG_ID] = chip_id;
+
+  reg = &sim->regs[BME280_REG_CALIB_00];
+  put_u16(&reg[0], calib->dig_T1);
+  put_u16(&reg[2], (uint16_t)calib->dig_T2);
+  put_u16(&reg[4], (uint16_t)calib->dig_T3);
+  put_u16(&reg[6], calib->dig_P1);
+  put_u16(&reg[8], (uint16_t)calib->dig_P2);
+  put_u16(&reg[10], (uint16_t)calib->dig_P3);
+  put_u16(&reg[12], (uint16_t)calib->dig_P4);
+  put_u16(&reg[14], (uint16_t)calib->dig_P5);
+  put_u16(&reg[16], (uint16_t)calib->dig_P6);
+  put_u16(&reg[18], (uint16_t)calib->dig_P7);
+  put_u16(&reg[20], (uint16_t)calib->dig_P8);
+  put_u16(&reg[22], (uint16_t)calib->dig_P9);
+
+  if (chip_id == BME280_CHIP_ID) {
+    reg[REG_CALIB_00_LEN - 1u] = calib->dig_H1;
+    reg = &sim->regs[BME280_REG_CALIB_26];
+    put_u16(&reg[0], (uint16_t)calib->dig_H2);
+    reg[2] = calib->dig_H3;
+    reg[3] = (uint8_t)(calib->dig_H4 >> 4);
+    reg[4] = (uint8_t)((calib->dig_H4 & 0x0F) | ((calib->dig_H5 & 0x0F) << 4));
+    reg[5] = (uint8_t)(calib->dig_H5 >> 4);
+    reg[6] = (uint8_t)calib->dig_H6;
+  }
+
+  power_on_registers(sim);
+}
+
+void sim_bme280_set_adc(sim_bme280_t *sim, int32_t adc_T, int32_t adc_P, int32_t adc_H)
+{
+  sim->adc_T = adc_T;
+  sim->adc_P = adc_P;
+  sim->adc_H = adc_H;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file sim_bme280.h
+ * @brief BME280 / BMP280 register model for the I2C simulator
+ *
+ * Register map per the Bosch datasheets: chip ID, soft reset, CTRL_HUM,
+ * STATUS, CTRL_MEAS, CONFIG, the calibration blocks at 0x88 and 0xE1, and
+ * the data registers at 0xF7. Writes are register/value pairs and reads
+ * auto-increment from the last written register address.
+ *
+ * A forced-mode CTRL_MEAS write starts one conversion that takes the
+ * datasheet typical t_meas for the oversampling written (plus any injected
+ * delay); STATUS.measuring is set until it ends, the data registers latch
+ * the configured raw ADC values at the end and the mode returns to sleep.
+ * In normal mode the data registers always hold the latest values.
+ */
+
+#ifndef SIM_BME280_H
+#define SIM_BME280_H
+
+#include "i2c_sim.h"
+#include "bme280_min.h"
+
+typedef struct {
+  i2c_sim_device_t device;    // Must be first
+
+  uint8_t chip_id;            // BME280_CHIP_ID or BMP280_CHIP_ID
+  uint8_t regs[256];
+  uint8_t reg_ptr;
+
+  // Raw ADC values the next conversion latches
+  int32_t adc_T;
+  int32_t adc_P;
+  int32_t adc_H;
+
+  bool converting;
+  uint64_t conversion_end_us;
+  uint32_t extra_conversion_us;  // Fault: convert slower than t_meas,typ
+
+  uint32_t conversions;       // Forced conversions started
+  uint32_t resets;            // Soft resets
+} sim_bme280_t;
+
+/**
+ * @brief Set up a model in its power-on state (not attached)
+ * @param sim Model instance
+ * @param addr 7-bit address (0x76 or 0x77)
+ * @param chip_id BME280_CHIP_ID or BMP280_CHIP_ID
+ * @param calib Trimming coefficients to expose (humidity ignored for BMP280)
+ */
+void sim_bme280_init(sim_bme280_t *sim, uint8_t addr, uint8_t chip_id,
+                     const bme280_calib_data_t *calib);
+
+/**
+ * @brief Raw ADC values for the following conversions
+ * @param sim Model instance
+ * @param adc_T 20-bit temperature
+ * @param adc_P 20-bit pressure
+ * @param adc_H 16-bit humidity (BME280 only)
+ */
+void sim_bme280_set_adc(sim_bme280_t *sim, int32_t adc_T, int32_t adc_P, int32_t adc_H);
+
+#endif // SIM_BME280_H
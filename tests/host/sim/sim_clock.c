@@ -0,0 +1,144 @@
+/**
+ * @file sim_clock.c
+ * @brief Simulated time and sleeptimer for host tests
+ */
+
+#include "sim_clock.h"
+#include "sl_sleeptimer.h"
+#include <stddef.h>
+
+#define SIM_CLOCK_MAX_TIMERS 8u
+
+static uint64_t now_us = 0;
+static sl_sleeptimer_timer_handle_t *timers[SIM_CLOCK_MAX_TIMERS];
+
+static sl_sleeptimer_timer_handle_t *next_timer(void)
+{
+  sl_sleeptimer_timer_handle_t *next = NULL;
+
+  for (uint32_t i = 0; i < SIM_CLOCK_MAX_TIMERS; i++) {
+    if (timers[i] != NULL && (next == NULL || timers[i]->expiry_us < next->expiry_us)) {
+      next = timers[i];
+    }
+  }
+  return next;
+}
+
+static void remove_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  for (uint32_t i = 0; i < SIM_CLOCK_MAX_TIMERS; i++) {
+    if (timers[i] == handle) {
+      timers[i] = NULL;
+    }
+  }
+  handle->running = false;
+}
+
+static void fire(sl_sleeptimer_timer_handle_t *handle)
+{
+  remove_timer(handle);
+  handle->callback(handle, handle->callback_data);
+}
+
+void sim_clock_reset(void)
+{
+  for (uint32_t i = 0; i < SIM_CLOCK_MAX_TIMERS; i++) {
+    if (timers[i] != NULL) {
+      timers[i]->running = false;
+      timers[i] = NULL;
+    }
+  }
+  now_us = 0;
+}
+
+uint64_t sim_clock_now_us(void)
+{
+  return now_us;
+}
+
+void sim_clock_advance_us(uint64_t us)
+{
+  uint64_t end_us = now_us + us;
+  sl_sleeptimer_timer_handle_t *next;
+
+  while ((next = next_timer()) != NULL && next->expiry_us <= end_us) {
+    if (next->expiry_us > now_us) {
+      now_us = next->expiry_us;
+    }
+    fire(next);
+  }
+  now_us = end_us;
+}
+
+bool sim_clock_run_next_timer(void)
+{
+  sl_sleeptimer_timer_handle_t *next = next_timer();
+
+  if (next == NULL) {
+    return false;
+  }
+  if (next->expiry_us > now_us) {
+    now_us = next->expiry_us;
+  }
+  fire(next);
+  return true;
+}
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return (uint32_t)((now_us * SIM_CLOCK_TICK_HZ) / 1000000u);
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+  return SIM_CLOCK_TICK_HZ;
+}
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick)
+{
+  return (uint32_t)(((uint64_t)tick * 1000u) / SIM_CLOCK_TICK_HZ);
+}
+
+void sl_sleeptimer_delay_millisecond(uint16_t time_ms)
+{
+  sim_clock_advance_us((uint64_t)time_ms * 1000u);
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+
+  if (handle == NULL || callback == NULL) {
+    return SL_STATUS_FAIL;
+  }
+  // Like the SDK, a running handle must be stopped (or restarted) first
+  if (handle->running) {
+    return SL_STATUS_NOT_READY;
+  }
+  for (uint32_t i = 0; i < SIM_CLOCK_MAX_TIMERS; i++) {
+    if (timers[i] == NULL) {
+      handle->callback = callback;
+      handle->callback_data = callback_data;
+      handle->expiry_us = now_us + (uint64_t)timeout_ms * 1000u;
+      handle->running = true;
+      timers[i] = handle;
+      return SL_STATUS_OK;
+    }
+  }
+  return SL_STATUS_FAIL;
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  if (handle == NULL || !handle->running) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  remove_timer(handle);
+  return SL_STATUS_OK;
+}
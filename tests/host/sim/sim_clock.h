@@ -0,0 +1,43 @@
+/**
+ * @file sim_clock.h
+ * @brief Simulated time and sleeptimer for host tests
+ *
+ * Time only moves when a test advances it, when a driver busy-waits with
+ * sl_sleeptimer_delay_millisecond(), or when the I2C simulator charges a
+ * transfer's bus time. Sleeptimer callbacks run from sim_clock_advance_us()
+ * in expiry order, standing in for the sleeptimer IRQ.
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sleeptimer tick rate (LFXO on target)
+#define SIM_CLOCK_TICK_HZ 32768u
+
+/**
+ * @brief Reset time to 0 and drop all running timers
+ */
+void sim_clock_reset(void);
+
+/**
+ * @brief Current simulated time
+ * @return Microseconds since sim_clock_reset()
+ */
+uint64_t sim_clock_now_us(void);
+
+/**
+ * @brief Move time forward, running every timer that expires on the way
+ * @param us Microseconds to advance
+ */
+void sim_clock_advance_us(uint64_t us);
+
+/**
+ * @brief Advance to the next timer expiry and run it
+ * @return false if no timer is running
+ */
+bool sim_clock_run_next_timer(void);
+
+#endif // SIM_CLOCK_H
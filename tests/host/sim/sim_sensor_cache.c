@@ -0,0 +1,93 @@
+/**
+ * @file sim_sensor_cache.c
+ * @brief In-memory sensor_cache.h for host tests
+ */
+
+#include "sim_sensor_cache.h"
+#include <string.h>
+
+#define SIM_CACHE_SLOTS 4u
+
+typedef struct {
+  bool used;
+  uint32_t key;
+  uint16_t len;
+  uint8_t data[SENSOR_CACHE_MAX_LEN];
+} sim_cache_record_t;
+
+static sim_cache_record_t records[SIM_CACHE_SLOTS];
+static uint32_t writes = 0;
+
+static sim_cache_record_t *find(uint32_t key)
+{
+  for (uint32_t i = 0; i < SIM_CACHE_SLOTS; i++) {
+    if (records[i].used && records[i].key == key) {
+      return &records[i];
+    }
+  }
+  return NULL;
+}
+
+void sim_sensor_cache_reset(void)
+{
+  memset(records, 0, sizeof(records));
+  writes = 0;
+}
+
+bool sim_sensor_cache_has(uint32_t key)
+{
+  return find(key) != NULL;
+}
+
+uint32_t sim_sensor_cache_writes(void)
+{
+  return writes;
+}
+
+bool sensor_cache_load(uint32_t key, void *data, uint16_t len)
+{
+  sim_cache_record_t *record = find(key);
+
+  if (record == NULL || record->len != len) {
+    return false;
+  }
+  memcpy(data, record->data, len);
+  return true;
+}
+
+bool sensor_cache_store(uint32_t key, const void *data, uint16_t len)
+{
+  sim_cache_record_t *record = find(key);
+
+  if (len > SENSOR_CACHE_MAX_LEN) {
+    return false;
+  }
+  if (record != NULL && record->len == len && memcmp(record->data, data, len) == 0) {
+    return true;
+  }
+  if (record == NULL) {
+    for (uint32_t i = 0; i < SIM_CACHE_SLOTS && record == NULL; i++) {
+      if (!records[i].used) {
+        record = &records[i];
+      }
+    }
+    if (record == NULL) {
+      return false;
+    }
+  }
+  record->used = true;
+  record->key = key;
+  record->len = len;
+  memcpy(record->data, data, len);
+  writes++;
+  return true;
+}
+
+void sensor_cache_invalidate(uint32_t key)
+{
+  sim_cache_record_t *record = find(key);
+
+  if (record != NULL) {
+    record->used = false;
+  }
+}
@@ -0,0 +1,31 @@
+/**
+ * @file sim_sensor_cache.h
+ * @brief In-memory sensor_cache.h for host tests
+ *
+ * Stands in for the NVM3-backed cache: records survive a driver re-init
+ * (a simulated warm boot) until sim_sensor_cache_reset() (a flash erase).
+ */
+
+#ifndef SIM_SENSOR_CACHE_H
+#define SIM_SENSOR_CACHE_H
+
+#include "sensor_cache.h"
+
+/**
+ * @brief Drop every record
+ */
+void sim_sensor_cache_reset(void);
+
+/**
+ * @brief Check whether a record is stored
+ * @param key SENSOR_CACHE_KEY_*
+ * @return true if present
+ */
+bool sim_sensor_cache_has(uint32_t key);
+
+/**
+ * @brief Records written since sim_sensor_cache_reset() (unchanged ones skipped)
+ */
+uint32_t sim_sensor_cache_writes(void);
+
+#endif // SIM_SENSOR_CACHE_H
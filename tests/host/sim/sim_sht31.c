@@ -0,0 +1,206 @@
+/**
+ * @file sim_sht31.c
+ * @brief SHT31 command model for the I2C simulator
+ */
+
+#include "sim_sht31.h"
+#include "sim_clock.h"
+#include <string.h>
+
+#define CMD_SOFT_RESET   0x30A2u
+#define CMD_BREAK        0x3093u
+#define CMD_READ_STATUS  0xF32Du
+#define CMD_FETCH_DATA   0xE000u
+
+// Soft reset time (datasheet t_SR max)
+#define RESET_TIME_US    1500u
+
+static uint8_t crc8(const uint8_t *data, uint8_t len)
+{
+  uint8_t crc = 0xFF;
+
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static void put_word(uint8_t *out, uint16_t word)
+{
+  out[0] = (uint8_t)(word >> 8);
+  out[1] = (uint8_t)word;
+  out[2] = crc8(out, 2);
+}
+
+// Typical conversion time for the repeatability in a command's LSB
+static uint32_t typical_conversion_us(uint8_t lsb)
+{
+  switch (lsb) {
+    case 0x16u: case 0x10u:                          // Low (single shot)
+    case 0x2Fu: case 0x2Du: case 0x2Bu: case 0x29u: case 0x2Au:
+      return 2500u;
+    case 0x0Bu: case 0x0Du:                          // Medium (single shot)
+    case 0x24u: case 0x26u: case 0x20u: case 0x22u: case 0x21u:
+      return 4500u;
+    default:                                         // High
+      return 12500u;
+  }
+}
+
+static uint32_t periodic_period_us(uint8_t msb)
+{
+  switch (msb) {
+    case 0x20u: return 2000000u;
+    case 0x21u: return 1000000u;
+    case 0x22u: return 500000u;
+    case 0x23u: return 250000u;
+    default:    return 100000u;
+  }
+}
+
+// Periodic results completed so far
+static uint32_t periodic_results(const sim_sht31_t *sim)
+{
+  uint64_t elapsed = sim_clock_now_us() - sim->periodic_start_us;
+
+  if (elapsed < sim->conversion_us) {
+    return 0;
+  }
+  return (uint32_t)((elapsed - sim->conversion_us) / sim->period_us) + 1u;
+}
+
+static void start_conversion(sim_sht31_t *sim, uint8_t lsb, bool stretch)
+{
+  sim->conversion_us = typical_conversion_us(lsb) + sim->extra_conversion_us;
+  sim->busy_until_us = sim_clock_now_us() + sim->conversion_us;
+  sim->stretch = stretch;
+  sim->pending = SIM_SHT31_PENDING_RESULT;
+  sim->conversions++;
+}
+
+static bool sht31_write(i2c_sim_device_t *device, const uint8_t *data, uint16_t len)
+{
+  sim_sht31_t *sim = (sim_sht31_t *)device;
+
+  // Busy with a reset or conversion: the data bytes are not acknowledged
+  if (len != 2u || sim_clock_now_us() < sim->busy_until_us) {
+    return false;
+  }
+
+  uint16_t command = (uint16_t)((data[0] << 8) | data[1]);
+  uint8_t msb = data[0];
+  uint8_t lsb = data[1];
+
+  if (command == CMD_SOFT_RESET) {
+    sim->pending = SIM_SHT31_PENDING_NONE;
+    sim->periodic = false;
+    sim->stretch = false;
+    sim->busy_until_us = sim_clock_now_us() + RESET_TIME_US;
+    return true;
+  }
+  if (command == CMD_BREAK) {
+    sim->periodic = false;
+    sim->pending = SIM_SHT31_PENDING_NONE;
+    return true;
+  }
+  if (command == CMD_READ_STATUS) {
+    sim->pending = SIM_SHT31_PENDING_STATUS;
+    return true;
+  }
+  if (command == CMD_FETCH_DATA) {
+    if (!sim->periodic) {
+      return false;
+    }
+    sim->pending = (periodic_results(sim) > sim->periodic_fetched)
+                   ? SIM_SHT31_PENDING_RESULT : SIM_SHT31_PENDING_NONE;
+    if (sim->pending == SIM_SHT31_PENDING_RESULT) {
+      sim->periodic_fetched = periodic_results(sim);
+    }
+    return true;
+  }
+  if (sim->periodic) {
+    return false;  // Only Break and Fetch Data while periodic
+  }
+  if (msb == 0x24u || msb == 0x2Cu) {
+    start_conversion(sim, lsb, msb == 0x2Cu);
+    return true;
+  }
+  if ((msb >= 0x20u && msb <= 0x23u) || msb == 0x27u) {
+    sim->periodic = true;
+    sim->periodic_start_us = sim_clock_now_us();
+    sim->period_us = periodic_period_us(msb);
+    sim->conversion_us = typical_conversion_us(lsb) + sim->extra_conversion_us;
+    sim->periodic_fetched = 0;
+    sim->pending = SIM_SHT31_PENDING_NONE;
+    return true;
+  }
+  return false;
+}
+
+static bool sht31_read(i2c_sim_device_t *device, uint8_t *data, uint16_t len, uint32_t *stretch_us)
+{
+  sim_sht31_t *sim = (sim_sht31_t *)device;
+  uint8_t out[6];
+  uint8_t out_len;
+  uint64_t now = sim_clock_now_us();
+
+  *stretch_us = 0;
+  if (now < sim->busy_until_us) {
+    if (!(sim->stretch && sim->pending == SIM_SHT31_PENDING_RESULT)) {
+      return false;
+    }
+    *stretch_us = (uint32_t)(sim->busy_until_us - now);
+  }
+
+  switch (sim->pending) {
+    case SIM_SHT31_PENDING_RESULT:
+      put_word(&out[0], sim->raw_t);
+      put_word(&out[3], sim->raw_h);
+      if (sim->crc_fault_count > 0u) {
+        sim->crc_fault_count--;
+        out[2] ^= 0x5Au;
+      }
+      out_len = 6;
+      break;
+    case SIM_SHT31_PENDING_STATUS:
+      put_word(&out[0], sim->status);
+      out_len = 3;
+      break;
+    default:
+      return false;
+  }
+  sim->pending = SIM_SHT31_PENDING_NONE;
+
+  // Reading past the end returns 0xFF (master keeps clocking, SDA released)
+  memset(data, 0xFF, len);
+  memcpy(data, out, (len < out_len) ? len : out_len);
+  return true;
+}
+
+static const i2c_sim_ops_t sht31_ops = {
+  .write = sht31_write,
+  .read = sht31_read,
+};
+
+void sim_sht31_init(sim_sht31_t *sim, uint8_t addr)
+{
+  memset(sim, 0, sizeof(*sim));
+  sim->device.addr = addr;
+  sim->device.ops = &sht31_ops;
+  // Power-on status: reset detected (bit 4)
+  sim->status = 0x0010u;
+}
+
+void sim_sht31_set_raw(sim_sht31_t *sim, uint16_t raw_t, uint16_t raw_h)
+{
+  sim->raw_t = raw_t;
+  sim->raw_h = raw_h;
+}
+
+void sim_sht31_inject_crc_error(sim_sht31_t *sim, uint32_t count)
+{
+  sim->crc_fault_count = count;
+}
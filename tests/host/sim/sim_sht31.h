@@ -0,0 +1,74 @@
+/**
+ * @file sim_sht31.h
+ * @brief SHT31 command model for the I2C simulator
+ *
+ * Commands per the Sensirion SHT3x datasheet: soft reset, single shot with
+ * and without clock stretching at three repeatabilities, periodic
+ * acquisition with Fetch Data and Break, and Read Status. Results are two
+ * big-endian words each followed by a CRC-8 (poly 0x31, init 0xFF).
+ *
+ * While a conversion runs the sensor does not acknowledge its address,
+ * except for a read after a clock-stretching command, which holds SCL until
+ * the result is ready. A read with no result pending is NACKed, as is a
+ * Fetch Data with no new periodic result. Conversions take the datasheet
+ * typical time (2.5 / 4.5 / 12.5 ms) plus any injected delay.
+ */
+
+#ifndef SIM_SHT31_H
+#define SIM_SHT31_H
+
+#include "i2c_sim.h"
+
+typedef enum {
+  SIM_SHT31_PENDING_NONE = 0,
+  SIM_SHT31_PENDING_RESULT,
+  SIM_SHT31_PENDING_STATUS,
+} sim_sht31_pending_t;
+
+typedef struct {
+  i2c_sim_device_t device;    // Must be first
+
+  // Raw words the next conversion returns
+  uint16_t raw_t;
+  uint16_t raw_h;
+  uint16_t status;
+
+  sim_sht31_pending_t pending;
+  uint64_t busy_until_us;     // Reset or conversion in progress
+  bool stretch;               // Last single shot was a clock-stretching one
+
+  bool periodic;
+  uint64_t periodic_start_us;
+  uint32_t period_us;
+  uint32_t periodic_fetched;  // Periodic results already fetched
+  uint32_t conversion_us;     // Of the last started conversion
+
+  uint32_t extra_conversion_us;  // Fault: convert slower than typical
+  uint32_t crc_fault_count;      // Fault: corrupt the CRC of the next N results
+
+  uint32_t conversions;       // Single-shot conversions started
+} sim_sht31_t;
+
+/**
+ * @brief Set up a model in its power-on state (not attached)
+ * @param sim Model instance
+ * @param addr 7-bit address (0x44 or 0x45)
+ */
+void sim_sht31_init(sim_sht31_t *sim, uint8_t addr);
+
+/**
+ * @brief Raw words for the following conversions
+ * @param sim Model instance
+ * @param raw_t Temperature word, T = -45 + 175 * raw_t / 65535
+ * @param raw_h Humidity word, RH = 100 * raw_h / 65535
+ */
+void sim_sht31_set_raw(sim_sht31_t *sim, uint16_t raw_t, uint16_t raw_h);
+
+/**
+ * @brief Corrupt the temperature CRC of the next results
+ * @param sim Model instance
+ * @param count Number of results
+ */
+void sim_sht31_inject_crc_error(sim_sht31_t *sim, uint32_t count);
+
+#endif // SIM_SHT31_H
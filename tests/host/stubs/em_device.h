@@ -0,0 +1,12 @@
+/**
+ * @file em_device.h
+ * @brief Host stub: the CMSIS barrier app_event.c uses
+ */
+
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+// DMB orders memory accesses between cores/contexts; a full fence on the host
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif // EM_DEVICE_H
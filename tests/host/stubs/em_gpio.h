@@ -0,0 +1,18 @@
+/**
+ * @file em_gpio.h
+ * @brief Host stub: the GPIO port names bme280_board_config.h refers to
+ */
+
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+typedef enum {
+  gpioPortA,
+  gpioPortB,
+  gpioPortC,
+  gpioPortD,
+  gpioPortE,
+  gpioPortF,
+} GPIO_Port_TypeDef;
+
+#endif // EM_GPIO_H
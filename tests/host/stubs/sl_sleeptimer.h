@@ -0,0 +1,41 @@
+/**
+ * @file sl_sleeptimer.h
+ * @brief Host stub of the sleeptimer API used by the drivers
+ */
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_status.h"
+
+typedef struct sl_sleeptimer_timer_handle sl_sleeptimer_timer_handle_t;
+
+typedef void (*sl_sleeptimer_timer_callback_t)(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+struct sl_sleeptimer_timer_handle {
+  sl_sleeptimer_timer_callback_t callback;
+  void *callback_data;
+  uint64_t expiry_us;
+  bool running;
+};
+
+uint32_t sl_sleeptimer_get_tick_count(void);
+
+uint32_t sl_sleeptimer_get_timer_frequency(void);
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick);
+
+void sl_sleeptimer_delay_millisecond(uint16_t time_ms);
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags);
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle);
+
+#endif // SL_SLEEPTIMER_H
@@ -0,0 +1,18 @@
+/**
+ * @file sl_status.h
+ * @brief Host stub of the GSDK status codes used by the drivers
+ */
+
+#ifndef SL_STATUS_H
+#define SL_STATUS_H
+
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK             0x0000u
+#define SL_STATUS_FAIL           0x0001u
+#define SL_STATUS_INVALID_STATE  0x0002u
+#define SL_STATUS_NOT_READY      0x0003u
+
+#endif // SL_STATUS_H
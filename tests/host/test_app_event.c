@@ -0,0 +1,275 @@
+/**
+ * @file test_app_event.c
+ * @brief Producer/consumer stress test of the app_event ring
+ *
+ * Builds app_event.c on the host with __DMB() as a full fence. A producer
+ * thread stands in for the button ISR and posts numbered events as fast as
+ * it can; a consumer thread stands in for the main loop and drains them,
+ * pausing now and then so the ring fills up. The producer yields on a full
+ * ring, so a single-core host interleaves the two as well. Checks:
+ * - events arrive in the order they were posted, payload intact
+ * - every accepted post is received; every rejected one is an overflow
+ * - posted/overflows match the producer's own counts
+ * - high_water reaches the ring size once the ring has overflowed
+ * A single-threaded pass first checks the same on a known fill pattern.
+ */
+
+#include "app_event.h"
+#include "sl_sleeptimer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Must match app_event.c
+#ifndef APP_EVENT_QUEUE_SIZE
+#define APP_EVENT_QUEUE_SIZE 8
+#endif
+
+#define STRESS_EVENTS        1000000u
+// Producer gap between posts, so the consumer mostly keeps up
+#define PRODUCER_GAP_SPINS   50u
+// Consumer pauses after this many events, long enough for the ring to fill
+#define CONSUMER_PAUSE_EVERY 1000u
+#define CONSUMER_PAUSE_SPINS 20000u
+
+// Both threads start together
+static volatile bool start_flag = false;
+
+static void spin(uint32_t count)
+{
+  for (volatile uint32_t i = 0; i < count; i++) {
+  }
+}
+
+static void wait_for_start(void)
+{
+  while (!__atomic_load_n(&start_flag, __ATOMIC_ACQUIRE)) {
+    sched_yield();
+  }
+}
+
+static int failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char *what, int line)
+{
+  if (!ok) {
+    printf("  FAIL line %d: %s\n", line, what);
+    failures++;
+  }
+}
+
+// Called by the producer only: the tick doubles as the accepted-post index
+static uint32_t tick_count = 0;
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return tick_count++;
+}
+
+static app_event_type_t type_for(uint32_t seq)
+{
+  return (seq & 1u) ? APP_EVENT_BUTTON_LONG : APP_EVENT_BUTTON_SHORT;
+}
+
+static void test_single_thread(void)
+{
+  app_event_stats_t before;
+  app_event_stats_t after;
+  app_event_t event;
+  uint32_t accepted = 0;
+  uint32_t first_tick = tick_count;
+
+  printf("Single thread, %u posts into a ring of %u:\n",
+         APP_EVENT_QUEUE_SIZE + 3u, APP_EVENT_QUEUE_SIZE);
+  app_event_get_stats(&before);
+  CHECK(!app_event_pending());
+  CHECK(!app_event_get(&event));
+
+  for (uint32_t seq = 0; seq < APP_EVENT_QUEUE_SIZE + 3u; seq++) {
+    if (app_event_post(type_for(seq), seq)) {
+      accepted++;
+    }
+  }
+  app_event_get_stats(&after);
+  CHECK(accepted == APP_EVENT_QUEUE_SIZE);
+  CHECK(after.posted - before.posted == APP_EVENT_QUEUE_SIZE);
+  CHECK(after.overflows - before.overflows == 3u);
+  CHECK(after.high_water == APP_EVENT_QUEUE_SIZE);
+
+  // Oldest first; the three rejected posts never show up
+  for (uint32_t seq = 0; seq < APP_EVENT_QUEUE_SIZE; seq++) {
+    CHECK(app_event_get(&event));
+    CHECK(event.arg == seq);
+    CHECK(event.type == type_for(seq));
+    CHECK(event.tick == first_tick + seq);
+  }
+  CHECK(!app_event_pending());
+  CHECK(!app_event_get(&event));
+
+  // Flush drops what is queued and leaves the ring usable
+  CHECK(app_event_post(APP_EVENT_BUTTON_SHORT, 1u));
+  CHECK(app_event_post(APP_EVENT_BUTTON_SHORT, 2u));
+  app_event_flush();
+  CHECK(!app_event_pending());
+  CHECK(app_event_post(APP_EVENT_BUTTON_LONG, 3u));
+  CHECK(app_event_get(&event) && event.arg == 3u);
+}
+
+typedef struct {
+  uint8_t *accepted;          // Per sequence number: post returned true
+  uint32_t rejected;
+  volatile bool done;
+} producer_state_t;
+
+typedef struct {
+  producer_state_t *producer;
+  uint32_t received;
+  uint32_t order_errors;      // Sequence not above the previous one
+  uint32_t payload_errors;    // Type or tick does not match the sequence
+  uint32_t not_accepted;      // Received a sequence whose post was rejected
+  uint32_t base_tick;         // tick_count before the producer started
+  uint8_t *seen;
+} consumer_state_t;
+
+static void *producer_thread(void *arg)
+{
+  producer_state_t *state = arg;
+
+  wait_for_start();
+  for (uint32_t seq = 0; seq < STRESS_EVENTS; seq++) {
+    if (app_event_post(type_for(seq), seq)) {
+      state->accepted[seq] = 1;
+    } else {
+      // Full ring: let the consumer run, even on a single-core host
+      state->rejected++;
+      sched_yield();
+    }
+    spin(PRODUCER_GAP_SPINS);
+  }
+  __atomic_store_n(&state->done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void *consumer_thread(void *arg)
+{
+  consumer_state_t *state = arg;
+  app_event_t event;
+  uint32_t last_seq = 0;
+  bool have_last = false;
+
+  wait_for_start();
+  for (;;) {
+    if (!app_event_get(&event)) {
+      if (__atomic_load_n(&state->producer->done, __ATOMIC_ACQUIRE)
+          && !app_event_pending()) {
+        break;
+      }
+      sched_yield();
+      continue;
+    }
+
+    uint32_t seq = event.arg;
+    if (seq >= STRESS_EVENTS) {
+      state->payload_errors++;
+      continue;
+    }
+    if (have_last && seq <= last_seq) {
+      state->order_errors++;
+    }
+    // Ticks are taken only for accepted posts, so they count receptions
+    if (event.type != type_for(seq) || event.tick != state->base_tick + state->received) {
+      state->payload_errors++;
+    }
+    state->seen[seq] = 1;
+    last_seq = seq;
+    have_last = true;
+    state->received++;
+
+    if ((state->received % CONSUMER_PAUSE_EVERY) == 0u) {
+      spin(CONSUMER_PAUSE_SPINS);
+    }
+  }
+  return NULL;
+}
+
+static void test_two_threads(void)
+{
+  producer_state_t producer = { 0 };
+  consumer_state_t consumer = { 0 };
+  app_event_stats_t before;
+  app_event_stats_t after;
+  pthread_t producer_id;
+  pthread_t consumer_id;
+  uint32_t lost = 0;
+  uint32_t accepted = 0;
+
+  printf("Two threads, %u events:\n", STRESS_EVENTS);
+  producer.accepted = calloc(STRESS_EVENTS, 1);
+  consumer.seen = calloc(STRESS_EVENTS, 1);
+  consumer.producer = &producer;
+  if (producer.accepted == NULL || consumer.seen == NULL) {
+    CHECK(false);
+    return;
+  }
+
+  app_event_get_stats(&before);
+  consumer.base_tick = tick_count;
+  CHECK(pthread_create(&consumer_id, NULL, consumer_thread, &consumer) == 0);
+  CHECK(pthread_create(&producer_id, NULL, producer_thread, &producer) == 0);
+  __atomic_store_n(&start_flag, true, __ATOMIC_RELEASE);
+  pthread_join(producer_id, NULL);
+  pthread_join(consumer_id, NULL);
+  app_event_get_stats(&after);
+
+  for (uint32_t seq = 0; seq < STRESS_EVENTS; seq++) {
+    if (producer.accepted[seq]) {
+      accepted++;
+      if (!consumer.seen[seq]) {
+        lost++;
+      }
+    } else if (consumer.seen[seq]) {
+      consumer.not_accepted++;
+    }
+  }
+
+  uint32_t posted = after.posted - before.posted;
+  uint32_t overflows = after.overflows - before.overflows;
+
+  printf("  received %u, overflows %u, high water %u/%u\n",
+         consumer.received, overflows, after.high_water, APP_EVENT_QUEUE_SIZE);
+  CHECK(consumer.order_errors == 0u);
+  CHECK(consumer.payload_errors == 0u);
+  CHECK(consumer.not_accepted == 0u);
+  CHECK(lost == 0u);
+  CHECK(consumer.received == accepted);
+  CHECK(posted == accepted);
+  CHECK(overflows == producer.rejected);
+  CHECK(posted + overflows == STRESS_EVENTS);
+  CHECK(after.high_water <= APP_EVENT_QUEUE_SIZE);
+  // The consumer pauses, so the ring must have filled and overflowed, but
+  // it keeps up otherwise
+  CHECK(overflows > 0u);
+  CHECK(consumer.received > STRESS_EVENTS / 2u);
+  CHECK(after.high_water == APP_EVENT_QUEUE_SIZE);
+  CHECK(!app_event_pending());
+
+  free(producer.accepted);
+  free(consumer.seen);
+}
+
+int main(void)
+{
+  test_single_thread();
+  test_two_threads();
+
+  if (failures != 0) {
+    printf("test_app_event: %d FAILED\n", failures);
+    return 1;
+  }
+  printf("test_app_event: all passed\n");
+  return 0;
+}
@@ -0,0 +1,430 @@
+/**
+ * @file test_bme280_kernels.c
+ * @brief Host check of the BME280 compensation kernels
+ *
+ * Builds bme280_min.c with every kernel and sweeps adc_T and adc_P across
+ * the 20-bit ADC range (adc_H across 16 bits) for two calibrations: the
+ * Bosch BMP280 datasheet example and a BME280 module with humidity. Points
+ * outside -40..85 C / 300..1100 hPa are skipped. For each kernel:
+ * - the derived coefficients must reproduce the datasheet formula on the
+ *   raw calibration bit for bit (mismatches == 0)
+ * - pressure and humidity must stay within the documented error of the
+ *   int64 / int32 reference
+ * Host time per sample is printed for comparison between kernels; target
+ * cycle counts need a hardware run.
+ */
+
+#define BME280_BUILD_ALL_KERNELS 1
+
+#include "bme280_min.c"
+
+#include <stdio.h>
+#include <time.h>
+
+// The kernels are pure arithmetic; bus, NVM and timer are never reached.
+bool hal_i2c_init(void)
+{
+  return false;
+}
+
+bool hal_i2c_write(uint8_t addr, const uint8_t *data, uint16_t len)
+{
+  (void)addr;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+bool hal_i2c_write_read(uint8_t addr, uint8_t reg_addr, uint8_t *data, uint16_t len)
+{
+  (void)addr;
+  (void)reg_addr;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+bool sensor_cache_load(uint32_t key, void *data, uint16_t len)
+{
+  (void)key;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+bool sensor_cache_store(uint32_t key, const void *data, uint16_t len)
+{
+  (void)key;
+  (void)data;
+  (void)len;
+  return false;
+}
+
+void sensor_cache_invalidate(uint32_t key)
+{
+  (void)key;
+}
+
+void sl_sleeptimer_delay_millisecond(uint16_t time_ms)
+{
+  (void)time_ms;
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags)
+{
+  (void)handle;
+  (void)timeout_ms;
+  (void)callback;
+  (void)callback_data;
+  (void)priority;
+  (void)option_flags;
+  return SL_STATUS_FAIL;
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  (void)handle;
+  return SL_STATUS_OK;
+}
+
+// Datasheet formulas on the raw calibration block, the bit-exact reference
+// for the derived kernels.
+// Reference temperature (returns value in 0.01 degrees Celsius)
+static int32_t reference_temperature(bme280_calib_data_t *calib, int32_t adc_T)
+{
+  int32_t var1, var2, T;
+
+  var1 = ((((adc_T >> 3) - ((int32_t)calib->dig_T1 << 1))) *
+          ((int32_t)calib->dig_T2)) >> 11;
+  var2 = (((((adc_T >> 4) - ((int32_t)calib->dig_T1)) *
+            ((adc_T >> 4) - ((int32_t)calib->dig_T1))) >> 12) *
+          ((int32_t)calib->dig_T3)) >> 14;
+
+  calib->t_fine = var1 + var2;
+  T = (calib->t_fine * 5 + 128) >> 8;
+
+  return T;  // Temperature in 0.01 degrees Celsius
+}
+
+// Reference pressure, 64-bit integer (returns value in Pa)
+static uint32_t reference_pressure_int64(const bme280_calib_data_t *calib, int32_t adc_P)
+{
+  int64_t var1, var2, p;
+
+  var1 = ((int64_t)calib->t_fine) - 128000;
+  var2 = var1 * var1 * (int64_t)calib->dig_P6;
+  var2 = var2 + ((var1 * (int64_t)calib->dig_P5) << 17);
+  var2 = var2 + (((int64_t)calib->dig_P4) << 35);
+  var1 = ((var1 * var1 * (int64_t)calib->dig_P3) >> 8) +
+         ((var1 * (int64_t)calib->dig_P2) << 12);
+  var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calib->dig_P1) >> 33;
+
+  if (var1 == 0) {
+    return 0;  // Avoid division by zero
+  }
+
+  p = 1048576 - adc_P;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = (((int64_t)calib->dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+  var2 = (((int64_t)calib->dig_P8) * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + (((int64_t)calib->dig_P7) << 4);
+
+  return (uint32_t)(p >> 8);  // Pressure in Pa (256th of Pa -> Pa)
+}
+
+// Reference pressure, 32-bit integer (BMP280 datasheet 8.2, returns Pa)
+static uint32_t reference_pressure_int32(const bme280_calib_data_t *calib, int32_t adc_P)
+{
+  int32_t var1, var2;
+  uint32_t p;
+
+  var1 = (calib->t_fine >> 1) - (int32_t)64000;
+  var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)calib->dig_P6);
+  var2 = var2 + ((var1 * ((int32_t)calib->dig_P5)) << 1);
+  var2 = (var2 >> 2) + (((int32_t)calib->dig_P4) << 16);
+  var1 = (((((int32_t)calib->dig_P3) * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) +
+          ((((int32_t)calib->dig_P2) * var1) >> 1)) >> 18;
+  var1 = ((((32768 + var1)) * ((int32_t)calib->dig_P1)) >> 15);
+
+  if (var1 == 0) {
+    return 0;  // Avoid division by zero
+  }
+
+  p = (((uint32_t)(((int32_t)1048576) - adc_P) - (uint32_t)(var2 >> 12))) * 3125u;
+  if (p < 0x80000000u) {
+    p = (p << 1) / ((uint32_t)var1);
+  } else {
+    p = (p / (uint32_t)var1) * 2u;
+  }
+  var1 = (((int32_t)calib->dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+  var2 = (((int32_t)(p >> 2)) * ((int32_t)calib->dig_P8)) >> 13;
+  p = (uint32_t)((int32_t)p + ((var1 + var2 + calib->dig_P7) >> 4));
+
+  return p;
+}
+
+// Reference pressure, single precision (BME280 datasheet 8.1, returns Pa)
+static uint32_t reference_pressure_float(const bme280_calib_data_t *calib, int32_t adc_P)
+{
+  float var1, var2, p;
+
+  var1 = ((float)calib->t_fine * 0.5f) - 64000.0f;
+  var2 = var1 * var1 * (float)calib->dig_P6 * (1.0f / 32768.0f);
+  var2 = var2 + (var1 * (float)calib->dig_P5 * 2.0f);
+  var2 = (var2 * 0.25f) + ((float)calib->dig_P4 * 65536.0f);
+  var1 = (((float)calib->dig_P3 * var1 * var1 * (1.0f / 524288.0f))
+          + ((float)calib->dig_P2 * var1)) * (1.0f / 524288.0f);
+  var1 = (1.0f + (var1 * (1.0f / 32768.0f))) * (float)calib->dig_P1;
+
+  if (var1 == 0.0f) {
+    return 0;  // Avoid division by zero
+  }
+
+  p = 1048576.0f - (float)adc_P;
+  p = (p - (var2 * (1.0f / 4096.0f))) * 6250.0f / var1;
+  var1 = (float)calib->dig_P9 * p * p * (1.0f / 2147483648.0f);
+  var2 = p * (float)calib->dig_P8 * (1.0f / 32768.0f);
+  p = p + ((var1 + var2 + (float)calib->dig_P7) * (1.0f / 16.0f));
+
+  return (p > 0.0f) ? (uint32_t)(p + 0.5f) : 0u;
+}
+
+// Reference humidity, single precision (returns value in 0.01 %RH)
+static uint32_t reference_humidity_float(const bme280_calib_data_t *calib, int32_t adc_H)
+{
+  float var_h = (float)calib->t_fine - 76800.0f;
+
+  var_h = ((float)adc_H - (((float)calib->dig_H4 * 64.0f)
+                           + ((float)calib->dig_H5 * (1.0f / 16384.0f) * var_h)))
+          * ((float)calib->dig_H2 * (1.0f / 65536.0f)
+             * (1.0f + ((float)calib->dig_H6 * (1.0f / 67108864.0f) * var_h
+                        * (1.0f + ((float)calib->dig_H3 * (1.0f / 67108864.0f) * var_h)))));
+  var_h = var_h * (1.0f - ((float)calib->dig_H1 * var_h * (1.0f / 524288.0f)));
+
+  if (var_h > 100.0f) {
+    var_h = 100.0f;
+  } else if (var_h < 0.0f) {
+    var_h = 0.0f;
+  }
+  return (uint32_t)((var_h * 100.0f) + 0.5f);
+}
+
+// Reference humidity, 32-bit integer (returns value in 0.01 %RH)
+static uint32_t reference_humidity_int32(const bme280_calib_data_t *calib, int32_t adc_H)
+{
+  int32_t v_x1_u32r;
+
+  v_x1_u32r = (calib->t_fine - ((int32_t)76800));
+  v_x1_u32r = (((((adc_H << 14) - (((int32_t)calib->dig_H4) << 20) -
+                  (((int32_t)calib->dig_H5) * v_x1_u32r)) +
+                 ((int32_t)16384)) >> 15) *
+               (((((((v_x1_u32r * ((int32_t)calib->dig_H6)) >> 10) *
+                    (((v_x1_u32r * ((int32_t)calib->dig_H3)) >> 11) +
+                     ((int32_t)32768))) >> 10) +
+                   ((int32_t)2097152)) *
+                  ((int32_t)calib->dig_H2) + 8192) >> 14));
+
+  v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) *
+                             ((int32_t)calib->dig_H1)) >> 4));
+
+  v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
+  v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
+
+  uint32_t h = (uint32_t)(v_x1_u32r >> 12);
+  return (h * 100) >> 10;  // Convert to 0.01 %RH
+}
+
+// Bosch BMP280 datasheet 3.12 example calibration (no humidity coefficients)
+static const bme280_calib_data_t example_calib = {
+  .dig_T1 = 27504, .dig_T2 = 26435, .dig_T3 = -1000,
+  .dig_P1 = 36477, .dig_P2 = -10685, .dig_P3 = 3024, .dig_P4 = 2855,
+  .dig_P5 = 140, .dig_P6 = -7, .dig_P7 = 15500, .dig_P8 = -14600, .dig_P9 = 6000,
+};
+
+// Calibration read from a BME280 breakout module
+static const bme280_calib_data_t module_calib = {
+  .dig_T1 = 28485, .dig_T2 = 26735, .dig_T3 = 50,
+  .dig_P1 = 36738, .dig_P2 = -10635, .dig_P3 = 3024, .dig_P4 = 6580,
+  .dig_P5 = -140, .dig_P6 = -7, .dig_P7 = 9900, .dig_P8 = -10230, .dig_P9 = 4285,
+  .dig_H1 = 75, .dig_H2 = 362, .dig_H3 = 0, .dig_H4 = 324, .dig_H5 = 0, .dig_H6 = 30,
+};
+
+#define SWEEP_T_STEPS   32u
+#define SWEEP_P_STEPS   256u
+#define SWEEP_H_STEPS   128u
+// Timing passes over the sweep, to get above the clock resolution
+#define TIMING_PASSES   20u
+
+// Documented error bounds against the reference (docs/POWER_OPTIMIZATION.md)
+static const uint32_t max_error_pa[BME280_KERNEL_COUNT] = { 0u, 5u, 1u };
+static const uint32_t max_error_rh[BME280_KERNEL_COUNT] = { 0u, 0u, 2u };
+
+static const char *const kernel_names[BME280_KERNEL_COUNT] = { "int64", "int32", "float" };
+
+typedef struct {
+  uint32_t samples;       // Sweep points inside the sensor operating range
+  uint32_t max_error_pa;  // Max |P - P(int64)| in Pa
+  uint32_t max_error_rh;  // Max |H - H(int32)| in 0.01 %RH
+  uint32_t mismatches;    // Points where the derived kernel differs from its datasheet formula
+  double ns_per_sample;   // Host time per T+P(+H) compensation
+} kernel_report_t;
+
+static uint32_t abs_diff_u32(uint32_t a, uint32_t b)
+{
+  return (a > b) ? (a - b) : (b - a);
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static uint32_t derived_pressure(uint8_t kernel, const bme280_derived_t *d, int32_t adc_P)
+{
+  if (kernel == BME280_KERNEL_INT32) {
+    return compensate_pressure_int32(d, adc_P);
+  }
+  if (kernel == BME280_KERNEL_FLOAT) {
+    return compensate_pressure_float(d, adc_P);
+  }
+  return compensate_pressure_int64(d, adc_P);
+}
+
+static uint32_t derived_humidity(uint8_t kernel, const bme280_derived_t *d, int32_t adc_H)
+{
+  return (kernel == BME280_KERNEL_FLOAT) ? compensate_humidity_float(d, adc_H)
+                                         : compensate_humidity_int32(d, adc_H);
+}
+
+static void check_kernel(uint8_t kernel,
+                         const bme280_calib_data_t *raw_calib,
+                         bool check_humidity,
+                         kernel_report_t *report)
+{
+  bme280_calib_data_t calib = *raw_calib;
+  bme280_derived_t d;
+  double elapsed_ns = 0.0;
+  volatile uint32_t sink = 0;
+
+  derive_coefficients(&calib, &d);
+  memset(report, 0, sizeof(*report));
+
+  for (uint32_t ti = 0; ti < SWEEP_T_STEPS; ti++) {
+    int32_t adc_T = (int32_t)((ti * 0xFFFFFu) / (SWEEP_T_STEPS - 1u));
+    int32_t temperature = reference_temperature(&calib, adc_T);
+    if (temperature < -4000 || temperature > 8500) {
+      continue;
+    }
+
+    for (uint32_t pi = 0; pi < SWEEP_P_STEPS; pi++) {
+      int32_t adc_P = (int32_t)((pi * 0xFFFFFu) / (SWEEP_P_STEPS - 1u));
+      int32_t adc_H = (int32_t)((pi % SWEEP_H_STEPS) * (0xFFFFu / (SWEEP_H_STEPS - 1u)));
+      uint32_t reference = reference_pressure_int64(&calib, adc_P);
+      if (reference < 30000u || reference > 110000u) {
+        continue;
+      }
+      uint32_t reference_h = check_humidity ? reference_humidity_int32(&calib, adc_H) : 0u;
+
+      // Datasheet formula of the kernel under test, for the bit-exact check
+      uint32_t expected_p;
+      uint32_t expected_h = 0u;
+      if (kernel == BME280_KERNEL_INT32) {
+        expected_p = reference_pressure_int32(&calib, adc_P);
+      } else if (kernel == BME280_KERNEL_FLOAT) {
+        expected_p = reference_pressure_float(&calib, adc_P);
+      } else {
+        expected_p = reference;
+      }
+      if (check_humidity) {
+        expected_h = (kernel == BME280_KERNEL_FLOAT) ? reference_humidity_float(&calib, adc_H)
+                                                     : reference_h;
+      }
+
+      int32_t t = compensate_temperature(&d, adc_T);
+      uint32_t pressure = derived_pressure(kernel, &d, adc_P);
+      uint32_t humidity = check_humidity ? derived_humidity(kernel, &d, adc_H) : 0u;
+
+      // Time the full per-sample path of the derived kernel under test
+      double start = now_ns();
+      for (uint32_t pass = 0; pass < TIMING_PASSES; pass++) {
+        sink += (uint32_t)compensate_temperature(&d, adc_T);
+        sink += derived_pressure(kernel, &d, adc_P);
+        if (check_humidity) {
+          sink += derived_humidity(kernel, &d, adc_H);
+        }
+      }
+      elapsed_ns += now_ns() - start;
+
+      if (t != temperature || d.t_fine != calib.t_fine
+          || pressure != expected_p || humidity != expected_h) {
+        report->mismatches++;
+      }
+
+      uint32_t err = abs_diff_u32(pressure, reference);
+      if (err > report->max_error_pa) {
+        report->max_error_pa = err;
+      }
+      err = abs_diff_u32(humidity, reference_h);
+      if (err > report->max_error_rh) {
+        report->max_error_rh = err;
+      }
+      report->samples++;
+    }
+  }
+
+  if (report->samples != 0u) {
+    report->ns_per_sample = elapsed_ns / ((double)report->samples * TIMING_PASSES);
+  }
+  (void)sink;
+}
+
+static int run_calibration(const char *name, const bme280_calib_data_t *calib, bool check_humidity)
+{
+  int failures = 0;
+
+  printf("%s calibration%s:\n", name, check_humidity ? " (with humidity)" : "");
+  for (uint8_t kernel = 0; kernel < BME280_KERNEL_COUNT; kernel++) {
+    kernel_report_t report;
+    check_kernel(kernel, calib, check_humidity, &report);
+
+    bool ok = report.samples > 0u
+              && report.mismatches == 0u
+              && report.max_error_pa <= max_error_pa[kernel]
+              && report.max_error_rh <= max_error_rh[kernel];
+    printf("  %-5s %6.1f ns/sample, max err %lu Pa %lu.%02lu %%RH, %lu mismatch (%lu pts) %s\n",
+           kernel_names[kernel],
+           report.ns_per_sample,
+           (unsigned long)report.max_error_pa,
+           (unsigned long)(report.max_error_rh / 100u),
+           (unsigned long)(report.max_error_rh % 100u),
+           (unsigned long)report.mismatches,
+           (unsigned long)report.samples,
+           ok ? "ok" : "FAIL");
+    if (!ok) {
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(void)
+{
+  int failures = 0;
+
+  failures += run_calibration("Datasheet example", &example_calib, false);
+  failures += run_calibration("BME280 module", &module_calib, true);
+
+  if (failures != 0) {
+    printf("test_bme280_kernels: %d FAILED\n", failures);
+    return 1;
+  }
+  printf("test_bme280_kernels: all passed\n");
+  return 0;
+}
@@ -0,0 +1,462 @@
+/**
+ * @file test_i2c_sim.c
+ * @brief BME280/BMP280 and SHT31 drivers against the host I2C simulator
+ *
+ * Links the unmodified drivers with hal_i2c_sim.c, the register models in
+ * sim/, a simulated sleeptimer and an in-memory sensor_cache. Each scenario
+ * boots the driver (cold or warm), takes samples through the same
+ * start / ready / fetch sequence app_sensor.c uses, and checks:
+ * - decoded values against the datasheet example or the model's raw words
+ * - transactions, bytes and bus time per sample at BME280_I2C_FREQ
+ * - cache handling under NACK, slow conversion, CRC and stretch faults
+ * A per-sample bus occupancy table is printed at the end.
+ */
+
+#include "bme280_min.h"
+#include "sht31.h"
+#include "hal_i2c.h"
+#include "i2c_sim.h"
+#include "sim_bme280.h"
+#include "sim_sht31.h"
+#include "sim_clock.h"
+#include "sim_sensor_cache.h"
+#include "bme280_board_config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BME280_ADDR  0x76u
+#define SHT31_ADDR   0x44u
+
+static int failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char *what, int line)
+{
+  if (!ok) {
+    printf("  FAIL line %d: %s\n", line, what);
+    failures++;
+  }
+}
+
+// Bosch BMP280 datasheet 3.12 example calibration and raw values
+static const bme280_calib_data_t example_calib = {
+  .dig_T1 = 27504, .dig_T2 = 26435, .dig_T3 = -1000,
+  .dig_P1 = 36477, .dig_P2 = -10685, .dig_P3 = 3024, .dig_P4 = 2855,
+  .dig_P5 = 140, .dig_P6 = -7, .dig_P7 = 15500, .dig_P8 = -14600, .dig_P9 = 6000,
+};
+#define EXAMPLE_ADC_T  519888
+#define EXAMPLE_ADC_P  415148
+
+// Calibration read from a BME280 breakout module
+static const bme280_calib_data_t module_calib = {
+  .dig_T1 = 28485, .dig_T2 = 26735, .dig_T3 = 50,
+  .dig_P1 = 36738, .dig_P2 = -10635, .dig_P3 = 3024, .dig_P4 = 6580,
+  .dig_P5 = -140, .dig_P6 = -7, .dig_P7 = 9900, .dig_P8 = -10230, .dig_P9 = 4285,
+  .dig_H1 = 75, .dig_H2 = 362, .dig_H3 = 0, .dig_H4 = 324, .dig_H5 = 0, .dig_H6 = 30,
+};
+
+// Bus usage of one operation
+typedef struct {
+  const char *name;
+  bool ok;
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t bus_us;
+  uint32_t stretch_us;
+  uint32_t latency_us;   // Start to result, sensor conversion included
+} usage_t;
+
+#define MAX_ROWS 24u
+static usage_t rows[MAX_ROWS];
+static uint32_t row_count = 0;
+
+static i2c_sim_stats_t usage_start_stats;
+static uint64_t usage_start_us;
+
+static void usage_begin(void)
+{
+  i2c_sim_get_stats(&usage_start_stats);
+  usage_start_us = sim_clock_now_us();
+}
+
+static usage_t usage_end(const char *name, bool ok)
+{
+  i2c_sim_stats_t stats;
+  usage_t usage;
+
+  i2c_sim_get_stats(&stats);
+  usage.name = name;
+  usage.ok = ok;
+  usage.transactions = stats.transactions - usage_start_stats.transactions;
+  usage.bytes = stats.bytes - usage_start_stats.bytes;
+  usage.bus_us = (uint32_t)((stats.bus_ns - usage_start_stats.bus_ns) / 1000u);
+  usage.stretch_us = (uint32_t)((stats.stretch_ns - usage_start_stats.stretch_ns) / 1000u);
+  usage.latency_us = (uint32_t)(sim_clock_now_us() - usage_start_us);
+  if (row_count < MAX_ROWS) {
+    rows[row_count++] = usage;
+  }
+  return usage;
+}
+
+// Power cycle of the MCU: bus, clock and devices, cache kept unless erased
+static void boot(bool erase_cache)
+{
+  sim_clock_reset();
+  i2c_sim_reset();
+  if (erase_cache) {
+    sim_sensor_cache_reset();
+  }
+}
+
+// Power-on state of the sensor models, attached to the bus
+static void power_on_bme280(sim_bme280_t *sim, uint8_t chip_id, const bme280_calib_data_t *calib)
+{
+  sim_bme280_init(sim, BME280_ADDR, chip_id, calib);
+  sim_bme280_set_adc(sim, 530000, 330000, 28000);
+  i2c_sim_attach(&sim->device);
+}
+
+static void power_on_sht31(sim_sht31_t *sim)
+{
+  sim_sht31_init(sim, SHT31_ADDR);
+  sim_sht31_set_raw(sim, 0x6666u, 0x8000u);
+  i2c_sim_attach(&sim->device);
+}
+
+static usage_t bme280_boot(const char *name)
+{
+  usage_begin();
+  bool ok = bme280_init();
+  return usage_end(name, ok);
+}
+
+static usage_t bme280_sample(const char *name, bme280_data_t *data)
+{
+  bool ok = false;
+
+  usage_begin();
+  if (bme280_start_measurement()) {
+    // The MCU sleeps until the conversion timer; the app polls on each wake
+    while (!bme280_measurement_ready() && sim_clock_run_next_timer()) {
+    }
+    ok = bme280_fetch_data(data);
+  }
+  return usage_end(name, ok);
+}
+
+static usage_t sht31_sample(const char *name, sht31_data_t *data)
+{
+  bool ok = false;
+
+  usage_begin();
+  if (sht31_start_measurement()) {
+    while (!sht31_measurement_ready() && sim_clock_run_next_timer()) {
+    }
+    ok = sht31_fetch_data(data);
+  }
+  return usage_end(name, ok);
+}
+
+// 10 us per bit at 100 kHz: START + address + ACK is 10 bits, each data
+// byte 9, repeated START + address 10, STOP 1.
+#define BITS_US(bits)        ((bits) * 10u)
+#define WRITE_US(tx)         BITS_US(1u + 9u + 9u * (tx) + 1u)
+#define WRITE_READ_US(tx, rx) BITS_US(1u + 9u + 9u * (tx) + 1u + 9u + 9u * (rx) + 1u)
+#define READ_US(rx)          BITS_US(1u + 9u + 9u * (rx) + 1u)
+
+static void test_bmp280_datasheet_example(void)
+{
+  sim_bme280_t bmp;
+  bme280_data_t data;
+  usage_t usage;
+
+  printf("BMP280, datasheet example:\n");
+  boot(true);
+  sim_bme280_init(&bmp, BME280_ADDR, BMP280_CHIP_ID, &example_calib);
+  sim_bme280_set_adc(&bmp, EXAMPLE_ADC_T, EXAMPLE_ADC_P, 0);
+  i2c_sim_attach(&bmp.device);
+
+  usage = bme280_boot("BMP280 cold boot");
+  CHECK(usage.ok);
+  CHECK(!bme280_has_humidity());
+  // ID, reset, calibration 0x88, CONFIG, CTRL_MEAS
+  CHECK(usage.transactions == 5u);
+  CHECK(bmp.resets == 1u);
+  CHECK(sim_sensor_cache_has(SENSOR_CACHE_KEY_BME280));
+
+  usage = bme280_sample("BMP280 forced sample", &data);
+  CHECK(usage.ok);
+  CHECK(data.temperature == 2508);
+  CHECK(data.pressure == 100653u);
+  CHECK(data.humidity == 0xFFFFu);
+  // CTRL_MEAS write, STATUS read, 6 data bytes
+  CHECK(usage.transactions == 3u);
+  CHECK(usage.bytes == 2u + 2u + 7u);
+  CHECK(usage.bus_us == WRITE_US(2u) + WRITE_READ_US(1u, 1u) + WRITE_READ_US(1u, 6u));
+  CHECK(bmp.conversions == 1u);
+  CHECK((bmp.regs[BME280_REG_CTRL_MEAS] & 0x03u) == BME280_MODE_SLEEP);
+}
+
+static void test_bme280_cold_and_warm_boot(void)
+{
+  sim_bme280_t bme;
+  bme280_data_t cold;
+  bme280_data_t warm;
+  usage_t usage;
+
+  printf("BME280, cold then warm boot:\n");
+  boot(true);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+
+  usage = bme280_boot("BME280 cold boot");
+  CHECK(usage.ok);
+  CHECK(bme280_has_humidity());
+  // ID, reset, calibration 0x88 and 0xE1, CTRL_HUM, CONFIG, CTRL_MEAS
+  CHECK(usage.transactions == 7u);
+
+  usage = bme280_sample("BME280 forced sample", &cold);
+  CHECK(usage.ok);
+  CHECK(cold.temperature > -4000 && cold.temperature < 8500);
+  CHECK(cold.pressure > 30000u && cold.pressure < 110000u);
+  CHECK(cold.humidity <= 10000u);
+  CHECK(usage.transactions == 3u);
+  CHECK(usage.bytes == 2u + 2u + 9u);
+  CHECK(usage.bus_us == WRITE_US(2u) + WRITE_READ_US(1u, 1u) + WRITE_READ_US(1u, 8u));
+  // Converts in t_meas,typ 8 ms; the timer waits t_meas,max rounded up to 10 ms
+  CHECK(usage.latency_us == usage.bus_us + 10000u);
+
+  // Warm boot: same chip, cache kept
+  boot(false);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+
+  usage = bme280_boot("BME280 warm boot");
+  CHECK(usage.ok);
+  // ID, CTRL_MEAS sleep, CTRL_HUM, CONFIG, CTRL_MEAS
+  CHECK(usage.transactions == 5u);
+  CHECK(bme.resets == 0u);
+
+  // First sample re-reads the calibration once (BME280_CACHE_VERIFY)
+  usage = bme280_sample("BME280 first warm sample", &warm);
+  CHECK(usage.ok);
+  CHECK(usage.transactions == 5u);
+  CHECK(memcmp(&cold, &warm, sizeof(cold)) == 0);
+
+  usage = bme280_sample("BME280 warm sample", &warm);
+  CHECK(usage.ok);
+  CHECK(usage.transactions == 3u);
+  CHECK(memcmp(&cold, &warm, sizeof(cold)) == 0);
+}
+
+static void test_bme280_nack_faults(void)
+{
+  sim_bme280_t bme;
+  sim_bme280_t bmp;
+  bme280_data_t data;
+  usage_t usage;
+
+  printf("BME280, NACK faults on cached calibration:\n");
+  boot(true);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+  CHECK(bme280_init());
+
+  // Warm boot, then NACK the CTRL_MEAS write of three samples in a row
+  boot(false);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+  CHECK(bme280_init());
+
+  i2c_sim_inject_nack(&bme.device, 1);
+  usage = bme280_sample("BME280 NACK (1st)", &data);
+  CHECK(!usage.ok);
+  // Failed write + chip ID re-read
+  CHECK(usage.transactions == 2u);
+  CHECK(sim_sensor_cache_has(SENSOR_CACHE_KEY_BME280));
+
+  i2c_sim_inject_nack(&bme.device, 1);
+  CHECK(!bme280_sample("BME280 NACK (2nd)", &data).ok);
+  CHECK(sim_sensor_cache_has(SENSOR_CACHE_KEY_BME280));
+
+  i2c_sim_inject_nack(&bme.device, 1);
+  CHECK(!bme280_sample("BME280 NACK (3rd)", &data).ok);
+  CHECK(!sim_sensor_cache_has(SENSOR_CACHE_KEY_BME280));
+
+  CHECK(bme280_sample("BME280 after NACKs", &data).ok);
+
+  // A different chip answering at the address drops the record at once
+  boot(true);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+  CHECK(bme280_init());
+  boot(false);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+  CHECK(bme280_init());
+  i2c_sim_detach(&bme.device);
+  power_on_bme280(&bmp, BMP280_CHIP_ID, &example_calib);
+  i2c_sim_inject_nack(&bmp.device, 1);
+  CHECK(!bme280_sample("BME280 swapped chip", &data).ok);
+  CHECK(!sim_sensor_cache_has(SENSOR_CACHE_KEY_BME280));
+}
+
+static void test_bme280_slow_conversion(void)
+{
+  sim_bme280_t bme;
+  bme280_data_t data;
+  usage_t usage;
+
+  printf("BME280, conversion slower than t_meas,max:\n");
+  boot(true);
+  power_on_bme280(&bme, BME280_CHIP_ID, &module_calib);
+  CHECK(bme280_init());
+
+  // 10.5 ms: still measuring at the 10 ms timer, done at the 1 ms re-poll
+  bme.extra_conversion_us = 2500u;
+  usage = bme280_sample("BME280 slow (1 extra poll)", &data);
+  CHECK(usage.ok);
+  CHECK(usage.transactions == 4u);
+
+  // 18 ms: still measuring after three extra polls
+  bme.extra_conversion_us = 10000u;
+  usage = bme280_sample("BME280 overrun", &data);
+  CHECK(!usage.ok);
+  CHECK(usage.transactions == 1u + 4u);
+
+  // The abandoned conversion finishes; the next sample is clean
+  sim_clock_advance_us(4000u);
+  bme.extra_conversion_us = 0;
+  CHECK(bme280_sample("BME280 after overrun", &data).ok);
+}
+
+static void test_sht31_single_shot(void)
+{
+  sim_sht31_t sht;
+  sht31_data_t data;
+  usage_t usage;
+  uint8_t cmd[2] = { 0x24u, 0x00u };
+  uint8_t rx[6];
+
+  printf("SHT31, single shot without clock stretching:\n");
+  boot(true);
+  power_on_sht31(&sht);
+
+  usage_begin();
+  usage = usage_end("SHT31 cold boot", sht31_init());
+  CHECK(usage.ok);
+  CHECK(sht31_get_i2c_addr() == SHT31_ADDR);
+  CHECK(sim_sensor_cache_has(SENSOR_CACHE_KEY_SHT31));
+
+  usage = sht31_sample("SHT31 single shot", &data);
+  CHECK(usage.ok);
+  CHECK(data.temperature == 2500);
+  CHECK(data.humidity == 5000u);
+  CHECK(usage.transactions == 2u);
+  CHECK(usage.bytes == 8u);
+  CHECK(usage.bus_us == WRITE_US(2u) + READ_US(6u));
+  CHECK(usage.stretch_us == 0u);
+
+  // The model NACKs a read issued before the conversion finished
+  CHECK(hal_i2c_write(SHT31_ADDR, cmd, sizeof(cmd)));
+  CHECK(!hal_i2c_read(SHT31_ADDR, rx, sizeof(rx)));
+  sim_clock_advance_us(13000u);
+  CHECK(hal_i2c_read(SHT31_ADDR, rx, sizeof(rx)));
+
+  // Warm boot: reset and status read on the cached address only
+  boot(false);
+  power_on_sht31(&sht);
+  usage_begin();
+  usage = usage_end("SHT31 warm boot", sht31_init());
+  CHECK(usage.ok);
+  CHECK(usage.transactions == 3u);
+  CHECK(sht31_sample("SHT31 first warm sample", &data).ok);
+}
+
+static void test_sht31_clock_stretch(void)
+{
+  sim_sht31_t sht;
+  sht31_data_t data;
+  usage_t usage;
+
+  printf("SHT31, single shot with clock stretching:\n");
+  boot(true);
+  power_on_sht31(&sht);
+  CHECK(sht31_init());
+  CHECK(sht31_set_measurement_mode(SHT31_REPEATABILITY_HIGH, true));
+
+  usage = sht31_sample("SHT31 clock stretch", &data);
+  CHECK(usage.ok);
+  CHECK(data.temperature == 2500);
+  CHECK(usage.transactions == 2u);
+  // The bus is held for the whole 12.5 ms conversion
+  CHECK(usage.stretch_us > 12000u);
+  CHECK(usage.bus_us > 12000u + WRITE_US(2u) + READ_US(6u) - 200u);
+
+  CHECK(sht31_set_measurement_mode(SHT31_REPEATABILITY_HIGH, false));
+}
+
+static void test_sht31_faults(void)
+{
+  sim_sht31_t sht;
+  sht31_data_t data;
+  hal_i2c_error_stats_t errors;
+
+  printf("SHT31, CRC and stretch timeout faults:\n");
+  boot(true);
+  power_on_sht31(&sht);
+  CHECK(sht31_init());
+
+  // A corrupt CRC on the first warm sample drops the cached address
+  boot(false);
+  power_on_sht31(&sht);
+  CHECK(sht31_init());
+  sim_sht31_inject_crc_error(&sht, 1);
+  CHECK(!sht31_sample("SHT31 CRC error", &data).ok);
+  CHECK(!sim_sensor_cache_has(SENSOR_CACHE_KEY_SHT31));
+  CHECK(sht31_sample("SHT31 after CRC error", &data).ok);
+
+  // A read stretched past its deadline times out; recovery runs first on
+  // the next transfer
+  i2c_sim_inject_stretch(&sht.device, 1, 100000u);
+  CHECK(!sht31_sample("SHT31 stretch timeout", &data).ok);
+  hal_i2c_get_error_stats(&errors);
+  CHECK(errors.timeout == 1u);
+  CHECK(errors.recoveries == 0u);
+  CHECK(sht31_sample("SHT31 after timeout", &data).ok);
+  hal_i2c_get_error_stats(&errors);
+  CHECK(errors.recoveries == 1u);
+}
+
+static void print_table(void)
+{
+  printf("\nPer-operation bus occupancy at %u Hz:\n", (unsigned)BME280_I2C_FREQ);
+  printf("  %-28s %3s %5s %6s %8s %8s %10s\n",
+         "operation", "ok", "trans", "bytes", "bus us", "stretch", "latency us");
+  for (uint32_t i = 0; i < row_count; i++) {
+    printf("  %-28s %3s %5lu %6lu %8lu %8lu %10lu\n",
+           rows[i].name,
+           rows[i].ok ? "yes" : "no",
+           (unsigned long)rows[i].transactions,
+           (unsigned long)rows[i].bytes,
+           (unsigned long)rows[i].bus_us,
+           (unsigned long)rows[i].stretch_us,
+           (unsigned long)rows[i].latency_us);
+  }
+}
+
+int main(void)
+{
+  test_bmp280_datasheet_example();
+  test_bme280_cold_and_warm_boot();
+  test_bme280_nack_faults();
+  test_bme280_slow_conversion();
+  test_sht31_single_shot();
+  test_sht31_clock_stretch();
+  test_sht31_faults();
+
+  print_table();
+
+  if (failures != 0) {
+    printf("test_i2c_sim: %d FAILED\n", failures);
+    return 1;
+  }
+  printf("test_i2c_sim: all passed\n");
+  return 0;
+}
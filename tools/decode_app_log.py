@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Decode the tokenized application log (APP_LOG_TOKENIZED=1).
+
+The firmware keeps app_log_ring in RAM. Dump RAM to a binary file, e.g.
+  commander readmem --range 0x20000000:+0x8000 --outfile ram.bin
+or J-Link "savebin ram.bin 0x20000000 0x8000", then run
+  tools/decode_app_log.py ram.bin [--src .] [--elf build/app.out]
+
+Records are matched back to the APP_LOG_* / APP_DEBUG_PRINTF calls by module
+id and source line, so --src must point at the sources the image was built
+from. With --elf (needs pyelftools) %s arguments pointing into flash are
+printed as strings; otherwise the pointer is shown.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+from pathlib import Path
+
+RING_MAGIC = 0x474F4C41
+RING_HEADER_WORDS = 6  # magic, size_words, tick_hz, head, tail, dropped
+LEVEL_NAMES = ("ERROR", "WARN", "INFO", "DEBUG")
+
+SKIP_DIRS = {".git", "autogen", "gecko_sdk", "build", "_gate_build", "bootloader"}
+
+CALL_RE = re.compile(r"\b(APP_LOG_(?:ERROR|WARN|INFO|DEBUG)|APP_LOG_PRINTF|APP_DEBUG_PRINTF)\s*\(")
+MODULE_DEFINE_RE = re.compile(r"^\s*#\s*define\s+APP_LOG_MODULE\s+APP_LOG_MODULE_(\w+)", re.M)
+MODULE_ID_RE = re.compile(r"^\s*#\s*define\s+APP_LOG_MODULE_(\w+)\s+(\d+)", re.M)
+CONVERSION_RE = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|t|j)?([diouxXcsp%])")
+
+
+def split_call_args(text, start):
+    """Split the argument list starting after '(' at text[start]; returns (args, end)."""
+    args, depth, i, arg_start = [], 0, start, start
+    while i < len(text):
+        c = text[i]
+        if c in "\"'":
+            quote = c
+            i += 1
+            while i < len(text) and text[i] != quote:
+                i += 2 if text[i] == "\\" else 1
+        elif c in "([{":
+            depth += 1
+        elif c in ")]}":
+            if depth == 0:
+                args.append(text[arg_start:i])
+                return args, i
+            depth -= 1
+        elif c == "," and depth == 0:
+            args.append(text[arg_start:i])
+            arg_start = i + 1
+        i += 1
+    return args, i
+
+
+def string_literal_value(arg):
+    """Concatenate the C string literals in a format argument."""
+    parts = re.findall(r'"((?:\\.|[^"\\])*)"', arg)
+    if not parts:
+        return None
+    raw = "".join(parts)
+    return raw.encode("latin-1").decode("unicode_escape")
+
+
+def load_module_ids(src_root):
+    header = src_root / "src" / "app" / "app_log.h"
+    return {name: int(value) for name, value in MODULE_ID_RE.findall(header.read_text())}
+
+
+def load_formats(src_root):
+    """Map module id -> list of (first_line, last_line, level_hint, format)."""
+    module_ids = load_module_ids(src_root)
+    formats = {}
+    for dirpath, dirnames, filenames in os.walk(src_root):
+        dirnames[:] = [d for d in dirnames if d not in SKIP_DIRS]
+        for filename in filenames:
+            if not filename.endswith(".c"):
+                continue
+            path = Path(dirpath) / filename
+            text = path.read_text(errors="replace")
+            module = MODULE_DEFINE_RE.search(text)
+            if not module or module.group(1) not in module_ids:
+                continue
+            entries = formats.setdefault(module_ids[module.group(1)], [])
+            for call in CALL_RE.finditer(text):
+                line_start = text.rfind("\n", 0, call.start()) + 1
+                if text[line_start:call.start()].lstrip().startswith("#"):
+                    continue  # macro definition, not a call site
+                args, end = split_call_args(text, call.end())
+                fmt_arg = args[1] if call.group(1) == "APP_LOG_PRINTF" and len(args) > 1 else args[0]
+                fmt = string_literal_value(fmt_arg)
+                if fmt is None:
+                    continue
+                first = text.count("\n", 0, call.start()) + 1
+                last = text.count("\n", 0, end) + 1
+                entries.append((first, last, fmt.rstrip("\n"), path.relative_to(src_root)))
+    return formats
+
+
+def load_elf_reader(elf_path):
+    try:
+        from elftools.elf.elffile import ELFFile
+    except ImportError:
+        print("warning: pyelftools not installed, %s shown as pointers", file=sys.stderr)
+        return None
+    segments = []
+    with open(elf_path, "rb") as f:
+        for section in ELFFile(f).iter_sections():
+            if section["sh_type"] == "SHT_PROGBITS" and section["sh_flags"] & 0x2:
+                segments.append((section["sh_addr"], section.data()))
+
+    def read_string(addr):
+        for base, data in segments:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                return data[addr - base:end if end >= 0 else len(data)].decode("latin-1")
+        return None
+    return read_string
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def format_record(fmt, args, read_string):
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        if conv in "di":
+            return (spec + "d") % to_signed(value)
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv in "sp":
+            text = read_string(value) if (conv == "s" and read_string) else None
+            return (spec + "s") % (text if text is not None else "<0x%08x>" % value)
+        return (spec + conv) % value
+
+    return CONVERSION_RE.sub(convert, fmt)
+
+
+def find_ring(dump):
+    for offset in range(0, len(dump) - RING_HEADER_WORDS * 4, 4):
+        magic, size_words = struct.unpack_from("<II", dump, offset)
+        if (magic == RING_MAGIC and size_words and size_words & (size_words - 1) == 0
+                and offset + (RING_HEADER_WORDS + size_words) * 4 <= len(dump)):
+            return offset
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="Binary RAM dump containing app_log_ring")
+    parser.add_argument("--src", default=str(Path(__file__).resolve().parent.parent),
+                        help="Source tree the image was built from (default: this repo)")
+    parser.add_argument("--elf", help="Image ELF, to print %%s arguments that point into flash")
+    opts = parser.parse_args()
+
+    dump = Path(opts.dump).read_bytes()
+    offset = find_ring(dump)
+    if offset is None:
+        sys.exit("error: app_log_ring not found in dump (tokenized build?)")
+
+    _, size_words, tick_hz, head, tail, dropped = struct.unpack_from("<6I", dump, offset)
+    words = struct.unpack_from("<%dI" % size_words, dump, offset + RING_HEADER_WORDS * 4)
+    tick_hz = tick_hz or 32768
+    mask = size_words - 1
+    print("ring at +0x%x: %u words, %u records dropped" % (offset, size_words, dropped), file=sys.stderr)
+
+    formats = load_formats(Path(opts.src))
+    read_string = load_elf_reader(opts.elf) if opts.elf else None
+
+    pos = tail
+    while pos != head and (head - pos) & 0xFFFFFFFF <= size_words:
+        header = words[pos & mask]
+        nargs = header >> 28
+        level = LEVEL_NAMES[(header >> 26) & 0x3]
+        module = (header >> 16) & 0x3FF
+        line = header & 0xFFFF
+        ticks = words[(pos + 1) & mask]
+        args = [words[(pos + 2 + i) & mask] for i in range(nargs)]
+        pos = (pos + 2 + nargs) & 0xFFFFFFFF
+
+        match = next((e for e in formats.get(module, []) if e[0] <= line <= e[1]), None)
+        if match:
+            text = format_record(match[2], args, read_string)
+            origin = "%s:%u" % (match[3], line)
+        else:
+            text = "<unknown format> " + " ".join("0x%08x" % a for a in args)
+            origin = "module %u line %u" % (module, line)
+        print("[%12.6f] %-5s %-28s %s" % (ticks / tick_hz, level, origin, text))
+
+
+if __name__ == "__main__":
+    main()